@@ -0,0 +1,224 @@
+﻿#include <stdlib.h>
+#include <string.h>
+#include "aoi.h"
+
+#define AOI_CHANGED_BIT 0x80000000u  // W liscie current: obiekt zmienil sie w tym ticku
+
+struct AoiGrid {
+    int width;
+    int height;
+    int cellSize;
+    int cellsX;
+    int cellsY;
+    // Obiekty w kolejnosci dodania
+    unsigned int* keys;  // Z AOI_CHANGED_BIT dla zmienionych
+    int* xs;
+    int* ys;
+    int count;
+    int capacity;
+    // Obiekty pogrupowane wedlug kubelkow: cellItems[cellStart[c] .. cellStart[c + 1])
+    int* cellStart;
+    int* cellItems;
+    // Klucz -> pozycja w keys; wpis jest wazny, gdy keys pod ta pozycja ma ten klucz
+    int* slots[AOI_KIND_COUNT];
+    int slotCapacity[AOI_KIND_COUNT];
+    // Znaczniki obiektow widzianych przez obserwatora w poprzednim ticku
+    int* seen;
+    int stamp;
+};
+
+static int growKeys(AoiKeyList* list, int needed) {
+    if (needed <= list->capacity) return 1;
+    int capacity = list->capacity ? list->capacity * 2 : 64;
+    while (capacity < needed) capacity *= 2;
+    unsigned int* grown = (unsigned int*)realloc(list->keys, capacity * sizeof(unsigned int));
+    if (!grown) return 0;
+    list->keys = grown;
+    list->capacity = capacity;
+    return 1;
+}
+
+static void pushKey(AoiKeyList* list, unsigned int key) {
+    if (growKeys(list, list->count + 1)) {
+        list->keys[list->count++] = key;
+    }
+}
+
+AoiGrid* createAoiGrid(int width, int height, int cellSize) {
+    AoiGrid* grid = (AoiGrid*)calloc(1, sizeof(AoiGrid));
+    if (!grid) return NULL;
+    grid->width = width;
+    grid->height = height;
+    grid->cellSize = cellSize > 0 ? cellSize : AOI_DEFAULT_CELL;
+    grid->cellsX = (width + grid->cellSize - 1) / grid->cellSize;
+    grid->cellsY = (height + grid->cellSize - 1) / grid->cellSize;
+    grid->cellStart = (int*)calloc(grid->cellsX * grid->cellsY + 1, sizeof(int));
+    if (!grid->cellStart) {
+        free(grid);
+        return NULL;
+    }
+    return grid;
+}
+
+void freeAoiGrid(AoiGrid* grid) {
+    if (!grid) return;
+    free(grid->keys);
+    free(grid->xs);
+    free(grid->ys);
+    free(grid->cellStart);
+    free(grid->cellItems);
+    for (int kind = 0; kind < AOI_KIND_COUNT; kind++) {
+        free(grid->slots[kind]);
+    }
+    free(grid->seen);
+    free(grid);
+}
+
+void aoiClear(AoiGrid* grid) {
+    grid->count = 0;
+}
+
+void aoiAdd(AoiGrid* grid, unsigned int key, int x, int y, int changed) {
+    if (grid->count == grid->capacity) {
+        int capacity = grid->capacity ? grid->capacity * 2 : 256;
+        unsigned int* keys = (unsigned int*)realloc(grid->keys, capacity * sizeof(unsigned int));
+        int* xs = keys ? (int*)realloc(grid->xs, capacity * sizeof(int)) : NULL;
+        int* ys = xs ? (int*)realloc(grid->ys, capacity * sizeof(int)) : NULL;
+        int* items = ys ? (int*)realloc(grid->cellItems, capacity * sizeof(int)) : NULL;
+        int* seen = items ? (int*)calloc(capacity, sizeof(int)) : NULL;
+        if (keys) grid->keys = keys;
+        if (xs) grid->xs = xs;
+        if (ys) grid->ys = ys;
+        if (items) grid->cellItems = items;
+        if (!seen) return;
+        free(grid->seen);
+        grid->seen = seen;
+        grid->stamp = 0;
+        grid->capacity = capacity;
+    }
+    int kind = AOI_KEY_KIND(key);
+    int index = AOI_KEY_INDEX(key);
+    if (index >= grid->slotCapacity[kind]) {
+        int capacity = grid->slotCapacity[kind] ? grid->slotCapacity[kind] * 2 : 256;
+        while (capacity <= index) capacity *= 2;
+        int* slots = (int*)realloc(grid->slots[kind], capacity * sizeof(int));
+        if (!slots) return;
+        grid->slots[kind] = slots;
+        grid->slotCapacity[kind] = capacity;
+    }
+    grid->slots[kind][index] = grid->count;
+    // Pozycje poza mapa trafiaja do skrajnych kubelkow
+    if (x < 0) x = 0;
+    if (x >= grid->width) x = grid->width - 1;
+    if (y < 0) y = 0;
+    if (y >= grid->height) y = grid->height - 1;
+    grid->keys[grid->count] = key | (changed ? AOI_CHANGED_BIT : 0);
+    grid->xs[grid->count] = x;
+    grid->ys[grid->count] = y;
+    grid->count++;
+}
+
+static int cellOf(const AoiGrid* grid, int x, int y) {
+    return (y / grid->cellSize) * grid->cellsX + x / grid->cellSize;
+}
+
+void aoiBuild(AoiGrid* grid) {
+    int cells = grid->cellsX * grid->cellsY;
+    memset(grid->cellStart, 0, (cells + 1) * sizeof(int));
+    for (int i = 0; i < grid->count; i++) {
+        grid->cellStart[cellOf(grid, grid->xs[i], grid->ys[i]) + 1]++;
+    }
+    for (int c = 0; c < cells; c++) {
+        grid->cellStart[c + 1] += grid->cellStart[c];
+    }
+    // cellStart[c] przesuwa sie przy wstawianiu do poczatku kubelka c + 1 - potem cofniecie
+    for (int i = 0; i < grid->count; i++) {
+        grid->cellItems[grid->cellStart[cellOf(grid, grid->xs[i], grid->ys[i])]++] = i;
+    }
+    for (int c = cells; c > 0; c--) {
+        grid->cellStart[c] = grid->cellStart[c - 1];
+    }
+    grid->cellStart[0] = 0;
+}
+
+void initAoiObserver(AoiObserver* observer) {
+    memset(observer, 0, sizeof(AoiObserver));
+}
+
+void freeAoiObserver(AoiObserver* observer) {
+    free(observer->visible.keys);
+    free(observer->current.keys);
+    free(observer->updates.keys);
+    free(observer->leaves.keys);
+    initAoiObserver(observer);
+}
+
+void resetAoiObserver(AoiObserver* observer) {
+    observer->visible.count = 0;
+}
+
+// Pozycja obiektu w biezacym ticku, -1 - nie ma go w siatce
+static int findKey(const AoiGrid* grid, unsigned int key) {
+    int kind = AOI_KEY_KIND(key);
+    int index = AOI_KEY_INDEX(key);
+    if (index >= grid->slotCapacity[kind]) return -1;
+    int slot = grid->slots[kind][index];
+    if (slot < 0 || slot >= grid->count || (grid->keys[slot] & ~AOI_CHANGED_BIT) != key) return -1;
+    return slot;
+}
+
+static int inView(const AoiGrid* grid, int slot, int x, int y, int radius) {
+    return radius < 0 || (abs(grid->xs[slot] - x) <= radius && abs(grid->ys[slot] - y) <= radius);
+}
+
+void aoiUpdateObserver(AoiGrid* grid, AoiObserver* observer, int x, int y, int radius) {
+    AoiKeyList* current = &observer->current;
+    current->count = 0;
+    observer->updates.count = 0;
+    observer->leaves.count = 0;
+    if (++grid->stamp == 0x7FFFFFFF) {
+        memset(grid->seen, 0, grid->capacity * sizeof(int));
+        grid->stamp = 1;
+    }
+
+    // Widoczne wczesniej: nadal w polu widzenia dostaja znacznik, reszta wychodzi
+    const AoiKeyList* visible = &observer->visible;
+    for (int k = 0; k < visible->count; k++) {
+        int slot = findKey(grid, visible->keys[k]);
+        if (slot >= 0 && inView(grid, slot, x, y, radius)) {
+            grid->seen[slot] = grid->stamp;
+        }
+        else {
+            pushKey(&observer->leaves, visible->keys[k]);
+        }
+    }
+
+    int cx0 = 0, cy0 = 0, cx1 = grid->cellsX - 1, cy1 = grid->cellsY - 1;
+    if (radius >= 0) {
+        cx0 = x - radius < 0 ? 0 : (x - radius) / grid->cellSize;
+        cy0 = y - radius < 0 ? 0 : (y - radius) / grid->cellSize;
+        if ((x + radius) / grid->cellSize < cx1) cx1 = (x + radius) / grid->cellSize;
+        if ((y + radius) / grid->cellSize < cy1) cy1 = (y + radius) / grid->cellSize;
+    }
+
+    // Kwadrat widzenia, jak na mapie w konsoli
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            int cell = cy * grid->cellsX + cx;
+            for (int k = grid->cellStart[cell]; k < grid->cellStart[cell + 1]; k++) {
+                int slot = grid->cellItems[k];
+                if (!inView(grid, slot, x, y, radius)) continue;
+                unsigned int key = grid->keys[slot] & ~AOI_CHANGED_BIT;
+                if (grid->seen[slot] != grid->stamp || (grid->keys[slot] & AOI_CHANGED_BIT)) {
+                    pushKey(&observer->updates, key);
+                }
+                pushKey(current, key);
+            }
+        }
+    }
+
+    // Biezace pole widzenia staje sie poprzednim
+    AoiKeyList swap = observer->visible;
+    observer->visible = observer->current;
+    observer->current = swap;
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+
+// Obszar zainteresowania (area of interest): kazdy obserwator dostaje tylko
+// obiekty w swoim polu widzenia, i to tylko te, ktore sie zmienily albo
+// dopiero weszly w pole widzenia. Obiekty z biezacego ticku trafiaja do
+// siatki kubelkow (sortowanie przez zliczanie, O(n)), zapytanie przeglada
+// tylko kubelki pokrywajace kwadrat widzenia. Obserwator pamieta liste
+// widocznych kluczy z poprzedniego ticku; siatka znajduje klucz w tablicy
+// wedlug rodzaju i indeksu, wiec wejscia i wyjscia z pola widzenia kosztuja
+// O(widoczne) bez sortowania.
+
+typedef enum {
+    AOI_PLAYER,
+    AOI_ENEMY,
+    AOI_TRAP,
+    AOI_ITEM,
+    AOI_KIND_COUNT
+} AoiKind;
+
+#define AOI_KEY(kind, index) (((unsigned int)(kind) << 24) | (unsigned int)(index))
+#define AOI_KEY_KIND(key) ((AoiKind)((key) >> 24))
+#define AOI_KEY_INDEX(key) ((int)((key) & 0xFFFFFF))
+#define AOI_DEFAULT_CELL 8
+
+typedef struct AoiGrid AoiGrid;
+
+// Lista kluczy obiektow z rosnaca pojemnoscia
+typedef struct {
+    unsigned int* keys;
+    int count;
+    int capacity;
+} AoiKeyList;
+
+typedef struct {
+    AoiKeyList visible;  // Widoczne w ostatnim ticku
+    AoiKeyList current;  // Roboczy wynik zapytania
+    AoiKeyList updates;  // Do wyslania: nowe w polu widzenia albo zmienione
+    AoiKeyList leaves;   // Do wyslania: zniknely z pola widzenia
+} AoiObserver;
+
+AoiGrid* createAoiGrid(int width, int height, int cellSize);
+void freeAoiGrid(AoiGrid* grid);
+
+// Tick: aoiClear, aoiAdd dla kazdego obiektu, aoiBuild, potem zapytania
+void aoiClear(AoiGrid* grid);
+void aoiAdd(AoiGrid* grid, unsigned int key, int x, int y, int changed);
+void aoiBuild(AoiGrid* grid);
+
+void initAoiObserver(AoiObserver* observer);
+void freeAoiObserver(AoiObserver* observer);
+void resetAoiObserver(AoiObserver* observer);  // Nowy klient - wszystko w polu widzenia jest nowe
+
+// Wypelnia observer->updates i observer->leaves. radius < 0 - bez limitu.
+void aoiUpdateObserver(AoiGrid* grid, AoiObserver* observer, int x, int y, int radius);
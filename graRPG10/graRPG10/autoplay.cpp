@@ -0,0 +1,153 @@
+﻿#include "graRPG10.h"
+#include "autoplayer.h"
+
+// Gry rozgrywane przez autogracza bez konsoli - test nowej zawartosci
+// (poziomy, przeciwnicy, przedmioty) i pomiar rozgrywek MCTS na sekunde.
+//
+// Uzycie: graRPG10_autoplay [--games N] [--budget-ms N] [--threads N]
+//                           [--depth N] [--rollouts N] [--max-turns N]
+//                           [--seed N] [--out wynik.json]
+
+#define AUTOPLAY_DEFAULT_GAMES 5
+#define AUTOPLAY_DEFAULT_MAX_TURNS 2000
+
+typedef struct {
+    int games;
+    int wins;
+    int deaths;
+    int unfinished;     // Przerwane po --max-turns
+    long long turns;
+    long long levels;   // Suma poziomow osiagnietych w grach
+    long long enemiesDefeated;
+} AutoplaySummary;
+
+static void writeSummaryJson(FILE* file, const AutoplaySummary* summary, const AutoplayerStats* stats,
+    const AutoplayerConfig* config, double seconds) {
+    fprintf(file, "{\n");
+    fprintf(file, "  \"config\": {\n");
+    fprintf(file, "    \"map_width\": %d,\n", MAP_WIDTH);
+    fprintf(file, "    \"map_height\": %d,\n", MAP_HEIGHT);
+    fprintf(file, "    \"budget_ms\": %d,\n", config->budgetMs);
+    fprintf(file, "    \"threads\": %d,\n", config->threads);
+    fprintf(file, "    \"rollout_depth\": %d,\n", config->rolloutDepth);
+    fprintf(file, "    \"max_rollouts\": %lld\n", config->maxRollouts);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"games\": %d,\n", summary->games);
+    fprintf(file, "  \"wins\": %d,\n", summary->wins);
+    fprintf(file, "  \"deaths\": %d,\n", summary->deaths);
+    fprintf(file, "  \"unfinished\": %d,\n", summary->unfinished);
+    fprintf(file, "  \"turns\": %lld,\n", summary->turns);
+    fprintf(file, "  \"average_level\": %.2f,\n", summary->games ? (double)summary->levels / summary->games : 0.0);
+    fprintf(file, "  \"enemies_defeated\": %lld,\n", summary->enemiesDefeated);
+    fprintf(file, "  \"decisions\": %lld,\n", stats->decisions);
+    fprintf(file, "  \"battle_decisions\": %lld,\n", stats->battleDecisions);
+    fprintf(file, "  \"rollouts\": %lld,\n", stats->rollouts);
+    fprintf(file, "  \"search_seconds\": %.3f,\n", stats->searchSeconds);
+    fprintf(file, "  \"rollouts_per_second\": %.1f,\n",
+        stats->searchSeconds > 0.0 ? stats->rollouts / stats->searchSeconds : 0.0);
+    fprintf(file, "  \"seconds\": %.3f\n", seconds);
+    fprintf(file, "}\n");
+}
+
+int main(int argc, char* argv[]) {
+    AutoplayerConfig config;
+    memset(&config, 0, sizeof(AutoplayerConfig));
+    config.budgetMs = AUTOPLAYER_DEFAULT_BUDGET_MS;
+    config.rolloutDepth = AUTOPLAYER_DEFAULT_DEPTH;
+    int games = AUTOPLAY_DEFAULT_GAMES;
+    int maxTurns = AUTOPLAY_DEFAULT_MAX_TURNS;
+    unsigned int seed = (unsigned)time(NULL);
+    const char* outPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--budget-ms") == 0 && i + 1 < argc) {
+            config.budgetMs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            config.rolloutDepth = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--rollouts") == 0 && i + 1 < argc) {
+            config.maxRollouts = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--max-turns") == 0 && i + 1 < argc) {
+            maxTurns = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else {
+            fprintf(stderr, "Uzycie: %s [--games N] [--budget-ms N] [--threads N] [--depth N] [--rollouts N] "
+                "[--max-turns N] [--seed N] [--out wynik.json]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    srand(seed);
+    initStringTable();
+    Autoplayer* autoplayer = createAutoplayer(&config);
+    if (!autoplayer) {
+        fprintf(stderr, "Nie mozna utworzyc autogracza!\n");
+        return 1;
+    }
+
+    AutoplaySummary summary;
+    memset(&summary, 0, sizeof(AutoplaySummary));
+    double start = nowSeconds();
+    for (int game = 0; game < games; game++) {
+        GameWorld* world = createGameWorld("Autogracz");
+        int turns = 0;
+        while (world->status == GAME_RUNNING && turns < maxTurns) {
+            autoplayerTurn(autoplayer, world);
+            drainEvents(world->events, NULL, 0);
+            turns++;
+        }
+
+        const char* result = world->status == GAME_WON ? "wygrana" : world->status == GAME_LOST ? "smierc" : "przerwana";
+        fprintf(stderr, "Gra %d: %s, poziom %d, tur %d, pokonanych %d, zloto %d\n", game + 1, result,
+            world->level, turns, world->totalEnemiesDefeated, world->player->gold);
+        summary.games++;
+        summary.wins += world->status == GAME_WON;
+        summary.deaths += world->status == GAME_LOST;
+        summary.unfinished += world->status == GAME_RUNNING;
+        summary.turns += turns;
+        summary.levels += world->level;
+        summary.enemiesDefeated += world->totalEnemiesDefeated;
+        freeGameWorld(world);
+    }
+    double elapsed = nowSeconds() - start;
+
+    AutoplayerStats stats = autoplayerStats(autoplayer);
+    fprintf(stderr, "%d gier: %d wygranych, %d smierci, %d przerwanych, %lld tur\n",
+        summary.games, summary.wins, summary.deaths, summary.unfinished, summary.turns);
+    fprintf(stderr, "Decyzji: %lld (w walce %lld), rozgrywek: %lld, %.0f rozgrywek/s\n",
+        stats.decisions, stats.battleDecisions, stats.rollouts,
+        stats.searchSeconds > 0.0 ? stats.rollouts / stats.searchSeconds : 0.0);
+
+    int status = 0;
+    if (outPath) {
+        FILE* file;
+        if (fopen_s(&file, outPath, "w") != 0) {
+            fprintf(stderr, "Nie mozna otworzyc pliku %s!\n", outPath);
+            status = 1;
+        }
+        else {
+            writeSummaryJson(file, &summary, &stats, &config, elapsed);
+            fclose(file);
+        }
+    }
+    // Przeszukiwanie, ktore nie rozegralo niczego, to blad
+    if (summary.games > 0 && stats.decisions > 0 && stats.rollouts == 0) {
+        status = 1;
+    }
+    freeAutoplayer(autoplayer);
+    return status;
+}
@@ -0,0 +1,421 @@
+﻿#include <atomic>
+#include <thread>
+#include "autoplayer.h"
+
+#define MAX_TREE_DEPTH 12   // Glebiej tylko rozgrywka - swiat jest losowy, drzewo i tak sie rozmywa
+#define MAX_ACTIONS 9
+
+// Akcje wezlow drzewa. Leczenie i zakladanie nie zajmuja tury, jak w menu ekwipunku.
+typedef enum {
+    ACTION_UP,
+    ACTION_LEFT,
+    ACTION_DOWN,
+    ACTION_RIGHT,
+    ACTION_PICK_UP,
+    ACTION_HEAL,
+    ACTION_EQUIP,
+    ACTION_ATTACK,   // Tylko w korzeniu decyzji w walce
+    ACTION_FLEE
+} AutoAction;
+
+static const char actionCommands[] = { 'w', 'a', 's', 'd', 'p' };
+
+typedef struct {
+    int firstChild;   // -1 - nierozwiniety
+    int childCount;
+    int action;
+    int visits;
+    double value;     // Suma nagrod
+} SearchNode;
+
+typedef struct {
+    SearchNode* nodes;
+    int count;
+    int capacity;
+    unsigned int random;
+    long long rollouts;
+} SearchTree;
+
+// Jedna decyzja - wspolna dla wszystkich watkow
+typedef struct {
+    const AutoplayerConfig* config;
+    const GameWorld* world;   // Korzen; watki tylko go klonuja
+    int rootActions[MAX_ACTIONS];
+    int rootActionCount;
+    int battleEnemy;          // Decyzja w walce: indeks przeciwnika, -1 - zwykla tura
+    double deadline;
+    std::atomic<long long> rolloutsLeft;  // Przy maxRollouts
+    int rootGold;
+} SearchJob;
+
+struct Autoplayer {
+    AutoplayerConfig config;
+    SearchTree* trees;
+    int threadCount;
+    AutoplayerStats stats;
+};
+
+// ---- Polityka rozgrywki ----
+
+static unsigned int nextRandom(unsigned int* state) {
+    // xorshift - watki nie moga dzielic stanu wyboru akcji
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Mikstura dobrana do brakujacego zdrowia - z indeksu ekwipunku
+static Item* findPotion(const Player* player) {
+    return quickUsePotion(player->inventory, player->max_health - player->health);
+}
+
+// Najlepsza bron lub zbroja, jesli jest lepsza od zalozonej
+static Item* findUpgrade(const Player* player) {
+    static const ItemCategory categories[EQUIP_SLOT_COUNT] = { ITEM_SWORD, ITEM_ARMOR };
+    for (int slot = 0; slot < EQUIP_SLOT_COUNT; slot++) {
+        Item* best = bestInventoryItem(player->inventory, categories[slot]);
+        const Item* worn = player->equipment[slot];
+        if (best && (!worn || itemRank(best) > itemRank(worn))) return best;
+    }
+    return NULL;
+}
+
+static int legalActions(GameWorld* world, int* out) {
+    const Player* player = world->player;
+    int count = 0;
+    if (player->posY > 0) out[count++] = ACTION_UP;
+    if (player->posX > 0) out[count++] = ACTION_LEFT;
+    if (player->posY < MAP_HEIGHT - 1) out[count++] = ACTION_DOWN;
+    if (player->posX < MAP_WIDTH - 1) out[count++] = ACTION_RIGHT;
+    if (groundItemAt(world, player->posX, player->posY) >= 0) out[count++] = ACTION_PICK_UP;
+    if (player->health < player->max_health && findPotion(player)) out[count++] = ACTION_HEAL;
+    if (findUpgrade(player)) out[count++] = ACTION_EQUIP;
+    return count;
+}
+
+static BattleAction rolloutBattleAction(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)enemy;
+    (void)round;
+    (void)context;
+    return world->player->health < world->player->max_health / 4 ? BATTLE_FLEE : BATTLE_ATTACK;
+}
+
+static void applyAction(GameWorld* world, int action, BattleActionFunction chooseAction, void* context) {
+    if (action == ACTION_HEAL) {
+        useItem(world, world->player, findPotion(world->player));
+    }
+    else if (action == ACTION_EQUIP) {
+        useItem(world, world->player, findUpgrade(world->player));
+    }
+    else {
+        stepWorld(world, actionCommands[action], chooseAction, context);
+    }
+}
+
+static int stepToward(const Player* player, int x, int y) {
+    if (x > player->posX) return ACTION_RIGHT;
+    if (x < player->posX) return ACTION_LEFT;
+    if (y > player->posY) return ACTION_DOWN;
+    return ACTION_UP;
+}
+
+// Prosta polityka: leczenie, wyposazenie, podnoszenie, potem portal albo
+// najblizszy przeciwnik (pokonani otwieraja portal), czasem losowy ruch
+static int rolloutAction(GameWorld* world, unsigned int* random) {
+    const Player* player = world->player;
+    if (player->health < player->max_health / 2 && findPotion(player)) return ACTION_HEAL;
+    if (findUpgrade(player)) return ACTION_EQUIP;
+    if (groundItemAt(world, player->posX, player->posY) >= 0) return ACTION_PICK_UP;
+
+    unsigned int roll = nextRandom(random);
+    if (world->portalActive && roll % 4 != 0) {
+        return stepToward(player, world->portalX, world->portalY);
+    }
+    if (world->enemyCount > 0 && player->health > player->max_health / 2 && roll % 3 != 0) {
+        const Enemy* nearest = NULL;
+        int best = 0;
+        for (int i = 0; i < world->enemyCount; i++) {
+            const Enemy* enemy = world->enemies[i];
+            int distance = abs(enemy->EposX - player->posX) + abs(enemy->EposY - player->posY);
+            if (!nearest || distance < best) {
+                nearest = enemy;
+                best = distance;
+            }
+        }
+        return stepToward(player, nearest->EposX, nearest->EposY);
+    }
+    return ACTION_UP + (int)((roll >> 8) % 4);
+}
+
+// Nagroda w [0, 1]: postep w grze (poziomy, pokonani, portal), zdrowie i zloto.
+// Pole przy portalu jest warte mniej niz nastepny poziom - inaczej autogracz
+// stoi przy portalu, zeby nie spotkac nowych przeciwnikow.
+static double evaluateWorld(const GameWorld* world, const SearchJob* job) {
+    if (world->status == GAME_LOST) return 0.0;
+    if (world->status == GAME_WON) return 1.0;
+    const Player* player = world->player;
+
+    int defeated = world->enemiesDefeated < 5 ? world->enemiesDefeated : 5;
+    double levelProgress = defeated * 0.1;
+    if (world->portalActive) {
+        int distance = abs(world->portalX - player->posX) + abs(world->portalY - player->posY);
+        levelProgress = 0.5 + 0.3 * (1.0 - (double)distance / (MAP_WIDTH + MAP_HEIGHT));
+    }
+    double progress = (world->level - 1 + levelProgress) / 3.0;
+    double gold = (player->gold - job->rootGold) / 100.0;
+    if (gold < 0.0) gold = 0.0;
+    if (gold > 1.0) gold = 1.0;
+    double health = (double)player->health / player->max_health;
+    return 0.7 * progress + 0.25 * health + 0.05 * gold;
+}
+
+// Decyzja w walce na klonie: wybrana runda, reszta walki polityka rozgrywki,
+// potem to, co resolveEncounters robi z pokonanym przeciwnikiem
+static void applyBattleAction(GameWorld* world, int enemyIndex, int action) {
+    Enemy* enemy = world->enemies[enemyIndex];
+    BattleResult result = battleRound(world, enemy, action == ACTION_FLEE ? BATTLE_FLEE : BATTLE_ATTACK);
+    if (result == BATTLE_CONTINUE) {
+        result = battle(world, enemy, rolloutBattleAction, NULL);
+    }
+    if (result == BATTLE_WON) {
+        dropLoot(world);
+        removeEnemy(world, enemyIndex);
+    }
+}
+
+// ---- Drzewo ----
+
+static int addNodes(SearchTree* tree, int count) {
+    if (tree->count + count > tree->capacity) {
+        int capacity = tree->capacity ? tree->capacity * 2 : 4096;
+        while (capacity < tree->count + count) capacity *= 2;
+        SearchNode* grown = (SearchNode*)realloc(tree->nodes, capacity * sizeof(SearchNode));
+        if (!grown) return -1;
+        tree->nodes = grown;
+        tree->capacity = capacity;
+    }
+    int first = tree->count;
+    tree->count += count;
+    return first;
+}
+
+static void expandNode(SearchTree* tree, int index, const int* actions, int count) {
+    int first = addNodes(tree, count);
+    if (first < 0) return;
+    for (int i = 0; i < count; i++) {
+        SearchNode* child = &tree->nodes[first + i];
+        child->firstChild = -1;
+        child->childCount = 0;
+        child->action = actions[i];
+        child->visits = 0;
+        child->value = 0.0;
+    }
+    tree->nodes[index].firstChild = first;
+    tree->nodes[index].childCount = count;
+}
+
+// UCT; nieodwiedzone dzieci najpierw
+static int selectChild(const SearchTree* tree, int index, double exploration) {
+    const SearchNode* node = &tree->nodes[index];
+    double logVisits = log((double)(node->visits > 0 ? node->visits : 1));
+    int best = node->firstChild;
+    double bestScore = -1.0;
+    for (int i = node->firstChild; i < node->firstChild + node->childCount; i++) {
+        const SearchNode* child = &tree->nodes[i];
+        if (child->visits == 0) return i;
+        double score = child->value / child->visits + exploration * sqrt(logVisits / child->visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+static int rolloutBudgetLeft(SearchJob* job) {
+    if (job->config->maxRollouts > 0) {
+        return job->rolloutsLeft.fetch_sub(1, std::memory_order_relaxed) > 0;
+    }
+    return nowSeconds() < job->deadline;
+}
+
+static void runSearchWorker(SearchJob* job, SearchTree* tree) {
+    int path[MAX_TREE_DEPTH + 2];
+    tree->count = 0;
+    tree->rollouts = 0;
+    int root = addNodes(tree, 1);
+    if (root < 0) return;
+    tree->nodes[root].firstChild = -1;
+    tree->nodes[root].childCount = 0;
+    tree->nodes[root].action = -1;
+    tree->nodes[root].visits = 0;
+    tree->nodes[root].value = 0.0;
+    expandNode(tree, root, job->rootActions, job->rootActionCount);
+
+    while (rolloutBudgetLeft(job)) {
+        GameWorld* world = cloneGameWorld(job->world);
+        if (!world) break;
+        // Klon ma kopie losowan swiata - bez nowego ziarna kazda rozgrywka
+        // znalaby przyszle rzuty korzenia
+        unsigned long long seed = nextRandom(&tree->random);
+        seedRandom(&world->random, (seed << 32) | nextRandom(&tree->random));
+
+        // Zejscie do nieodwiedzonego wezla; swiat jest losowy, wiec drzewo
+        // trzyma tylko kolejnosc akcji (open loop), a stan liczy sie od nowa
+        int depth = 0;
+        int node = root;
+        path[0] = root;
+        while (world->status == GAME_RUNNING && depth <= MAX_TREE_DEPTH) {
+            if (tree->nodes[node].firstChild < 0) {
+                int actions[MAX_ACTIONS];
+                int count = legalActions(world, actions);
+                if (count == 0) break;
+                expandNode(tree, node, actions, count);
+                if (tree->nodes[node].firstChild < 0) break;
+            }
+            int child = selectChild(tree, node, job->config->exploration);
+            int action = tree->nodes[child].action;
+            if (depth == 0 && job->battleEnemy >= 0) {
+                applyBattleAction(world, job->battleEnemy, action);
+            }
+            else {
+                applyAction(world, action, rolloutBattleAction, NULL);
+            }
+            path[++depth] = child;
+            node = child;
+            if (tree->nodes[child].visits == 0) break;
+        }
+
+        for (int turn = 0; turn < job->config->rolloutDepth && world->status == GAME_RUNNING; turn++) {
+            applyAction(world, rolloutAction(world, &tree->random), rolloutBattleAction, NULL);
+        }
+
+        double reward = evaluateWorld(world, job);
+        for (int i = 0; i <= depth; i++) {
+            tree->nodes[path[i]].visits++;
+            tree->nodes[path[i]].value += reward;
+        }
+        freeGameWorld(world);
+        tree->rollouts++;
+    }
+}
+
+// Przeszukuje ze swiata w korzeniu i zwraca akcje z najwieksza suma odwiedzin
+static int searchAction(Autoplayer* autoplayer, const GameWorld* world, const int* actions, int count, int battleEnemy) {
+    if (count == 1) return actions[0];
+
+    SearchJob job;
+    job.config = &autoplayer->config;
+    job.world = world;
+    memcpy(job.rootActions, actions, count * sizeof(int));
+    job.rootActionCount = count;
+    job.battleEnemy = battleEnemy;
+    double start = nowSeconds();
+    job.deadline = start + autoplayer->config.budgetMs / 1000.0;
+    job.rolloutsLeft = autoplayer->config.maxRollouts;
+    job.rootGold = world->player->gold;
+
+    // Watek wolajacy przeszukuje jako pierwszy z watkow
+    int threadCount = autoplayer->threadCount;
+    std::thread* threads = threadCount > 1 ? new std::thread[threadCount - 1] : NULL;
+    for (int i = 0; i < threadCount; i++) {
+        autoplayer->trees[i].random ^= (unsigned int)(autoplayer->stats.decisions * 2654435761u + i + 1);
+        if (autoplayer->trees[i].random == 0) autoplayer->trees[i].random = 0x9E3779B9u;
+    }
+    for (int i = 1; i < threadCount; i++) {
+        threads[i - 1] = std::thread(runSearchWorker, &job, &autoplayer->trees[i]);
+    }
+    runSearchWorker(&job, &autoplayer->trees[0]);
+    for (int i = 1; i < threadCount; i++) {
+        threads[i - 1].join();
+    }
+    delete[] threads;
+
+    // Dzieci korzenia sa w kazdym drzewie pod tymi samymi indeksami
+    long long visits[MAX_ACTIONS] = { 0 };
+    double values[MAX_ACTIONS] = { 0.0 };
+    for (int t = 0; t < threadCount; t++) {
+        const SearchTree* tree = &autoplayer->trees[t];
+        autoplayer->stats.rollouts += tree->rollouts;
+        if (tree->count < 1 + count) continue;
+        for (int i = 0; i < count; i++) {
+            visits[i] += tree->nodes[1 + i].visits;
+            values[i] += tree->nodes[1 + i].value;
+        }
+    }
+    autoplayer->stats.searchSeconds += nowSeconds() - start;
+    autoplayer->stats.decisions++;
+
+    int best = 0;
+    for (int i = 1; i < count; i++) {
+        if (visits[i] > visits[best] || (visits[i] == visits[best] && values[i] > values[best])) {
+            best = i;
+        }
+    }
+    return actions[best];
+}
+
+// ---- Interfejs ----
+
+Autoplayer* createAutoplayer(const AutoplayerConfig* config) {
+    Autoplayer* autoplayer = (Autoplayer*)calloc(1, sizeof(Autoplayer));
+    if (!autoplayer) return NULL;
+    if (config) {
+        autoplayer->config = *config;
+    }
+    else {
+        autoplayer->config.budgetMs = AUTOPLAYER_DEFAULT_BUDGET_MS;
+    }
+    if (autoplayer->config.budgetMs <= 0) autoplayer->config.budgetMs = AUTOPLAYER_DEFAULT_BUDGET_MS;
+    if (autoplayer->config.rolloutDepth <= 0) autoplayer->config.rolloutDepth = AUTOPLAYER_DEFAULT_DEPTH;
+    if (autoplayer->config.exploration <= 0.0) autoplayer->config.exploration = AUTOPLAYER_DEFAULT_EXPLORATION;
+
+    autoplayer->threadCount = autoplayer->config.threads;
+    if (autoplayer->threadCount <= 0) autoplayer->threadCount = (int)std::thread::hardware_concurrency();
+    if (autoplayer->threadCount <= 0) autoplayer->threadCount = 1;
+    autoplayer->trees = (SearchTree*)calloc(autoplayer->threadCount, sizeof(SearchTree));
+    if (!autoplayer->trees) {
+        free(autoplayer);
+        return NULL;
+    }
+    for (int i = 0; i < autoplayer->threadCount; i++) {
+        autoplayer->trees[i].random = 2463534242u + i * 7919u;
+    }
+    return autoplayer;
+}
+
+void freeAutoplayer(Autoplayer* autoplayer) {
+    if (!autoplayer) return;
+    for (int i = 0; i < autoplayer->threadCount; i++) {
+        free(autoplayer->trees[i].nodes);
+    }
+    free(autoplayer->trees);
+    free(autoplayer);
+}
+
+AutoplayerStats autoplayerStats(Autoplayer* autoplayer) {
+    return autoplayer->stats;
+}
+
+void autoplayerTurn(Autoplayer* autoplayer, GameWorld* world) {
+    int actions[MAX_ACTIONS];
+    int count = legalActions(world, actions);
+    int action = searchAction(autoplayer, world, actions, count, -1);
+    applyAction(world, action, autoplayerBattleAction, autoplayer);
+}
+
+BattleAction autoplayerBattleAction(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)round;
+    Autoplayer* autoplayer = (Autoplayer*)context;
+    int enemyIndex = -1;
+    for (int i = 0; i < world->enemyCount; i++) {
+        if (world->enemies[i] == enemy) enemyIndex = i;
+    }
+    if (enemyIndex < 0) return rolloutBattleAction(world, enemy, round, NULL);
+
+    static const int actions[] = { ACTION_ATTACK, ACTION_FLEE };
+    autoplayer->stats.battleDecisions++;
+    int action = searchAction(autoplayer, world, actions, 2, enemyIndex);
+    return action == ACTION_FLEE ? BATTLE_FLEE : BATTLE_ATTACK;
+}
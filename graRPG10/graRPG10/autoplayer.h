@@ -0,0 +1,40 @@
+﻿#pragma once
+
+// Autogracz: wybiera polecenia i decyzje w walce przeszukiwaniem drzewa
+// Monte Carlo (UCT) w zadanym czasie na ruch. Kazda iteracja klonuje swiat
+// (cloneGameWorld), schodzi drzewem, rozwija jeden wezel i rozgrywa dalsze
+// tury prosta polityka. Watki przeszukuja niezalezne drzewa z tego samego
+// korzenia, a decyzja to suma odwiedzin akcji korzenia ze wszystkich watkow.
+
+#include "graRPG10.h"
+
+#define AUTOPLAYER_DEFAULT_BUDGET_MS 50
+#define AUTOPLAYER_DEFAULT_DEPTH 20
+#define AUTOPLAYER_DEFAULT_EXPLORATION 0.7
+
+typedef struct {
+    int budgetMs;          // Czas na jedna decyzje
+    int threads;           // 0 - tyle, ile rdzeni
+    int rolloutDepth;      // Tury rozgrywki po rozwinieciu wezla
+    double exploration;    // Stala UCT (nagrody sa w [0, 1])
+    long long maxRollouts; // > 0 - decyzja po tylu rozgrywkach (powtarzalne pomiary), niezaleznie od czasu
+} AutoplayerConfig;
+
+typedef struct {
+    long long decisions;
+    long long rollouts;
+    long long battleDecisions;
+    double searchSeconds;  // Lacznie w przeszukiwaniu - rollouts / searchSeconds to rozgrywki na sekunde
+} AutoplayerStats;
+
+typedef struct Autoplayer Autoplayer;
+
+Autoplayer* createAutoplayer(const AutoplayerConfig* config);  // config NULL - domyslne
+void freeAutoplayer(Autoplayer* autoplayer);
+AutoplayerStats autoplayerStats(Autoplayer* autoplayer);
+
+// Jedna tura: wybor polecenia i wykonanie go na swiecie (walki tez decyduje autogracz)
+void autoplayerTurn(Autoplayer* autoplayer, GameWorld* world);
+
+// Zrodlo decyzji w walce (BattleActionFunction); context - Autoplayer
+BattleAction autoplayerBattleAction(GameWorld* world, Enemy* enemy, int round, void* context);
@@ -0,0 +1,355 @@
+﻿#include "scheduler.h"
+
+// Strojenie balansu: algorytm genetyczny szuka stalych BalanceConfig, przy
+// ktorych prosta strategia wygrywa zadany odsetek gier i spedza zadana
+// liczbe tur na poziomie. Kandydat jest oceniany tysiacami gier bez konsoli
+// na puli watkow; wszyscy kandydaci graja na tych samych ziarnach (wspolne
+// liczby losowe), wiec roznica ocen to skutek parametrow, a nie losowania
+// innych swiatow. Wynik nie zalezy od liczby watkow.
+//
+// Uzycie: graRPG10_tune [--generations N] [--population N] [--games N]
+//                       [--max-turns N] [--target-win 0.5] [--target-turns N]
+//                       [--threads N] [--seed N] [--out wynik.json]
+
+#define TUNE_DEFAULT_GENERATIONS 20
+#define TUNE_DEFAULT_POPULATION 16
+#define TUNE_DEFAULT_GAMES 2000
+#define TUNE_DEFAULT_MAX_TURNS 3000
+#define TUNE_DEFAULT_TARGET_WIN 0.5
+#define TUNE_DEFAULT_TARGET_TURNS 750
+#define TUNE_MAX_POPULATION 256
+#define TUNE_MAX_GENERATIONS 1000
+#define TUNE_ELITE 2            // Najlepsi przechodza do nastepnego pokolenia bez zmian
+#define TUNE_TOURNAMENT 3
+#define TUNE_MUTATION_PERCENT 30
+#define TUNE_SLICE_TURNS 100    // Tury na jedno wywolanie runWorldTurns
+
+typedef struct {
+    const char* name;
+    int minimum;
+    int maximum;
+} TuneGene;
+
+static const TuneGene genes[] = {
+    { "enemy_health_per_level", 0, 30 },
+    { "enemy_attack_per_level", 0, 10 },
+    { "enemy_defense_per_level", 0, 6 },
+    { "trap_damage_per_level", 0, 10 },
+    { "drop_chance", 10, 100 },
+};
+
+#define TUNE_GENE_COUNT ((int)(sizeof(genes) / sizeof(genes[0])))
+
+typedef struct {
+    int genome[TUNE_GENE_COUNT];
+    int evaluated;
+    double fitness;        // Mniej - blizej celu
+    double winRate;
+    double turnsPerLevel;  // Tury na ukonczony poziom
+} Candidate;
+
+typedef struct {
+    int games;
+    int maxTurns;
+    double targetWin;
+    double targetTurns;
+    int threads;
+    unsigned long long seed;
+} TuneConfig;
+
+static int* geneField(BalanceConfig* balance, int gene) {
+    switch (gene) {
+    case 0: return &balance->enemyHealthPerLevel;
+    case 1: return &balance->enemyAttackPerLevel;
+    case 2: return &balance->enemyDefensePerLevel;
+    case 3: return &balance->trapDamagePerLevel;
+    default: return &balance->dropChance;
+    }
+}
+
+static BalanceConfig candidateBalance(const Candidate* candidate) {
+    BalanceConfig balance;
+    for (int g = 0; g < TUNE_GENE_COUNT; g++) {
+        *geneField(&balance, g) = candidate->genome[g];
+    }
+    return balance;
+}
+
+// Strategia jak w farmie swiatow: leczenie, podnoszenie, portal, poza tym
+// losowy ruch - losowania ze swiata, wiec gra zalezy tylko od ziarna
+static char tuneCommand(GameWorld* world, void* context) {
+    (void)context;
+    Player* player = world->player;
+    Inventory* inv = player->inventory;
+    if (player->health < player->max_health / 2) {
+        for (int y = 0; y < inv->height; y++) {
+            for (int x = 0; x < inv->width; x++) {
+                Item* item = inv->items[y][x];
+                if (item && item->category == ITEM_POTION) {
+                    useItem(world, player, item);
+                    y = inv->height;
+                    break;
+                }
+            }
+        }
+    }
+    if (groundItemAt(world, player->posX, player->posY) >= 0) {
+        return 'p';
+    }
+    if (world->portalActive && randomInt(&world->random, 4) != 0) {
+        if (world->portalX > player->posX) return 'd';
+        if (world->portalX < player->posX) return 'a';
+        if (world->portalY > player->posY) return 's';
+        return 'w';
+    }
+    static const char moves[] = { 'w', 'a', 's', 'd' };
+    return moves[randomInt(&world->random, 4)];
+}
+
+static BattleAction tuneBattleAction(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)enemy;
+    (void)round;
+    (void)context;
+    return world->player->health < world->player->max_health / 5 ? BATTLE_FLEE : BATTLE_ATTACK;
+}
+
+// Ziarno gry - to samo dla kazdego kandydata
+static unsigned long long gameSeed(const TuneConfig* config, int game) {
+    return config->seed + (unsigned long long)(game + 1) * 0x9E3779B97F4A7C15ull;
+}
+
+// Wszystkie gry kandydata naraz na puli watkow; gra bez rozstrzygniecia po
+// maxTurns liczy sie jako przegrana. Tempo to tury na ukonczony poziom -
+// smierc na poziomie nie skraca go, wiec nie oplaca sie zabijac gracza.
+static void evaluateCandidate(Candidate* candidate, const TuneConfig* config) {
+    BalanceConfig balance = candidateBalance(candidate);
+    WorldScheduler* scheduler = createWorldScheduler(config->threads);
+    for (int i = 0; i < config->games; i++) {
+        GameWorld* world = createSeededGameWorld("Strojenie", gameSeed(config, i));
+        world->balance = balance;
+        scheduleWorld(scheduler, world, tuneCommand, tuneBattleAction, NULL);
+    }
+
+    for (int done = 0; done < config->maxTurns; done += TUNE_SLICE_TURNS) {
+        int slice = config->maxTurns - done < TUNE_SLICE_TURNS ? config->maxTurns - done : TUNE_SLICE_TURNS;
+        if (runWorldTurns(scheduler, slice) == 0) break;
+    }
+
+    long long turns = 0;
+    long long completed = 0;
+    int wins = 0;
+    for (int i = 0; i < scheduledWorldCount(scheduler); i++) {
+        GameWorld* world = scheduledWorld(scheduler, i)->world;
+        wins += world->status == GAME_WON;
+        turns += world->turn;
+        completed += world->level - 1 + (world->status == GAME_WON);
+        freeGameWorld(world);
+    }
+    freeWorldScheduler(scheduler);
+
+    candidate->winRate = config->games > 0 ? (double)wins / config->games : 0.0;
+    candidate->turnsPerLevel = completed > 0 ? (double)turns / completed : (double)turns;
+    double winError = candidate->winRate - config->targetWin;
+    double turnError = (candidate->turnsPerLevel - config->targetTurns) / config->targetTurns;
+    candidate->fitness = winError * winError + turnError * turnError;
+    candidate->evaluated = 1;
+}
+
+static void randomGenome(Candidate* candidate, RandomState* random) {
+    for (int g = 0; g < TUNE_GENE_COUNT; g++) {
+        candidate->genome[g] = genes[g].minimum + randomInt(random, genes[g].maximum - genes[g].minimum + 1);
+    }
+    candidate->evaluated = 0;
+}
+
+static const Candidate* tournament(const Candidate* population, int count, RandomState* random) {
+    const Candidate* best = &population[randomInt(random, count)];
+    for (int i = 1; i < TUNE_TOURNAMENT; i++) {
+        const Candidate* other = &population[randomInt(random, count)];
+        if (other->fitness < best->fitness) best = other;
+    }
+    return best;
+}
+
+// Krzyzowanie jednostajne i mutacja o krok do 1/8 zakresu genu
+static void breed(Candidate* child, const Candidate* a, const Candidate* b, RandomState* random) {
+    for (int g = 0; g < TUNE_GENE_COUNT; g++) {
+        int value = randomInt(random, 2) ? a->genome[g] : b->genome[g];
+        if (randomInt(random, 100) < TUNE_MUTATION_PERCENT) {
+            int step = (genes[g].maximum - genes[g].minimum) / 8;
+            if (step < 1) step = 1;
+            value += randomInt(random, 2 * step + 1) - step;
+            if (value < genes[g].minimum) value = genes[g].minimum;
+            if (value > genes[g].maximum) value = genes[g].maximum;
+        }
+        child->genome[g] = value;
+    }
+    child->evaluated = 0;
+}
+
+static int compareCandidates(const void* a, const void* b) {
+    double fa = ((const Candidate*)a)->fitness;
+    double fb = ((const Candidate*)b)->fitness;
+    return fa < fb ? -1 : fa > fb ? 1 : 0;
+}
+
+static void writeGenomeJson(FILE* file, const Candidate* candidate) {
+    fprintf(file, "{ ");
+    for (int g = 0; g < TUNE_GENE_COUNT; g++) {
+        fprintf(file, "\"%s\": %d, ", genes[g].name, candidate->genome[g]);
+    }
+    fprintf(file, "\"win_rate\": %.4f, \"turns_per_level\": %.1f, \"fitness\": %.6f }", candidate->winRate,
+        candidate->turnsPerLevel, candidate->fitness);
+}
+
+static void writeTuneJson(FILE* file, const TuneConfig* config, const Candidate* defaults, const Candidate* best,
+    int generations, int population, double seconds) {
+    fprintf(file, "{\n");
+    fprintf(file, "  \"config\": {\n");
+    fprintf(file, "    \"map_width\": %d,\n", MAP_WIDTH);
+    fprintf(file, "    \"map_height\": %d,\n", MAP_HEIGHT);
+    fprintf(file, "    \"generations\": %d,\n", generations);
+    fprintf(file, "    \"population\": %d,\n", population);
+    fprintf(file, "    \"games\": %d,\n", config->games);
+    fprintf(file, "    \"max_turns\": %d,\n", config->maxTurns);
+    fprintf(file, "    \"target_win_rate\": %.3f,\n", config->targetWin);
+    fprintf(file, "    \"target_turns_per_level\": %.1f\n", config->targetTurns);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"defaults\": ");
+    writeGenomeJson(file, defaults);
+    fprintf(file, ",\n");
+    fprintf(file, "  \"generations\": [\n");
+    for (int g = 0; g < generations; g++) {
+        fprintf(file, "    ");
+        writeGenomeJson(file, &best[g]);
+        fprintf(file, "%s\n", g + 1 < generations ? "," : "");
+    }
+    fprintf(file, "  ],\n");
+    fprintf(file, "  \"best\": ");
+    writeGenomeJson(file, &best[generations - 1]);
+    fprintf(file, ",\n");
+    fprintf(file, "  \"seconds\": %.3f\n", seconds);
+    fprintf(file, "}\n");
+}
+
+static void printCandidate(const char* label, const Candidate* candidate) {
+    fprintf(stderr, "%s:", label);
+    for (int g = 0; g < TUNE_GENE_COUNT; g++) {
+        fprintf(stderr, " %s=%d", genes[g].name, candidate->genome[g]);
+    }
+    fprintf(stderr, " | wygrane %.1f%%, %.0f tur/poziom, ocena %.5f\n", candidate->winRate * 100.0,
+        candidate->turnsPerLevel, candidate->fitness);
+}
+
+int main(int argc, char* argv[]) {
+    TuneConfig config;
+    config.games = TUNE_DEFAULT_GAMES;
+    config.maxTurns = TUNE_DEFAULT_MAX_TURNS;
+    config.targetWin = TUNE_DEFAULT_TARGET_WIN;
+    config.targetTurns = TUNE_DEFAULT_TARGET_TURNS;
+    config.threads = 0;
+    config.seed = 12345;
+    int generations = TUNE_DEFAULT_GENERATIONS;
+    int populationSize = TUNE_DEFAULT_POPULATION;
+    const char* outPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc) {
+            generations = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--population") == 0 && i + 1 < argc) {
+            populationSize = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            config.games = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--max-turns") == 0 && i + 1 < argc) {
+            config.maxTurns = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--target-win") == 0 && i + 1 < argc) {
+            config.targetWin = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--target-turns") == 0 && i + 1 < argc) {
+            config.targetTurns = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else {
+            fprintf(stderr, "Uzycie: %s [--generations N] [--population N] [--games N] [--max-turns N] "
+                "[--target-win 0.5] [--target-turns N] [--threads N] [--seed N] [--out wynik.json]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (generations <= 0 || generations > TUNE_MAX_GENERATIONS || populationSize <= TUNE_ELITE ||
+        populationSize > TUNE_MAX_POPULATION || config.games <= 0 || config.maxTurns <= 0 ||
+        config.targetTurns <= 0.0) {
+        fprintf(stderr, "Nieprawidlowe parametry\n");
+        return 2;
+    }
+
+    initStringTable();
+    double startTime = nowSeconds();
+    RandomState random;
+    seedRandom(&random, config.seed);
+
+    // Punkt odniesienia - reczne ustawienia gry; sa tez w pierwszym pokoleniu
+    Candidate defaults;
+    BalanceConfig balance;
+    defaultBalance(&balance);
+    for (int g = 0; g < TUNE_GENE_COUNT; g++) {
+        defaults.genome[g] = *geneField(&balance, g);
+    }
+    evaluateCandidate(&defaults, &config);
+    printCandidate("Domyslne", &defaults);
+
+    static Candidate population[TUNE_MAX_POPULATION];
+    static Candidate next[TUNE_MAX_POPULATION];
+    static Candidate best[TUNE_MAX_GENERATIONS];
+    population[0] = defaults;
+    for (int i = 1; i < populationSize; i++) {
+        randomGenome(&population[i], &random);
+    }
+
+    for (int generation = 0; generation < generations; generation++) {
+        for (int i = 0; i < populationSize; i++) {
+            if (!population[i].evaluated) evaluateCandidate(&population[i], &config);
+        }
+        qsort(population, populationSize, sizeof(Candidate), compareCandidates);
+        best[generation] = population[0];
+
+        char label[32];
+        snprintf(label, sizeof(label), "Pokolenie %d", generation + 1);
+        printCandidate(label, &population[0]);
+
+        for (int i = 0; i < TUNE_ELITE; i++) {
+            next[i] = population[i];
+        }
+        for (int i = TUNE_ELITE; i < populationSize; i++) {
+            breed(&next[i], tournament(population, populationSize, &random),
+                tournament(population, populationSize, &random), &random);
+        }
+        memcpy(population, next, populationSize * sizeof(Candidate));
+    }
+
+    double seconds = nowSeconds() - startTime;
+    fprintf(stderr, "Strojenie: %d pokolen po %d kandydatow, %d gier na kandydata, %.1f s\n", generations,
+        populationSize, config.games, seconds);
+
+    if (outPath) {
+        FILE* file;
+        if (fopen_s(&file, outPath, "w") != 0) {
+            fprintf(stderr, "Nie mozna otworzyc pliku %s!\n", outPath);
+            return 1;
+        }
+        writeTuneJson(file, &config, &defaults, best, generations, populationSize, seconds);
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+﻿#include <chrono>
+#include "graRPG10.h"
+
+#define BENCH_ITEM_COUNT 64
+#define BENCH_ROUNDS 20000
+
+typedef struct {
+    const char* label;
+    int (*findSpace)(Inventory* inv, Item* item, int* outX, int* outY);
+    int (*add)(Inventory* inv, Item* item, int x, int y);
+    int (*detach)(Inventory* inv, Item* item);
+} PlacementApi;
+
+// Poprzednia implementacja - ogolne petle po item->width/item->height
+static int canPlaceGenericApi(Inventory* inv, Item* item, int x, int y) {
+    if (x < 0 || y < 0 || x + item->width > inv->width || y + item->height > inv->height) {
+        return 0;
+    }
+    return genericShapeOps.canPlace(inv, item, x, y);
+}
+
+// Przeszukiwanie jak dotychczas przy podnoszeniu przedmiotu
+static int findSpaceGenericApi(Inventory* inv, Item* item, int* outX, int* outY) {
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            if (canPlaceGenericApi(inv, item, x, y)) {
+                *outX = x;
+                *outY = y;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int addGenericApi(Inventory* inv, Item* item, int x, int y) {
+    if (!canPlaceGenericApi(inv, item, x, y)) {
+        return 0;
+    }
+    genericShapeOps.place(inv, item, x, y);
+    item->posX = x;
+    item->posY = y;
+    item->inInventory = 1;
+    return 1;
+}
+
+static int detachGenericApi(Inventory* inv, Item* item) {
+    if (!item->inInventory) return 0;
+    genericShapeOps.clear(inv, item, item->posX, item->posY);
+    item->inInventory = 0;
+    return 1;
+}
+
+// Maski ksztaltow bez utrzymywania InventoryIndex - porownanie z ogolnymi
+// petlami mierzy tylko zmiane ksztaltow, a nie koszt indeksu
+static int addShapeApi(Inventory* inv, Item* item, int x, int y) {
+    if (x < 0 || y < 0 || x + item->width > inv->width || y + item->height > inv->height) {
+        return 0;
+    }
+    const ItemShapeOps* ops = findShapeOps(inv, item);
+    if (!ops->canPlace(inv, item, x, y)) {
+        return 0;
+    }
+    ops->place(inv, item, x, y);
+    item->posX = x;
+    item->posY = y;
+    item->inInventory = 1;
+    return 1;
+}
+
+static int detachShapeApi(Inventory* inv, Item* item) {
+    if (!item->inInventory) return 0;
+    findShapeOps(inv, item)->clear(inv, item, item->posX, item->posY);
+    item->inInventory = 0;
+    return 1;
+}
+
+// Ostatni wiersz to pelne API gry: maski plus indeks kategorii
+static const PlacementApi placementApis[] = {
+    { "ogolne petle", findSpaceGenericApi, addGenericApi, detachGenericApi },
+    { "maski ksztaltow", findInventorySpace, addShapeApi, detachShapeApi },
+    { "maski + indeks", findInventorySpace, addItemToInventory, detachItemFromInventory },
+};
+
+// Wypelnia ekwipunek przedmiotami pierwsza wolna pozycja (jak przy podnoszeniu)
+// az do zapelnienia, po czym oproznia go i zaczyna od nowa.
+static double runPlacementRounds(const PlacementApi* api, Item** items, long long* placements) {
+    Inventory* inv = createInventory(INVENTORY_WIDTH, INVENTORY_HEIGHT);
+    Item* placed[BENCH_ITEM_COUNT];
+    long long count = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        int placedCount = 0;
+        for (int n = 0; n < BENCH_ITEM_COUNT; n++) {
+            Item* item = items[(n + round) % BENCH_ITEM_COUNT];
+            int x, y;
+            if (api->findSpace(inv, item, &x, &y) && api->add(inv, item, x, y)) {
+                placed[placedCount++] = item;
+                count++;
+            }
+        }
+        for (int n = 0; n < placedCount; n++) {
+            api->detach(inv, placed[n]);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    freeInventory(inv);
+    *placements = count;
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void runInventoryBenchmark() {
+    Item* items[BENCH_ITEM_COUNT];
+    RandomState random;
+    seedRandom(&random, newWorldSeed());
+    for (int i = 0; i < BENCH_ITEM_COUNT; i++) {
+        int type = randomInt(&random, 100);
+        items[i] = (type < 50) ? createHealthPotion() : (type < 75) ? createSword(&random) : createArmor(&random);
+    }
+
+    printf("==== BENCHMARK EKWIPUNKU ====\n");
+    double baseline = 0.0;
+    for (int i = 0; i < (int)(sizeof(placementApis) / sizeof(placementApis[0])); i++) {
+        long long placements = 0;
+        double seconds = runPlacementRounds(&placementApis[i], items, &placements);
+        double perSecond = placements / seconds;
+        if (i == 0) baseline = perSecond;
+        printf("%-16s %10lld umieszczen w %.3f s -> %.0f umieszczen/s (x%.2f)\n",
+            placementApis[i].label, placements, seconds, perSecond, perSecond / baseline);
+    }
+
+    for (int i = 0; i < BENCH_ITEM_COUNT; i++) {
+        trackedFree(items[i]);
+    }
+}
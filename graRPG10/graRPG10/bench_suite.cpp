@@ -0,0 +1,559 @@
+﻿#include "aoi.h"
+#include "autoplayer.h"
+#include "graRPG10.h"
+
+// Zestaw mikrobenchmarkow goracych funkcji gry. Kazdy pomiar jest powtarzany
+// tak dlugo, az przekroczy minimalny czas, a wyniki trafiaja do pliku JSON
+// razem z rozmiarem mapy i liczba obiektow, dla ktorych zbudowano program.
+
+#define BENCH_MIN_TIME 0.25        // Minimalny czas pomiaru (s)
+#define BENCH_QUICK_MIN_TIME 0.01  // --quick: szybki przebieg (np. w ctest)
+#define BENCH_SAVE_PATH "bench_savegame.dat"
+#define BENCH_AOI_OBSERVERS 256    // Gracze serwera w pomiarze pola widzenia
+#define BENCH_AOI_RADIUS 8
+#define BENCH_WORLD_SEED 12345
+
+#ifdef _WIN32
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+typedef struct {
+    GameWorld* world;
+    Enemy enemyTemplate;
+    Item* items[3];
+    int cursor;             // Pseudolosowy indeks zmieniany w kolejnych iteracjach
+    long long sink;         // Wyniki sumowane, zeby kompilator nie usunal wywolan
+    long long bytesPerOp;   // Bajty przetworzone w jednej iteracji (0 - nie dotyczy)
+} BenchContext;
+
+typedef void (*BenchFunction)(BenchContext* ctx, long long iterations);
+typedef void (*BenchSetupFunction)(BenchContext* ctx);
+
+// Kazdy pomiar dostaje wlasny swiat z setup i oddaje go w teardown (poza
+// mierzonym czasem) - wynik nie zalezy od kolejnosci pomiarow ani --filter
+typedef struct {
+    const char* name;
+    BenchFunction run;
+    BenchSetupFunction setup;
+    BenchSetupFunction teardown;
+} Benchmark;
+
+typedef struct {
+    const char* name;
+    long long iterations;
+    double seconds;
+    long long bytesPerOp;
+} BenchResult;
+
+// Rozmiary zapisu swiata benchmarku w roznych postaciach
+typedef struct {
+    long long structBytes;      // Surowe struktury jak w formacie sprzed sekcji
+    long long varintBytes;      // Sekcje bez kompresji
+    long long compressedBytes;  // Sekcje spakowane LZ
+} SaveSizes;
+
+static BattleAction benchAlwaysAttack(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)world;
+    (void)enemy;
+    (void)round;
+    (void)context;
+    return BATTLE_ATTACK;
+}
+
+// Swiat ze stalego seeda, przedmioty do ekwipunku i przeciwnik do walki
+static void setupBenchWorld(BenchContext* ctx) {
+    ctx->world = createSeededGameWorld("Bench", BENCH_WORLD_SEED);
+    ctx->enemyTemplate = *ctx->world->enemies[0];
+    ctx->items[0] = createHealthPotion();
+    ctx->items[1] = createSword(&ctx->world->random);
+    ctx->items[2] = createArmor(&ctx->world->random);
+    ctx->cursor = 1;
+
+    // Ekwipunek czesciowo zapelniony, zeby wyszukiwanie miejsca nie konczylo sie na (0,0)
+    Inventory* inv = ctx->world->player->inventory;
+    for (int y = 0; y < inv->height / 2; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            inv->slots[y][x] = 1;
+        }
+        if (inv->rowMask) {
+            inv->rowMask[y] = (inv->width >= 32) ? 0xFFFFFFFFu : ((1u << inv->width) - 1u);
+        }
+    }
+}
+
+static void freeBenchWorld(BenchContext* ctx) {
+    // Zajete sloty nie maja przedmiotow - czyszczenie przed zwolnieniem swiata
+    Inventory* inv = ctx->world->player->inventory;
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            inv->slots[y][x] = 0;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        trackedFree(ctx->items[i]);
+        ctx->items[i] = NULL;
+    }
+    freeGameWorld(ctx->world);
+    ctx->world = NULL;
+}
+
+static void benchIsHere(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    for (long long i = 0; i < iterations; i++) {
+        int x = (ctx->cursor = ctx->cursor * 1103515245 + 12345) & 0x7FFFFFFF;
+        ctx->sink += isHere(world, x % MAP_WIDTH, (x / MAP_WIDTH) % MAP_HEIGHT,
+            world->enemyCount, world->trapCount);
+    }
+}
+
+static void benchCanPlaceItem(BenchContext* ctx, long long iterations) {
+    Inventory* inv = ctx->world->player->inventory;
+    for (long long i = 0; i < iterations; i++) {
+        int x = (ctx->cursor = ctx->cursor * 1103515245 + 12345) & 0x7FFFFFFF;
+        Item* item = ctx->items[x % 3];
+        ctx->sink += canPlaceItem(inv, item, x % inv->width, (x / inv->width) % inv->height);
+    }
+}
+
+// Dodanie przedmiotu w pierwszym wolnym miejscu i zdjecie go z powrotem
+static void benchAddItemToInventory(BenchContext* ctx, long long iterations) {
+    Inventory* inv = ctx->world->player->inventory;
+    for (long long i = 0; i < iterations; i++) {
+        Item* item = ctx->items[i % 3];
+        int x, y;
+        if (findInventorySpace(inv, item, &x, &y) && addItemToInventory(inv, item, x, y)) {
+            detachItemFromInventory(inv, item);
+            ctx->sink++;
+        }
+    }
+}
+
+// Zapytania indeksu na ekwipunku wypelnionym miksturami o roznej sile
+// oraz broniami i zbrojami - bez przegladania siatki
+static void benchInventoryQueries(BenchContext* ctx, long long iterations) {
+    Inventory* inv = createInventory(INVENTORY_WIDTH, INVENTORY_HEIGHT);
+    RandomState random;
+    seedRandom(&random, 7);
+    for (int n = 0;; n++) {
+        Item* item = n % 3 == 0 ? createSword(&random) : n % 3 == 1 ? createArmor(&random) : createHealthPotion();
+        if (item->category == ITEM_POTION) item->healthBonus = 1 + randomInt(&random, 100);
+        int x, y;
+        if (!findInventorySpace(inv, item, &x, &y) || !addItemToInventory(inv, item, x, y)) {
+            trackedFree(item);
+            break;
+        }
+    }
+
+    for (long long i = 0; i < iterations; i++) {
+        int missing = (ctx->cursor = ctx->cursor * 1103515245 + 12345) & 0x7F;
+        Item* potion = quickUsePotion(inv, missing);
+        Item* sword = bestInventoryItem(inv, ITEM_SWORD);
+        ctx->sink += (potion ? potion->healthBonus : 0) + (sword ? sword->attackBonus : 0);
+    }
+    freeInventory(inv);
+}
+
+static void benchReloadMap(BenchContext* ctx, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        reloadMap(ctx->world);
+    }
+    ctx->sink += ctx->world->map[0][0];
+}
+
+// Standardowe wyjscie jest na czas benchmarkow przekierowane do pustego urzadzenia
+static void benchPrintMap(BenchContext* ctx, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        printMap(ctx->world);
+    }
+    fflush(stdout);
+}
+
+// Pelna walka z kopia przeciwnika az do jego pokonania
+static void benchBattle(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    for (long long i = 0; i < iterations; i++) {
+        Enemy enemy = ctx->enemyTemplate;
+        world->player->health = world->player->max_health;
+        world->enemiesDefeated = 0;
+        world->status = GAME_RUNNING;
+        ctx->sink += battle(world, &enemy, benchAlwaysAttack, NULL);
+        drainEvents(world->events, NULL, 0);
+    }
+}
+
+static void benchMoveEnemySweep(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    for (long long i = 0; i < iterations; i++) {
+        for (int e = 0; e < world->enemyCount; e++) {
+            moveEnemy(world->enemies[e], &world->random);
+        }
+    }
+    ctx->sink += world->enemyCount > 0 ? world->enemies[0]->EposX : 0;
+}
+
+// Ruchy przeciwnikow jednej tury z kolejki ruchow
+static void benchEnemyTurn(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    for (long long i = 0; i < iterations; i++) {
+        ctx->sink += advanceEnemies(world, ENEMY_TICKS_PER_TURN);
+    }
+}
+
+// Kilka efektow na kazdym przeciwniku - okresy do 96 tickow, wiec czesc
+// efektow zsypuje sie z wyzszego poziomu kola
+static void setupStatusEffects(BenchContext* ctx) {
+    setupBenchWorld(ctx);
+    GameWorld* world = ctx->world;
+    for (int i = 0; world->enemyCount > 0 && world->effects.count < world->enemyCount * 4; i++) {
+        applyStatusEffect(world, 1, i % world->enemyCount, EFFECT_BLEEDING, 0, 1 + i % 96, 1 << 30);
+    }
+    drainEvents(world->events, NULL, 0);
+}
+
+// Tick kola efektow
+static void benchStatusEffects(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    for (long long i = 0; i < iterations; i++) {
+        advanceStatusEffects(world, 1);
+    }
+    ctx->sink += world->effects.count;
+}
+
+// Pola wplywu od zera - rozmycie calej mapy
+static void benchInfluenceRebuild(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    for (long long i = 0; i < iterations; i++) {
+        rebuildInfluence(world);
+    }
+    ctx->sink += influenceAt(world, INFLUENCE_THREAT, MAP_WIDTH / 2, MAP_HEIGHT / 2);
+}
+
+// Ruch jednego przeciwnika z aktualizacja pol stemplami
+static void benchSteerEnemy(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    for (long long i = 0; i < iterations && world->enemyCount > 0; i++) {
+        Enemy* enemy = world->enemies[i % world->enemyCount];
+        steerEnemy(world, enemy);
+        ctx->sink += enemy->EposX;
+    }
+}
+
+static void benchCreateGameWorld(BenchContext* ctx, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        GameWorld* world = createGameWorld("Bench");
+        ctx->sink += world->enemyCount;
+        freeGameWorld(world);
+    }
+}
+
+static void benchNextLevel(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    for (long long i = 0; i < iterations; i++) {
+        world->level = 1;
+        nextLevel(world);
+        drainEvents(world->events, NULL, 0);
+        ctx->sink += world->enemyCount;
+    }
+}
+
+static long long serializedSize(GameWorld* world) {
+    size_t size;
+    trackedFree(serializeSave(world, &size));
+    return (long long)size;
+}
+
+// Serializacja w pamieci - bez kosztu dysku
+static void benchSerializeSave(BenchContext* ctx, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        size_t size;
+        void* data = serializeSave(ctx->world, &size);
+        ctx->sink += (long long)size;
+        ctx->bytesPerOp = (long long)size;
+        trackedFree(data);
+    }
+}
+
+static void benchParseSave(BenchContext* ctx, long long iterations) {
+    size_t size;
+    void* data = serializeSave(ctx->world, &size);
+    ctx->bytesPerOp = (long long)size;
+    for (long long i = 0; i < iterations; i++) {
+        GameWorld* world = parseSave(data, size);
+        if (world) {
+            ctx->sink += world->enemyCount;
+            freeGameWorld(world);
+        }
+    }
+    trackedFree(data);
+}
+
+static void benchSaveGame(BenchContext* ctx, long long iterations) {
+    ctx->bytesPerOp = serializedSize(ctx->world);
+    for (long long i = 0; i < iterations; i++) {
+        ctx->sink += writeSaveFile(ctx->world, BENCH_SAVE_PATH);
+    }
+}
+
+static void benchLoadGame(BenchContext* ctx, long long iterations) {
+    writeSaveFile(ctx->world, BENCH_SAVE_PATH);
+    ctx->bytesPerOp = serializedSize(ctx->world);
+    for (long long i = 0; i < iterations; i++) {
+        GameWorld* world = readSaveFile(BENCH_SAVE_PATH);
+        if (world) {
+            ctx->sink += world->enemyCount;
+            freeGameWorld(world);
+        }
+    }
+}
+
+static void benchCloneGameWorld(BenchContext* ctx, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        GameWorld* clone = cloneGameWorld(ctx->world);
+        ctx->sink += clone->enemyCount;
+        freeGameWorld(clone);
+    }
+}
+
+// Krok symulacji bota przeszukujacego: klon, jedna tura, zwolnienie klonu
+static void benchCloneAndStep(BenchContext* ctx, long long iterations) {
+    static const char moves[] = "wasd";
+    for (long long i = 0; i < iterations; i++) {
+        GameWorld* clone = cloneGameWorld(ctx->world);
+        clone->status = GAME_RUNNING;
+        clone->player->health = clone->player->max_health;
+        stepWorld(clone, moves[i & 3], benchAlwaysAttack, NULL);
+        ctx->sink += clone->enemyCount + clone->player->health;
+        freeGameWorld(clone);
+    }
+}
+
+// Jedna rozgrywka MCTS autogracza: jedna decyzja na klonie swiata z
+// liczba rozgrywek rowna liczbie iteracji, jeden watek (ns/op - na rozgrywke)
+static void benchMctsRollout(BenchContext* ctx, long long iterations) {
+    AutoplayerConfig config;
+    memset(&config, 0, sizeof(AutoplayerConfig));
+    config.threads = 1;
+    config.maxRollouts = iterations;
+    Autoplayer* autoplayer = createAutoplayer(&config);
+    GameWorld* clone = cloneGameWorld(ctx->world);
+    clone->status = GAME_RUNNING;
+    clone->player->health = clone->player->max_health;
+    autoplayerTurn(autoplayer, clone);
+    ctx->sink += autoplayerStats(autoplayer).rollouts;
+    freeGameWorld(clone);
+    freeAutoplayer(autoplayer);
+}
+
+// Jeden tick rozsylania zmian serwera: siatka ze wszystkich przeciwnikow
+// i pulapek (co osmy obiekt zmieniony), potem pola widzenia wszystkich
+// obserwatorow, ktorzy co tick przesuwaja sie o jedno pole
+static void benchAoiTick(BenchContext* ctx, long long iterations) {
+    GameWorld* world = ctx->world;
+    AoiGrid* grid = createAoiGrid(MAP_WIDTH, MAP_HEIGHT, AOI_DEFAULT_CELL);
+    AoiObserver* observers = (AoiObserver*)calloc(BENCH_AOI_OBSERVERS, sizeof(AoiObserver));
+    int positions[BENCH_AOI_OBSERVERS][2];
+    for (int o = 0; o < BENCH_AOI_OBSERVERS; o++) {
+        positions[o][0] = (o * 7919) % MAP_WIDTH;
+        positions[o][1] = (o * 104729) % MAP_HEIGHT;
+    }
+    for (long long i = 0; i < iterations; i++) {
+        aoiClear(grid);
+        for (int e = 0; e < world->enemyCount; e++) {
+            aoiAdd(grid, AOI_KEY(AOI_ENEMY, e), world->enemies[e]->EposX, world->enemies[e]->EposY, ((e + i) & 7) == 0);
+        }
+        for (int t = 0; t < world->trapCount; t++) {
+            aoiAdd(grid, AOI_KEY(AOI_TRAP, t), world->traps[t]->posX, world->traps[t]->posY, 0);
+        }
+        aoiBuild(grid);
+        for (int o = 0; o < BENCH_AOI_OBSERVERS; o++) {
+            positions[o][0] = (positions[o][0] + 1) % MAP_WIDTH;
+            aoiUpdateObserver(grid, &observers[o], positions[o][0], positions[o][1], BENCH_AOI_RADIUS);
+            ctx->sink += observers[o].updates.count + observers[o].leaves.count;
+        }
+    }
+    for (int o = 0; o < BENCH_AOI_OBSERVERS; o++) {
+        freeAoiObserver(&observers[o]);
+    }
+    free(observers);
+    freeAoiGrid(grid);
+}
+
+static const Benchmark benchmarks[] = {
+    { "isHere", benchIsHere, setupBenchWorld, freeBenchWorld },
+    { "canPlaceItem", benchCanPlaceItem, setupBenchWorld, freeBenchWorld },
+    { "addItemToInventory", benchAddItemToInventory, setupBenchWorld, freeBenchWorld },
+    { "inventoryQueries", benchInventoryQueries, setupBenchWorld, freeBenchWorld },
+    { "reloadMap", benchReloadMap, setupBenchWorld, freeBenchWorld },
+    { "printMap", benchPrintMap, setupBenchWorld, freeBenchWorld },
+    { "battle", benchBattle, setupBenchWorld, freeBenchWorld },
+    { "moveEnemySweep", benchMoveEnemySweep, setupBenchWorld, freeBenchWorld },
+    { "enemyTurn", benchEnemyTurn, setupBenchWorld, freeBenchWorld },
+    { "statusEffects", benchStatusEffects, setupStatusEffects, freeBenchWorld },
+    { "influenceRebuild", benchInfluenceRebuild, setupBenchWorld, freeBenchWorld },
+    { "steerEnemy", benchSteerEnemy, setupBenchWorld, freeBenchWorld },
+    { "createGameWorld", benchCreateGameWorld, setupBenchWorld, freeBenchWorld },
+    { "nextLevel", benchNextLevel, setupBenchWorld, freeBenchWorld },
+    { "serializeSave", benchSerializeSave, setupBenchWorld, freeBenchWorld },
+    { "parseSave", benchParseSave, setupBenchWorld, freeBenchWorld },
+    { "saveGame", benchSaveGame, setupBenchWorld, freeBenchWorld },
+    { "loadGame", benchLoadGame, setupBenchWorld, freeBenchWorld },
+    { "aoiTick", benchAoiTick, setupBenchWorld, freeBenchWorld },
+    { "cloneGameWorld", benchCloneGameWorld, setupBenchWorld, freeBenchWorld },
+    { "cloneAndStep", benchCloneAndStep, setupBenchWorld, freeBenchWorld },
+    { "mctsRollout", benchMctsRollout, setupBenchWorld, freeBenchWorld },
+};
+
+// Podwaja liczbe iteracji, az pomiar potrwa co najmniej minTime
+static BenchResult runBenchmark(const Benchmark* bench, BenchContext* ctx, double minTime) {
+    BenchResult result = { bench->name, 0, 0.0, 0 };
+    long long iterations = 1;
+    while (1) {
+        ctx->bytesPerOp = 0;
+        bench->setup(ctx);
+        double start = nowSeconds();
+        bench->run(ctx, iterations);
+        double elapsed = nowSeconds() - start;
+        bench->teardown(ctx);
+
+        if (elapsed >= minTime || iterations >= (1LL << 40)) {
+            result.iterations = iterations;
+            result.seconds = elapsed;
+            result.bytesPerOp = ctx->bytesPerOp;
+            return result;
+        }
+        iterations *= 2;
+    }
+}
+
+static double megabytesPerSecond(const BenchResult* result) {
+    return (double)result->bytesPerOp * (double)result->iterations / result->seconds / (1024.0 * 1024.0);
+}
+
+static SaveSizes measureSaveSizes(GameWorld* world) {
+    SaveSizes sizes;
+    Inventory* inv = world->player->inventory;
+    long long itemCount = 0;
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            if (inv->items[y][x] && inv->items[y][x]->posX == x && inv->items[y][x]->posY == y) itemCount++;
+        }
+    }
+    sizes.structBytes = 21 * sizeof(int) + 50 + EQUIP_SLOT_COUNT * 2 * sizeof(int) +
+        (itemCount + world->groundItemCount) * sizeof(Item) +
+        world->enemyCount * sizeof(Enemy) + world->trapCount * sizeof(Trap);
+
+    int compression = saveCompression;
+    saveCompression = 0;
+    sizes.varintBytes = serializedSize(world);
+    saveCompression = 1;
+    sizes.compressedBytes = serializedSize(world);
+    saveCompression = compression;
+    return sizes;
+}
+
+static void writeResultsJson(FILE* file, const BenchResult* results, int count, double minTime, const SaveSizes* save) {
+    fprintf(file, "{\n");
+    fprintf(file, "  \"config\": {\n");
+    fprintf(file, "    \"map_width\": %d,\n", MAP_WIDTH);
+    fprintf(file, "    \"map_height\": %d,\n", MAP_HEIGHT);
+    fprintf(file, "    \"max_enemies\": %d,\n", MAX_ENEMIES);
+    fprintf(file, "    \"max_traps\": %d,\n", MAX_TRAPS);
+    fprintf(file, "    \"min_time_s\": %.3f\n", minTime);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"save\": {\n");
+    fprintf(file, "    \"struct_bytes\": %lld,\n", save->structBytes);
+    fprintf(file, "    \"varint_bytes\": %lld,\n", save->varintBytes);
+    fprintf(file, "    \"compressed_bytes\": %lld,\n", save->compressedBytes);
+    fprintf(file, "    \"compression_ratio\": %.3f\n", (double)save->structBytes / (double)save->compressedBytes);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        double nsPerOp = results[i].seconds * 1e9 / (double)results[i].iterations;
+        fprintf(file, "    { \"name\": \"%s\", \"iterations\": %lld, \"seconds\": %.6f, \"ns_per_op\": %.1f",
+            results[i].name, results[i].iterations, results[i].seconds, nsPerOp);
+        if (results[i].bytesPerOp > 0) {
+            fprintf(file, ", \"bytes_per_op\": %lld, \"mb_per_s\": %.2f", results[i].bytesPerOp,
+                megabytesPerSecond(&results[i]));
+        }
+        fprintf(file, " }%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* outPath = "bench_results.json";
+    const char* filter = NULL;
+    double minTime = BENCH_MIN_TIME;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            minTime = BENCH_QUICK_MIN_TIME;
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else {
+            fprintf(stderr, "Uzycie: %s [--quick] [--out plik.json] [--filter nazwa]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Staly seed - kazdy przebieg mierzy ten sam swiat
+    srand(12345);
+    initStringTable();
+
+    FILE* file;
+    if (fopen_s(&file, outPath, "w") != 0) {
+        fprintf(stderr, "Nie mozna otworzyc pliku wynikow: %s\n", outPath);
+        return 1;
+    }
+
+    // Gra pisze na stdout (mapa, komunikaty) - wyniki ida na stderr i do pliku JSON
+    fflush(stdout);
+    if (!freopen(NULL_DEVICE, "w", stdout)) {
+        fprintf(stderr, "Nie mozna przekierowac standardowego wyjscia\n");
+        fclose(file);
+        return 1;
+    }
+
+    BenchContext ctx;
+    memset(&ctx, 0, sizeof(BenchContext));
+
+    const int benchmarkCount = (int)(sizeof(benchmarks) / sizeof(benchmarks[0]));
+    BenchResult results[sizeof(benchmarks) / sizeof(benchmarks[0])];
+    int resultCount = 0;
+
+    fprintf(stderr, "Mapa %dx%d, przeciwnicy %d, pulapki %d\n", MAP_WIDTH, MAP_HEIGHT, MAX_ENEMIES, MAX_TRAPS);
+    for (int i = 0; i < benchmarkCount; i++) {
+        if (filter && strcmp(filter, benchmarks[i].name) != 0) continue;
+
+        BenchResult result = runBenchmark(&benchmarks[i], &ctx, minTime);
+        results[resultCount++] = result;
+        fprintf(stderr, "%-20s %12.1f ns/op  (%lld iteracji)", result.name,
+            result.seconds * 1e9 / (double)result.iterations, result.iterations);
+        if (result.bytesPerOp > 0) {
+            fprintf(stderr, "  %8.1f MB/s", megabytesPerSecond(&result));
+        }
+        fprintf(stderr, "\n");
+    }
+
+    setupBenchWorld(&ctx);
+    SaveSizes saveSizes = measureSaveSizes(ctx.world);
+    freeBenchWorld(&ctx);
+    fprintf(stderr, "Zapis: struktury %lld B, varint %lld B, LZ %lld B (kompresja %.2fx)\n",
+        saveSizes.structBytes, saveSizes.varintBytes, saveSizes.compressedBytes,
+        (double)saveSizes.structBytes / (double)saveSizes.compressedBytes);
+
+    writeResultsJson(file, results, resultCount, minTime, &saveSizes);
+    fclose(file);
+    remove(BENCH_SAVE_PATH);
+
+    fprintf(stderr, "Wyniki zapisano do %s (suma kontrolna %lld)\n", outPath, ctx.sink);
+    return 0;
+}
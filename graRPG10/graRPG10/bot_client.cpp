@@ -0,0 +1,357 @@
+﻿#include <thread>
+#include <errno.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "graRPG10.h"
+#include "netproto.h"
+#include "server.h"
+
+// Obciazenie serwera wieloosobowego przez loopback: wiele botow w jednym
+// watku na epoll. Bot po kazdym ticku wysyla losowe polecenie i mierzy czas
+// do potwierdzenia (NET_ACK), a kazda wiadomosc serwera jest sprawdzana
+// z formatem z netproto.h. Zabity bot laczy sie od nowa jako nowy gracz.
+// --spawn-server uruchamia serwer w tym samym procesie (test ctest).
+//
+// Uzycie: graRPG10_bots [--port N] [--clients N] [--ticks N] [--tick-ms N]
+//                       [--max-latency-ms N] [--spawn-server] [--view-radius N]
+
+#define BOT_IN_SIZE (NET_MAX_MESSAGE + 2)
+#define BOT_SEQ_WINDOW 256
+#define LATENCY_BUCKET_US 100  // Histogram opoznien co 0,1 ms
+#define LATENCY_BUCKETS 20000
+
+typedef struct {
+    int fd;
+    int welcomed;
+    int died;        // NET_DIED - zamkniecie polaczenia nie jest bledem
+    unsigned char in[BOT_IN_SIZE];
+    int inUsed;
+    unsigned short seq;
+    double sentAt[BOT_SEQ_WINDOW];
+    long long ticks;
+    unsigned int random;
+} Bot;
+
+typedef struct {
+    long long counts[LATENCY_BUCKETS + 1];  // Ostatni kubelek - wszystko powyzej
+    long long samples;
+    double max;
+} LatencyHistogram;
+
+typedef struct {
+    long long deaths;
+    long long disconnects;     // Rozlaczenia inne niz po smierci
+    long long protocolErrors;
+    long long records;
+    LatencyHistogram latency;
+} BotStats;
+
+static int botPort = NET_DEFAULT_PORT;
+static int epollFd = -1;
+
+static unsigned int nextRandom(Bot* bot) {
+    // xorshift - boty nie dziela rand() z serwerem w tym samym procesie
+    bot->random ^= bot->random << 13;
+    bot->random ^= bot->random >> 17;
+    bot->random ^= bot->random << 5;
+    return bot->random;
+}
+
+static void addLatency(LatencyHistogram* histogram, double seconds) {
+    int bucket = (int)(seconds * 1e6 / LATENCY_BUCKET_US);
+    histogram->counts[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS]++;
+    histogram->samples++;
+    if (seconds > histogram->max) histogram->max = seconds;
+}
+
+static double latencyPercentile(const LatencyHistogram* histogram, double fraction) {
+    long long target = (long long)(histogram->samples * fraction);
+    long long seen = 0;
+    for (int i = 0; i <= LATENCY_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen > target) return (i + 1) * LATENCY_BUCKET_US / 1e6;
+    }
+    return histogram->max;
+}
+
+static int sendAll(int fd, const unsigned char* data, int size) {
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        data += sent;
+        size -= (int)sent;
+    }
+    return 1;
+}
+
+static int connectBot(Bot* bot, int index) {
+    bot->fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((unsigned short)botPort);
+    if (bot->fd < 0 || connect(bot->fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        if (bot->fd >= 0) close(bot->fd);
+        bot->fd = -1;
+        return 0;
+    }
+    int one = 1;
+    setsockopt(bot->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    char name[16];
+    int length = snprintf(name, sizeof(name), "bot%d", index);
+    unsigned char hello[NET_HEADER_SIZE + 1 + sizeof(name)];
+    unsigned char* p = netPutU16(hello, 1 + 1 + length);
+    p = netPutU8(p, NET_HELLO);
+    p = netPutU8(p, length);
+    memcpy(p, name, length);
+    if (!sendAll(bot->fd, hello, NET_HEADER_SIZE + 1 + length)) {
+        close(bot->fd);
+        bot->fd = -1;
+        return 0;
+    }
+
+    fcntl(bot->fd, F_SETFL, fcntl(bot->fd, F_GETFL) | O_NONBLOCK);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u32 = (unsigned)index;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, bot->fd, &event);
+    bot->welcomed = 0;
+    bot->died = 0;
+    bot->inUsed = 0;
+    return 1;
+}
+
+static void closeBot(Bot* bot) {
+    if (bot->fd < 0) return;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, bot->fd, NULL);
+    close(bot->fd);
+    bot->fd = -1;
+}
+
+static void sendCommand(Bot* bot) {
+    static const char commands[] = "wasdwasdwasdpi";
+    unsigned char message[NET_HEADER_SIZE + 3];
+    unsigned char* p = netPutU16(message, 1 + 3);
+    p = netPutU8(p, NET_COMMAND);
+    p = netPutU16(p, ++bot->seq);
+    netPutU8(p, commands[nextRandom(bot) % (sizeof(commands) - 1)]);
+    bot->sentAt[bot->seq % BOT_SEQ_WINDOW] = nowSeconds();
+    sendAll(bot->fd, message, sizeof(message));
+}
+
+// Sprawdza rekordy ticku; 0 - rekordy nie zgadzaja sie z dlugoscia wiadomosci
+static int checkTickRecords(const unsigned char* p, const unsigned char* end, BotStats* stats) {
+    static const int recordSizes[] = { 0, 11, 13, 4, 9, 7, 8 };
+    while (p < end) {
+        int type = p[0];
+        if (type < NET_RECORD_WORLD || type > NET_RECORD_ITEM) return 0;
+        int size = recordSizes[type];
+        if (end - p < size) return 0;
+        if (type == NET_RECORD_LEAVE && (p[1] < NET_RECORD_PLAYER || p[1] == NET_RECORD_LEAVE || p[1] > NET_RECORD_ITEM)) {
+            return 0;
+        }
+        p += size;
+        stats->records++;
+    }
+    return 1;
+}
+
+// 0 - bledna wiadomosc
+static int handleServerMessage(Bot* bot, const unsigned char* data, int size, BotStats* stats) {
+    switch (data[0]) {
+    case NET_WELCOME:
+        bot->welcomed = 1;
+        return size == 9;
+    case NET_TICK:
+        if (size < 6 || !bot->welcomed || !checkTickRecords(data + 6, data + size, stats)) return 0;
+        if (!(data[5] & NET_TICK_CONTINUED)) {
+            bot->ticks++;
+            sendCommand(bot);
+        }
+        return 1;
+    case NET_ACK: {
+        if (size != 7) return 0;
+        unsigned short seq = (unsigned short)netGetU16(data + 1);
+        addLatency(&stats->latency, nowSeconds() - bot->sentAt[seq % BOT_SEQ_WINDOW]);
+        return 1;
+    }
+    case NET_INVENTORY:
+        return size >= 2 && size == 2 + data[1] * 5;
+    case NET_DIED:
+        stats->deaths++;
+        bot->died = 1;
+        return size == 5;
+    default:
+        return 0;
+    }
+}
+
+// 0 - polaczenie zamkniete
+static int readBot(Bot* bot, BotStats* stats) {
+    for (;;) {
+        ssize_t received = recv(bot->fd, bot->in + bot->inUsed, BOT_IN_SIZE - bot->inUsed, 0);
+        if (received == 0) return 0;
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        bot->inUsed += (int)received;
+
+        int offset = 0;
+        while (bot->inUsed - offset >= 2) {
+            int length = (int)netGetU16(bot->in + offset);
+            if (length == 0) {
+                stats->protocolErrors++;
+                return 0;
+            }
+            if (bot->inUsed - offset - 2 < length) break;
+            if (!handleServerMessage(bot, bot->in + offset + 2, length, stats)) {
+                stats->protocolErrors++;
+            }
+            offset += 2 + length;
+        }
+        memmove(bot->in, bot->in + offset, bot->inUsed - offset);
+        bot->inUsed -= offset;
+    }
+}
+
+static void runServerThread(GameServer* server) {
+    runGameServer(server);
+}
+
+int main(int argc, char* argv[]) {
+    int clientCount = 100;
+    long long targetTicks = 200;
+    int tickMs = 50;
+    double maxLatencyMs = 0.0;
+    int spawnServer = 0;
+    int viewRadius = SERVER_VIEW_RADIUS;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            botPort = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc) {
+            clientCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            targetTicks = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc) {
+            tickMs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--max-latency-ms") == 0 && i + 1 < argc) {
+            maxLatencyMs = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--spawn-server") == 0) {
+            spawnServer = 1;
+        }
+        else if (strcmp(argv[i], "--view-radius") == 0 && i + 1 < argc) {
+            viewRadius = atoi(argv[++i]);
+        }
+    }
+    if (clientCount < 1) clientCount = 1;
+
+    GameServer* server = NULL;
+    std::thread serverThread;
+    if (spawnServer) {
+        srand(1);
+        initStringTable();
+        ServerConfig config = { 0, tickMs, MAX_PLAYERS, 0, viewRadius };
+        server = createGameServer(&config);
+        if (!server) {
+            fprintf(stderr, "Nie mozna uruchomic serwera!\n");
+            return 1;
+        }
+        botPort = gameServerPort(server);
+        serverThread = std::thread(runServerThread, server);
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    Bot* bots = (Bot*)calloc(clientCount, sizeof(Bot));
+    BotStats* stats = (BotStats*)calloc(1, sizeof(BotStats));
+    int status = 0;
+    for (int i = 0; i < clientCount; i++) {
+        bots[i].random = 2463534242u + i * 7919u;
+        if (!connectBot(&bots[i], i)) {
+            fprintf(stderr, "Bot %d nie moze polaczyc sie z portem %d!\n", i, botPort);
+            status = 1;
+            break;
+        }
+    }
+
+    // Limit czasu z zapasem - serwer nie nadazajacy z tickami to blad testu
+    double start = nowSeconds();
+    double deadline = start + targetTicks * tickMs / 1000.0 * 3.0 + 10.0;
+    struct epoll_event events[256];
+    while (status == 0) {
+        long long slowest = targetTicks;
+        for (int i = 0; i < clientCount; i++) {
+            if (bots[i].ticks < slowest) slowest = bots[i].ticks;
+        }
+        if (slowest >= targetTicks) break;
+        if (nowSeconds() > deadline) {
+            fprintf(stderr, "Przekroczony czas - najwolniejszy bot dostal %lld z %lld tickow\n", slowest, targetTicks);
+            status = 1;
+            break;
+        }
+
+        int count = epoll_wait(epollFd, events, 256, 100);
+        for (int i = 0; i < count; i++) {
+            int index = (int)events[i].data.u32;
+            Bot* bot = &bots[index];
+            if (bot->fd < 0) continue;
+            if (!readBot(bot, stats)) {
+                closeBot(bot);
+                if (!bot->died) stats->disconnects++;
+                if (!connectBot(bot, index)) {
+                    fprintf(stderr, "Bot %d nie moze polaczyc sie ponownie!\n", index);
+                    status = 1;
+                }
+            }
+        }
+    }
+    double elapsed = nowSeconds() - start;
+
+    for (int i = 0; i < clientCount; i++) {
+        closeBot(&bots[i]);
+    }
+    if (server) {
+        stopGameServer(server);
+        serverThread.join();
+    }
+
+    const LatencyHistogram* latency = &stats->latency;
+    double p50 = latencyPercentile(latency, 0.50) * 1000.0;
+    double p99 = latencyPercentile(latency, 0.99) * 1000.0;
+    fprintf(stderr, "%d botow, %.2f s: %lld potwierdzen, %lld rekordow, %lld smierci, %lld rozlaczen, %lld bledow protokolu\n",
+        clientCount, elapsed, latency->samples, stats->records, stats->deaths, stats->disconnects, stats->protocolErrors);
+    fprintf(stderr, "Opoznienie polecenia: p50 %.2f ms, p99 %.2f ms, max %.2f ms\n", p50, p99, latency->max * 1000.0);
+    if (server) {
+        ServerStats serverStats = gameServerStats(server);
+        fprintf(stderr, "Serwer: %lld tickow, czas ticku srednio %.3f ms, max %.3f ms, szczyt klientow %d\n",
+            serverStats.ticks, serverStats.ticks ? serverStats.totalTickSeconds * 1000.0 / serverStats.ticks : 0.0,
+            serverStats.maxTickSeconds * 1000.0, serverStats.peakClients);
+        freeGameServer(server);
+    }
+
+    if (stats->protocolErrors > 0 || stats->disconnects > 0 || latency->samples == 0) {
+        status = 1;
+    }
+    if (maxLatencyMs > 0.0 && p99 > maxLatencyMs) {
+        fprintf(stderr, "p99 opoznienia %.2f ms przekracza limit %.2f ms\n", p99, maxLatencyMs);
+        status = 1;
+    }
+    free(bots);
+    free(stats);
+    close(epollFd);
+    return status;
+}
@@ -0,0 +1,239 @@
+﻿#include <atomic>
+#include "graRPG10.h"
+
+// Bufor cykliczny jeden-producent/jeden-konsument. Logika gry tylko dopisuje
+// zdarzenia; gdy bufor jest pelny, nowe zdarzenie jest odrzucane i liczone,
+// wiec symulacja nigdy nie czeka na konsumenta.
+struct EventQueue {
+    GameEvent events[EVENT_QUEUE_SIZE];
+    std::atomic<unsigned int> head;  // Nastepne zdarzenie do odczytu
+    std::atomic<unsigned int> tail;  // Nastepne wolne miejsce
+    unsigned int dropped;
+};
+
+EventQueue* createEventQueue() {
+    EventQueue* queue = (EventQueue*)trackedCalloc(1, sizeof(EventQueue), ALLOC_EVENTS);
+    if (!queue) {
+        printf("Blad alokacji pamieci dla kolejki zdarzen\n");
+        exit(1);
+    }
+    return queue;
+}
+
+void freeEventQueue(EventQueue* queue) {
+    trackedFree(queue);
+}
+
+void emitEventAt(GameWorld* world, GameEventType type, StringId name, int value, int flags, int x, int y) {
+    EventQueue* queue = world->events;
+    if (!queue) return;
+
+    unsigned int tail = queue->tail.load(std::memory_order_relaxed);
+    unsigned int head = queue->head.load(std::memory_order_acquire);
+    if (tail - head >= EVENT_QUEUE_SIZE) {
+        queue->dropped++;
+        return;
+    }
+
+    GameEvent* event = &queue->events[tail & (EVENT_QUEUE_SIZE - 1)];
+    event->type = type;
+    event->turn = world->turn;
+    event->value = value;
+    event->x = x;
+    event->y = y;
+    event->name = name;
+    event->flags = flags;
+    queue->tail.store(tail + 1, std::memory_order_release);
+}
+
+void emitEvent(GameWorld* world, GameEventType type, StringId name, int value, int flags) {
+    emitEventAt(world, type, name, value, flags, world->player->posX, world->player->posY);
+}
+
+int pollEvent(EventQueue* queue, GameEvent* out) {
+    unsigned int head = queue->head.load(std::memory_order_relaxed);
+    unsigned int tail = queue->tail.load(std::memory_order_acquire);
+    if (head == tail) return 0;
+
+    *out = queue->events[head & (EVENT_QUEUE_SIZE - 1)];
+    queue->head.store(head + 1, std::memory_order_release);
+    return 1;
+}
+
+int drainEvents(EventQueue* queue, const EventSubscriber* subscribers, int subscriberCount) {
+    if (!queue) return 0;
+
+    GameEvent event;
+    int count = 0;
+    while (pollEvent(queue, &event)) {
+        for (int i = 0; i < subscriberCount; i++) {
+            subscribers[i].handle(&event, subscribers[i].context);
+        }
+        count++;
+    }
+    return count;
+}
+
+unsigned int droppedEventCount(const EventQueue* queue) {
+    return queue ? queue->dropped : 0;
+}
+
+const char* eventTypeName(GameEventType type) {
+    static const char* names[EVENT_TYPE_COUNT] = {
+        "encounter",
+        "damage_dealt",
+        "flee_attempt",
+        "enemy_defeated",
+        "item_dropped",
+        "item_picked_up",
+        "inventory_full",
+        "nothing_to_pick_up",
+        "trap_triggered",
+        "portal_opened",
+        "level_changed",
+        "player_died",
+        "game_won",
+        "game_saved",
+        "status_applied",
+        "status_tick",
+        "status_expired"
+    };
+    return (type >= 0 && type < EVENT_TYPE_COUNT) ? names[type] : "unknown";
+}
+
+// Tekst zdarzenia w konsoli - te same komunikaty, ktore wczesniej wypisywala logika gry
+int formatEvent(const GameEvent* event, char* buffer, int size) {
+    const char* name = getString(event->name);
+
+    switch (event->type) {
+    case EVENT_ENCOUNTER:
+        return snprintf(buffer, size, "Znalazles przeciwnika: %s!", name);
+    case EVENT_DAMAGE_DEALT:
+        if (event->flags & EVENT_FLAG_TO_PLAYER) {
+            return snprintf(buffer, size, "%s zadaje %d obrazen!", name, event->value);
+        }
+        return snprintf(buffer, size, "%s\nZadales %d obrazen!",
+            (event->flags & EVENT_FLAG_CRITICAL) ? "Wykonujesz atak krytyczny!" : "Wykonujesz atak normalny.",
+            event->value);
+    case EVENT_FLEE_ATTEMPT:
+        return snprintf(buffer, size, (event->flags & EVENT_FLAG_SUCCESS) ? "Udalo ci sie uciec!" : "Nie udalo ci sie uciec!");
+    case EVENT_ENEMY_DEFEATED:
+        return snprintf(buffer, size, "Pokonales %s!\nZdobywasz %d zlota.", name, event->value);
+    case EVENT_ITEM_DROPPED:
+        if (event->flags & EVENT_FLAG_NO_ITEM) {
+            return snprintf(buffer, size, "Przeciwnik nie upuscil zadnych przedmiotow.");
+        }
+        if (event->flags & EVENT_FLAG_IN_INVENTORY) {
+            return snprintf(buffer, size, "Przeciwnik upuscil %s!\nZdobyto %s!", name, name);
+        }
+        if (event->flags & EVENT_FLAG_ON_GROUND) {
+            return snprintf(buffer, size, "Przeciwnik upuscil %s!\nPolozono %s na ziemi (brak miejsca w ekwipunku).", name, name);
+        }
+        return snprintf(buffer, size, "Przeciwnik upuscil %s, ale przedmiot przepadl!", name);
+    case EVENT_ITEM_PICKED_UP:
+        return snprintf(buffer, size, "Podniesiono %s!", name);
+    case EVENT_INVENTORY_FULL:
+        return snprintf(buffer, size, "Nie masz miejsca w ekwipunku na %s!", name);
+    case EVENT_NOTHING_TO_PICK_UP:
+        return snprintf(buffer, size, "Nie ma przedmiotu do podniesienia!");
+    case EVENT_TRAP_TRIGGERED:
+        return snprintf(buffer, size, "Odkryles pulapke: %s!\nZostales ranny! Straciles %d HP.", name, event->value);
+    case EVENT_PORTAL_OPENED:
+        return snprintf(buffer, size, "Pojawil sie magiczny portal prowadzacy do nastepnego poziomu!");
+    case EVENT_LEVEL_CHANGED:
+        return snprintf(buffer, size, "Witaj na poziomie %d! Przeciwnicy sa silniejsi!", event->value);
+    case EVENT_PLAYER_DIED:
+        return snprintf(buffer, size, (event->flags & EVENT_FLAG_BY_TRAP) ?
+            "Zostales zabity przez pulapke!\nKoniec gry." : "Zostales pokonany!\nKoniec gry.");
+    case EVENT_GAME_WON:
+        return snprintf(buffer, size, "Gratulacje! Ukonczyles wszystkie %d poziomy gry!", event->value);
+    case EVENT_GAME_SAVED:
+        return snprintf(buffer, size, (event->flags & EVENT_FLAG_SUCCESS) ? "Gra zapisana." : "Nie udalo sie zapisac gry!");
+    case EVENT_STATUS_APPLIED:
+        return snprintf(buffer, size, "Dziala na ciebie: %s (%d tur).", name, event->value);
+    case EVENT_STATUS_TICK:
+        if (event->value >= 0) {
+            return snprintf(buffer, size, "%s: odzyskujesz %d HP.", name, event->value);
+        }
+        return snprintf(buffer, size, "%s: tracisz %d HP.", name, -event->value);
+    case EVENT_STATUS_EXPIRED:
+        return snprintf(buffer, size, "%s przestaje dzialac.", name);
+    default:
+        break;
+    }
+    buffer[0] = '\0';
+    return 0;
+}
+
+// Renderer konsolowy - wypisuje komunikat i daje graczowi czas na jego przeczytanie
+void renderEventToConsole(const GameEvent* event, void* context) {
+    (void)context;
+    char text[256];
+    formatEvent(event, text, sizeof(text));
+    printf("%s\n", text);
+
+    switch (event->type) {
+    case EVENT_TRAP_TRIGGERED:
+    case EVENT_ITEM_DROPPED:
+    case EVENT_PORTAL_OPENED:
+    case EVENT_LEVEL_CHANGED:
+        Sleep(2000);
+        break;
+    case EVENT_GAME_WON:
+        Sleep(3000);
+        break;
+    case EVENT_ITEM_PICKED_UP:
+    case EVENT_INVENTORY_FULL:
+    case EVENT_NOTHING_TO_PICK_UP:
+        Sleep(1000);
+        break;
+    default:
+        break;
+    }
+}
+
+// Log zdarzen jako CSV: tura,typ,nazwa,wartosc,x,y,flagi
+void logEventToFile(const GameEvent* event, void* context) {
+    FILE* file = (FILE*)context;
+    fprintf(file, "%d,%s,%s,%d,%d,%d,%d\n", event->turn, eventTypeName(event->type),
+        getString(event->name), event->value, event->x, event->y, event->flags);
+}
+
+void collectEventStats(const GameEvent* event, void* context) {
+    EventStats* stats = (EventStats*)context;
+    stats->counts[event->type]++;
+
+    switch (event->type) {
+    case EVENT_DAMAGE_DEALT:
+        if (event->flags & EVENT_FLAG_TO_PLAYER) {
+            stats->damageTaken += event->value;
+        }
+        else {
+            stats->damageDealt += event->value;
+            if (event->flags & EVENT_FLAG_CRITICAL) stats->criticalHits++;
+        }
+        break;
+    case EVENT_TRAP_TRIGGERED:
+        stats->damageTaken += event->value;
+        break;
+    case EVENT_STATUS_TICK:
+        if (event->value < 0) stats->damageTaken -= event->value;
+        break;
+    case EVENT_ENEMY_DEFEATED:
+        stats->goldEarned += event->value;
+        break;
+    default:
+        break;
+    }
+}
+
+void printEventStats(const EventStats* stats) {
+    printf("==== STATYSTYKI SESJI ====\n");
+    printf("Pokonani przeciwnicy: %d | Zdobyte zloto: %d\n",
+        stats->counts[EVENT_ENEMY_DEFEATED], stats->goldEarned);
+    printf("Zadane obrazenia: %d (trafienia krytyczne: %d) | Otrzymane obrazenia: %d\n",
+        stats->damageDealt, stats->criticalHits, stats->damageTaken);
+    printf("Uruchomione pulapki: %d | Podniesione przedmioty: %d | Zmiany poziomu: %d\n",
+        stats->counts[EVENT_TRAP_TRIGGERED], stats->counts[EVENT_ITEM_PICKED_UP],
+        stats->counts[EVENT_LEVEL_CHANGED]);
+}
@@ -0,0 +1,150 @@
+﻿#include "graRPG10.h"
+
+// Test budowy z pulami stalymi: kilka swiatow gra na zmiane, a po kazdej
+// zakonczonej grze swiat jest zwalniany i tworzony od nowa. Funkcje sterty
+// sa tu podmienione na liczace wywolania - w trakcie gry nie moze byc ani
+// jednego, a wszystkie alokacje gry musza przejsc przez pule.
+
+#ifndef GRA_FIXED_POOLS
+#error "fixed_alloc_test wymaga kompilacji z GRA_FIXED_POOLS"
+#endif
+
+#define FIXED_TEST_WORLDS 8
+#define FIXED_TEST_TURNS 50000
+
+// Podmiana malloc/calloc/realloc/free calego programu (glibc) - licza tez
+// wywolania z biblioteki standardowej, np. operator new
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+static volatile long long heapCalls = 0;
+
+void* malloc(size_t size) {
+    heapCalls++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    heapCalls++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    heapCalls++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr) heapCalls++;
+    __libc_free(ptr);
+}
+}
+
+static BattleAction fixedBattleAction(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)enemy;
+    (void)round;
+    (void)context;
+    return world->player->health < world->player->max_health / 4 ? BATTLE_FLEE : BATTLE_ATTACK;
+}
+
+// Leczenie, podnoszenie, portal, poza tym losowy ruch - jak w tescie dlugiej sesji
+static char chooseFixedMove(GameWorld* world) {
+    Player* player = world->player;
+    Inventory* inv = player->inventory;
+    if (player->health < player->max_health / 2) {
+        for (int y = 0; y < inv->height; y++) {
+            for (int x = 0; x < inv->width; x++) {
+                Item* item = inv->items[y][x];
+                if (item && item->category == ITEM_POTION) {
+                    useItem(world, player, item);
+                    y = inv->height;
+                    break;
+                }
+            }
+        }
+    }
+    if (groundItemAt(world, player->posX, player->posY) >= 0) {
+        return 'p';
+    }
+    if (world->portalActive && randomInt(&world->random, 4) != 0) {
+        if (world->portalX > player->posX) return 'd';
+        if (world->portalX < player->posX) return 'a';
+        if (world->portalY > player->posY) return 's';
+        return 'w';
+    }
+    static const char moves[] = { 'w', 'a', 's', 'd' };
+    return moves[randomInt(&world->random, 4)];
+}
+
+int main() {
+    initStringTable();
+
+    EventStats stats;
+    memset(&stats, 0, sizeof(EventStats));
+    EventSubscriber subscribers[1] = { { collectEventStats, &stats } };
+
+    // Rozruch: pierwszy printf przydziela bufor stdout
+    printf("Pule stale: arena %lld B\n", fixedPoolStats().arenaBytes);
+    fflush(stdout);
+
+    unsigned long long seed = 20240501;
+    GameWorld* worlds[FIXED_TEST_WORLDS];
+    for (int i = 0; i < FIXED_TEST_WORLDS; i++) {
+        worlds[i] = createSeededGameWorld("Pule", seed++);
+    }
+
+    long long startCalls = heapCalls;
+    FixedPoolStats before = fixedPoolStats();
+    int games = FIXED_TEST_WORLDS;
+    double startTime = nowSeconds();
+    for (int turn = 0; turn < FIXED_TEST_TURNS; turn++) {
+        GameWorld** world = &worlds[turn % FIXED_TEST_WORLDS];
+        stepWorld(*world, chooseFixedMove(*world), fixedBattleAction, NULL);
+        drainEvents((*world)->events, subscribers, 1);
+        if ((*world)->status != GAME_RUNNING) {
+            freeGameWorld(*world);
+            *world = createSeededGameWorld("Pule", seed++);
+            games++;
+        }
+    }
+    double seconds = nowSeconds() - startTime;
+    long long playCalls = heapCalls - startCalls;
+    FixedPoolStats after = fixedPoolStats();
+
+    for (int i = 0; i < FIXED_TEST_WORLDS; i++) {
+        freeGameWorld(worlds[i]);
+    }
+
+    int ok = 1;
+    printf("Tury: %d | gry: %d | poziomy: %d | pokonani: %d | %.0f tur/s\n", FIXED_TEST_TURNS, games,
+        stats.counts[EVENT_LEVEL_CHANGED], stats.counts[EVENT_ENEMY_DEFEATED], FIXED_TEST_TURNS / seconds);
+    printf("Alokacje z pul w trakcie gry: %lld | wywolania sterty: %lld\n", after.poolAllocs - before.poolAllocs,
+        playCalls);
+    if (playCalls != 0) {
+        fprintf(stderr, "BLAD: %lld wywolan sterty w trakcie gry\n", playCalls);
+        ok = 0;
+    }
+    if (after.poolAllocs == before.poolAllocs) {
+        fprintf(stderr, "BLAD: gra nie alokowala z pul - test niczego nie sprawdza\n");
+        ok = 0;
+    }
+    if (after.failedAllocs != 0) {
+        fprintf(stderr, "BLAD: arena za mala (%lld nieudanych alokacji)\n", after.failedAllocs);
+        ok = 0;
+    }
+    for (int tag = 0; tag < ALLOC_TAG_COUNT; tag++) {
+        AllocTagStats tagStats = memtrackTagStats((AllocTag)tag);
+        if (tagStats.liveBlocks != 0) {
+            fprintf(stderr, "BLAD: po zwolnieniu swiatow zostalo %lld blokow w podsystemie %d\n",
+                tagStats.liveBlocks, tag);
+            ok = 0;
+        }
+    }
+
+    printMemtrackReport(stdout);
+    printf(ok ? "OK\n" : "BLAD\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+﻿#include "graRPG10.h"
+
+#ifdef GRA_FIXED_POOLS
+
+#include <mutex>
+
+// Pule stale: wszystkie obiekty gry (swiat, gracz, ekwipunek, mapa,
+// przeciwnicy, pulapki, przedmioty, zdarzenia) pochodza ze statycznej areny
+// o rozmiarze wyliczonym z MAP_WIDTH, MAX_ENEMIES, MAX_TRAPS, INVENTORY_WIDTH
+// i MAX_GROUND_ITEMS. Bloki sa w klasach rozmiaru bedacych potegami dwojki;
+// zwolniony blok wraca na liste wolnych swojej klasy i jest uzywany ponownie,
+// a arena jest tylko krojona. Po rozruchu ani w trakcie gry nie ma malloc,
+// a koszt alokacji to zdjecie bloku z listy.
+
+// Swiaty zywe naraz - razem z klonami i swiatami wczytanymi z zapisu
+#ifndef GRA_FIXED_WORLDS
+#define GRA_FIXED_WORLDS 16
+#endif
+
+#define FIXED_MIN_CLASS_BITS 5  // Najmniejszy blok: 32 B z naglowkiem
+#define FIXED_CLASS_COUNT 26    // Najwiekszy blok: 1 GB
+
+// Poziomy 2 i 3 dodaja level / 2 przeciwnikow i pulapek
+#define FIXED_LEVEL_ENEMIES (MAX_ENEMIES + 2)
+#define FIXED_LEVEL_TRAPS (MAX_TRAPS + 2)
+#define FIXED_WORLD_ITEMS (INVENTORY_WIDTH * INVENTORY_HEIGHT + 2 * MAX_GROUND_ITEMS)
+
+// Naglowek bloku - klasa i podsystem dla trackedFree. W wolnym bloku
+// poczatek danych to wskaznik na nastepny wolny blok klasy.
+struct alignas(16) PoolHeader {
+    unsigned int size;           // Zadany rozmiar (statystyki podsystemow)
+    unsigned short sizeClass;
+    unsigned short tag;
+};
+
+// Zawartosc jednego swiata; przy nextLevel stary i nowy poziom istnieja naraz.
+// Indeks kategorii ekwipunku po podwojeniu to do dwoch wskaznikow na pole.
+#define FIXED_WORLD_CONTENT_BYTES (sizeof(GameWorld) + sizeof(Player) + sizeof(Inventory) + \
+    INVENTORY_HEIGHT * (2 * sizeof(void*) + sizeof(unsigned int) + INVENTORY_WIDTH * (sizeof(int) + 3 * sizeof(Item*))) + \
+    EVENT_QUEUE_SIZE * sizeof(GameEvent) + \
+    (size_t)MAP_HEIGHT * (sizeof(char*) + MAP_WIDTH) + \
+    (size_t)MAP_HEIGHT * MAP_WIDTH * (INFLUENCE_FIELD_COUNT + 2) * sizeof(int) + \
+    2 * FIXED_LEVEL_ENEMIES * (sizeof(Enemy) + sizeof(Enemy*) + sizeof(EnemyTurn) + sizeof(StatusEffect) + sizeof(int)) + \
+    2 * FIXED_LEVEL_TRAPS * (sizeof(Trap) + sizeof(Trap*)) + \
+    FIXED_WORLD_ITEMS * sizeof(Item) + MAX_GROUND_ITEMS * sizeof(Item*))
+
+#define FIXED_WORLD_BLOCKS (2 * (MAP_HEIGHT + 2 * INVENTORY_HEIGHT + FIXED_LEVEL_ENEMIES + FIXED_LEVEL_TRAPS) + \
+    ITEM_CATEGORY_COUNT + 2 + \
+    FIXED_WORLD_ITEMS + 32)
+
+// Zaokraglenie do potegi dwojki z naglowkiem co najwyzej podwaja blok
+// (2 * rozmiar + 2 * naglowek); drugie tyle na zapis albo klon swiata
+#ifndef GRA_FIXED_POOL_BYTES
+#define GRA_FIXED_POOL_BYTES ((size_t)GRA_FIXED_WORLDS * \
+    (4 * FIXED_WORLD_CONTENT_BYTES + 4 * FIXED_WORLD_BLOCKS * sizeof(PoolHeader)))
+#endif
+
+static const char* tagNames[ALLOC_TAG_COUNT] = {
+    "przedmioty",
+    "przeciwnicy",
+    "pulapki",
+    "mapa",
+    "ekwipunek",
+    "gracz",
+    "swiat",
+    "zdarzenia",
+    "zapis"
+};
+
+alignas(16) static unsigned char arena[GRA_FIXED_POOL_BYTES];
+
+static std::mutex poolMutex;
+static size_t carved = 0;
+static PoolHeader* freeLists[FIXED_CLASS_COUNT];
+static long long classBlocks[FIXED_CLASS_COUNT];  // Bloki wykrojone dla klasy
+static AllocTagStats tagStats[ALLOC_TAG_COUNT];
+static long long liveBytes = 0;
+static long long peakBytes = 0;
+static long long poolAllocs = 0;
+static long long failedAllocs = 0;
+
+static size_t classBytes(int sizeClass) {
+    return (size_t)1 << (sizeClass + FIXED_MIN_CLASS_BITS);
+}
+
+static PoolHeader** nextFree(PoolHeader* header) {
+    return (PoolHeader**)(header + 1);
+}
+
+void* trackedMalloc(size_t size, AllocTag tag) {
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    size_t needed = size + sizeof(PoolHeader);
+    int sizeClass = 0;
+    while (sizeClass < FIXED_CLASS_COUNT && classBytes(sizeClass) < needed) sizeClass++;
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    PoolHeader* header = NULL;
+    if (sizeClass < FIXED_CLASS_COUNT) {
+        header = freeLists[sizeClass];
+        if (header) {
+            freeLists[sizeClass] = *nextFree(header);
+        }
+        else if (classBytes(sizeClass) <= sizeof(arena) - carved) {
+            header = (PoolHeader*)(arena + carved);
+            carved += classBytes(sizeClass);
+            classBlocks[sizeClass]++;
+        }
+    }
+    if (!header) {
+        failedAllocs++;
+        return NULL;
+    }
+
+    header->size = (unsigned int)size;
+    header->sizeClass = (unsigned short)sizeClass;
+    header->tag = (unsigned short)tag;
+
+    AllocTagStats* stats = &tagStats[tag];
+    stats->liveBytes += size;
+    stats->liveBlocks++;
+    stats->totalAllocs++;
+    if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+    liveBytes += size;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+    poolAllocs++;
+    return header + 1;
+}
+
+// Blok z listy wolnych ma dane poprzedniego wlasciciela
+void* trackedCalloc(size_t count, size_t size, AllocTag tag) {
+    void* ptr = trackedMalloc(count * size, tag);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void trackedFree(void* ptr) {
+    if (!ptr) return;
+
+    PoolHeader* header = (PoolHeader*)ptr - 1;
+    std::lock_guard<std::mutex> lock(poolMutex);
+    AllocTagStats* stats = &tagStats[header->tag];
+    stats->liveBytes -= header->size;
+    stats->liveBlocks--;
+    liveBytes -= header->size;
+
+    *nextFree(header) = freeLists[header->sizeClass];
+    freeLists[header->sizeClass] = header;
+}
+
+FixedPoolStats fixedPoolStats() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    FixedPoolStats stats;
+    stats.arenaBytes = (long long)sizeof(arena);
+    stats.carvedBytes = (long long)carved;
+    stats.poolAllocs = poolAllocs;
+    stats.failedAllocs = failedAllocs;
+    return stats;
+}
+
+AllocTagStats memtrackTagStats(AllocTag tag) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return tagStats[tag];
+}
+
+long long memtrackLiveBytes() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return liveBytes;
+}
+
+long long memtrackPeakBytes() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return peakBytes;
+}
+
+void printMemtrackReport(FILE* out) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+
+    fprintf(out, "==== PULE STALE (arena %lld B, wykrojono %lld B, nieudane alokacje %lld) ====\n",
+        (long long)sizeof(arena), (long long)carved, failedAllocs);
+    fprintf(out, "%-12s %12s %12s %10s %12s\n", "podsystem", "zywe B", "szczyt B", "bloki", "alokacje");
+    for (int i = 0; i < ALLOC_TAG_COUNT; i++) {
+        fprintf(out, "%-12s %12lld %12lld %10lld %12lld\n", tagNames[i], tagStats[i].liveBytes,
+            tagStats[i].peakBytes, tagStats[i].liveBlocks, tagStats[i].totalAllocs);
+    }
+    fprintf(out, "%-12s %12s\n", "klasa B", "wykrojone");
+    for (int i = 0; i < FIXED_CLASS_COUNT; i++) {
+        if (classBlocks[i] == 0) continue;
+        fprintf(out, "%-12lld %12lld\n", (long long)classBytes(i), classBlocks[i]);
+    }
+}
+
+#endif
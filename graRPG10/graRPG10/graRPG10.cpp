@@ -1,137 +1,87 @@
-﻿#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-#include <math.h>
-#include <windows.h>
-
-#define MAP_HEIGHT 12
-#define MAP_WIDTH 10
-#define MAX_ENEMIES 5
-#define MAX_TRAPS 12
-#define INVENTORY_WIDTH 10
-#define INVENTORY_HEIGHT 10
-#define MAX_GROUND_ITEMS 10
-
-typedef int (*AttackFunction)(int attack, int defense);
-
-typedef struct {
-    char name[50];
-    int width;
-    int height;
-    char symbol;
-    int isEquipped;
-    int posX;
-    int posY;
-    int attackBonus;
-    int defenseBonus;
-    int healthBonus;
-    int itemX;
-    int itemY;
-} Item;
-
-typedef struct {
-    int width;
-    int height;
-    int** slots;  // Macierz slotow (0 - wolny, 1 - zajety)
-    Item*** items;
-} Inventory;
-
-typedef struct {
-    char name[50];
-    int health;
-    int max_health;
-    int attack;
-    int defense;
-    int posX;
-    int posY;
-    int gold;
-    Inventory* inventory;
-} Player;
-
-typedef struct {
-    char name[50];
-    int health;
-    int attack;
-    int defense;
-    int EposX;
-    int EposY;
-} Enemy;
-
-typedef struct {
-    int posX;
-    int posY;
-    int damage;
-    int discovered;
-    char description[100];
-} Trap;
-
-typedef struct {
-    Player* player;
-    Enemy** enemies;
-    int enemyCount;
-    Trap** traps;
-    int trapCount;
-    char** map;
-    int enemiesDefeated;
-    int level;
-    int portalX;
-    int portalY;
-    int portalActive;
-    int totalEnemiesDefeated;
-    Item** groundItems;
-    int groundItemCount;
-} GameWorld;
-
-// Prototypy funkcji
-int isHere(GameWorld* world, int x, int y, int currentEnemies, int currentTraps);
-Player* createPlayer();
-void initPlayer(Player* player);
-Enemy* createEnemy(int x, int y);
-void initEnemy(Enemy* enemy, int x, int y);
-Trap* createTrap(int x, int y);
-void initTrap(Trap* trap, int x, int y);
-void checkTraps(GameWorld* world);
-GameWorld* createGameWorld();
-int battle(Player* player, Enemy* enemy, GameWorld* world);
-void printMap(GameWorld* world);
-void moveEnemy(Enemy* enemy);
-void movePlayerAndEnemy(GameWorld* world);
-void freeGameWorld(GameWorld* world);
-void initMap(GameWorld* world);
-void reloadMap(GameWorld* world);
-void nextLevel(GameWorld* world);
-void activatePortal(GameWorld* world);
-void addItemToGround(GameWorld* world, Item* item, int x, int y);
-void removeItemFromGround(GameWorld* world, int index);
-int normalAttack(int attack, int defense);
-int criticalAttack(int attack, int defense);
-
-// Funkcje ekwipunku
-Inventory* createInventory(int width, int height);
-void freeInventory(Inventory* inv);
-int canPlaceItem(Inventory* inv, Item* item, int x, int y);
-int addItemToInventory(Inventory* inv, Item* item, int x, int y);
-void removeItemFromInventory(Inventory* inv, Item* item);
-void printInventory(Inventory* inv);
-void inventoryMenu(GameWorld* world);
-Item* createHealthPotion();
-Item* createSword();
-Item* createArmor();
-void useItem(Player* player, Item* item);
-
-void saveGame(GameWorld* world);
-GameWorld* loadGame();
+﻿#include "graRPG10.h"
+#include "inventory_shapes.h"
+
+static StringTable stringTable;
+
+static const char* builtinStrings[STR_BUILTIN_COUNT] = {
+    "Potion of Health",
+    "Long Sword",
+    "Plate Armor",
+    "Goblin",
+    "Ork",
+    "Kolce",
+    "Spadajace glazy",
+    "Mikstura sily",
+    "Mikstura regeneracji",
+    "Trucizna",
+    "Krwawienie",
+    "Regeneracja",
+    "Sila"
+};
+
+static unsigned int hashString(const char* str) {
+    // FNV-1a
+    unsigned int h = 2166136261u;
+    while (*str) {
+        h ^= (unsigned char)*str++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void initStringTable() {
+    memset(&stringTable, 0, sizeof(StringTable));
+    for (int i = 0; i < STR_BUILTIN_COUNT; i++) {
+        internString(builtinStrings[i]);
+    }
+}
+
+StringId internString(const char* str) {
+    unsigned int slot = hashString(str) & (STRING_HASH_SIZE - 1);
+
+    // Sondowanie liniowe - ten sam napis zawsze dostaje ten sam identyfikator
+    while (stringTable.hash[slot] != 0) {
+        int index = stringTable.hash[slot] - 1;
+        if (strcmp(stringTable.pool + stringTable.offsets[index], str) == 0) {
+            return (StringId)index;
+        }
+        slot = (slot + 1) & (STRING_HASH_SIZE - 1);
+    }
+
+    int length = (int)strlen(str) + 1;
+    if (stringTable.count >= MAX_INTERNED_STRINGS || stringTable.poolUsed + length > STRING_POOL_SIZE) {
+        printf("Tablica napisow jest pelna!\n");
+        exit(1);
+    }
+
+    int index = stringTable.count++;
+    stringTable.offsets[index] = stringTable.poolUsed;
+    memcpy(stringTable.pool + stringTable.poolUsed, str, length);
+    stringTable.poolUsed += length;
+    stringTable.hash[slot] = index + 1;
+
+    return (StringId)index;
+}
+
+const char* getString(StringId id) {
+    if (id == STRING_NONE) {
+        return "";
+    }
+    if (id >= (StringId)stringTable.count) {
+        return "???";
+    }
+    return stringTable.pool + stringTable.offsets[id];
+}
 
 Inventory* createInventory(int width, int height) {
-    Inventory* inv = (Inventory*)malloc(sizeof(Inventory));
+    Inventory* inv = (Inventory*)trackedMalloc(sizeof(Inventory), ALLOC_INVENTORY);
     inv->width = width;
     inv->height = height;
 
     // Alokacja macierzy slotów
-    inv->slots = (int**)malloc(height * sizeof(int*));
+    inv->slots = (int**)trackedMalloc(height * sizeof(int*), ALLOC_INVENTORY);
     for (int i = 0; i < height; i++) {
-        inv->slots[i] = (int*)malloc(width * sizeof(int));
+        inv->slots[i] = (int*)trackedMalloc(width * sizeof(int), ALLOC_INVENTORY);
         // Inicjalizacja slotów jako wolne
         for (int j = 0; j < width; j++) {
             inv->slots[i][j] = 0;
@@ -139,15 +89,24 @@ Inventory* createInventory(int width, int height) {
     }
 
     // Alokacja tablicy wskaźników na przedmioty
-    inv->items = (Item***)malloc(height * sizeof(Item**));
+    inv->items = (Item***)trackedMalloc(height * sizeof(Item**), ALLOC_INVENTORY);
     for (int i = 0; i < height; i++) {
-        inv->items[i] = (Item**)malloc(width * sizeof(Item*));
+        inv->items[i] = (Item**)trackedMalloc(width * sizeof(Item*), ALLOC_INVENTORY);
         // Inicjalizacja wskaźników na NULL
         for (int j = 0; j < width; j++) {
             inv->items[i][j] = NULL;
         }
     }
 
+    // Maski zajetosci wierszy - tylko gdy wiersz miesci sie w 32 bitach
+    inv->rowMask = NULL;
+    if (width <= 32) {
+        inv->rowMask = (unsigned int*)trackedCalloc(height, sizeof(unsigned int), ALLOC_INVENTORY);
+    }
+    inv->clone.start = NULL;
+    inv->clone.size = 0;
+    memset(inv->index, 0, sizeof(inv->index));
+
     return inv;
 }
 
@@ -156,33 +115,38 @@ void freeInventory(Inventory* inv) {
 
     for (int y = 0; y < inv->height; y++) {
         for (int x = 0; x < inv->width; x++) {
+            // Zdjecie przedmiotu czysci wszystkie jego pola, wiec pozostale
+            // pola tego przedmiotu nie odwoluja sie juz do zwolnionej pamieci
             Item* item = inv->items[y][x];
-            
-            if (item != NULL && item->posX == x && item->posY == y) {
-                free(item);
+            if (item != NULL) {
+                detachItemFromInventory(inv, item);
+                freeWorldObject(&inv->clone, item);
             }
-            inv->items[y][x] = NULL; 
         }
     }
 
+    // Indeks moze urosnac poza blokiem klonu
+    freeInventoryIndex(inv);
+
+    // Ekwipunek klonu lezy w bloku swiata razem z wierszami
+    if (inv->clone.start) return;
     for (int i = 0; i < inv->height; i++) {
-        free(inv->slots[i]);
-        free(inv->items[i]);
+        trackedFree(inv->slots[i]);
+        trackedFree(inv->items[i]);
     }
-    free(inv->slots);
-    free(inv->items);
-    free(inv);
+    trackedFree(inv->slots);
+    trackedFree(inv->items);
+    trackedFree(inv->rowMask);
+    trackedFree(inv);
 }
 
-int canPlaceItem(Inventory* inv, Item* item, int x, int y) {
-    if (x < 0 || y < 0 || x >= inv->width || y >= inv->height) {
-        return 0;
-    }
-
-    if (x + item->width > inv->width || y + item->height > inv->height) {
-        return 0;
-    }
+// Ogolne rozmieszczanie dla dowolnego ksztaltu - petle po slotach
+static unsigned int genericRowMask(const Item* item, int x) {
+    unsigned int mask = (item->width >= 32) ? 0xFFFFFFFFu : ((1u << item->width) - 1u);
+    return mask << x;
+}
 
+static int canPlaceGeneric(const Inventory* inv, const Item* item, int x, int y) {
     for (int i = y; i < y + item->height; i++) {
         for (int j = x; j < x + item->width; j++) {
             if (inv->slots[i][j] != 0) {
@@ -190,68 +154,164 @@ int canPlaceItem(Inventory* inv, Item* item, int x, int y) {
             }
         }
     }
-
     return 1;
 }
 
-int addItemToInventory(Inventory* inv, Item* item, int x, int y) {
-    if (!canPlaceItem(inv, item, x, y)) {
-        return 0;
+static int findSpaceGeneric(const Inventory* inv, const Item* item, int* outX, int* outY) {
+    for (int y = 0; y + item->height <= inv->height; y++) {
+        for (int x = 0; x + item->width <= inv->width; x++) {
+            if (canPlaceGeneric(inv, item, x, y)) {
+                *outX = x;
+                *outY = y;
+                return 1;
+            }
+        }
     }
+    return 0;
+}
 
-    // Zapisz oryginalne rozmiary przedmiotu
-    int originalWidth = item->width;
-    int originalHeight = item->height;
-
-    for (int i = y; i < y + originalHeight; i++) {
-        for (int j = x; j < x + originalWidth; j++) {
+static void placeGeneric(Inventory* inv, Item* item, int x, int y) {
+    for (int i = y; i < y + item->height; i++) {
+        for (int j = x; j < x + item->width; j++) {
             inv->slots[i][j] = 1;
             inv->items[i][j] = item;
         }
+        if (inv->rowMask) {
+            inv->rowMask[i] |= genericRowMask(item, x);
+        }
+    }
+}
+
+static void clearGeneric(Inventory* inv, const Item* item, int x, int y) {
+    for (int i = y; i < y + item->height && i < inv->height; i++) {
+        for (int j = x; j < x + item->width && j < inv->width; j++) {
+            inv->slots[i][j] = 0;
+            inv->items[i][j] = NULL;
+        }
+        if (inv->rowMask) {
+            inv->rowMask[i] &= ~genericRowMask(item, x);
+        }
+    }
+}
+
+const ItemShapeOps genericShapeOps = { 0, 0, canPlaceGeneric, findSpaceGeneric, placeGeneric, clearGeneric };
+
+// Ksztalty wszystkich przedmiotow w grze
+static const ItemShapeOps shapeOps[] = {
+    ITEM_SHAPE_OPS(1, 1),  // Mikstura
+    ITEM_SHAPE_OPS(1, 3),  // Miecz
+    ITEM_SHAPE_OPS(2, 3),  // Zbroja
+};
+
+const ItemShapeOps* findShapeOps(const Inventory* inv, const Item* item) {
+    if (inv->rowMask) {
+        for (int i = 0; i < (int)(sizeof(shapeOps) / sizeof(shapeOps[0])); i++) {
+            if (shapeOps[i].width == item->width && shapeOps[i].height == item->height) {
+                return &shapeOps[i];
+            }
+        }
+    }
+    return &genericShapeOps;
+}
+
+int canPlaceItem(Inventory* inv, Item* item, int x, int y) {
+    if (x < 0 || y < 0 || x >= inv->width || y >= inv->height) {
+        return 0;
+    }
+
+    if (x + item->width > inv->width || y + item->height > inv->height) {
+        return 0;
     }
+
+    return findShapeOps(inv, item)->canPlace(inv, item, x, y);
+}
+
+int findInventorySpace(Inventory* inv, Item* item, int* outX, int* outY) {
+    return findShapeOps(inv, item)->findSpace(inv, item, outX, outY);
+}
+
+int addItemToInventory(Inventory* inv, Item* item, int x, int y) {
+    if (x < 0 || y < 0 || x + item->width > inv->width || y + item->height > inv->height) {
+        return 0;
+    }
+
+    const ItemShapeOps* ops = findShapeOps(inv, item);
+    if (!ops->canPlace(inv, item, x, y)) {
+        return 0;
+    }
+
+    ops->place(inv, item, x, y);
     item->posX = x;
     item->posY = y;
-    item->isEquipped = 1;
+    item->inInventory = 1;
+    if (!indexInventoryItem(inv, item)) {
+        ops->clear(inv, item, x, y);
+        item->inInventory = 0;
+        return 0;
+    }
 
     return 1;
 }
 
-void addItemToGround(GameWorld* world, Item* item, int x, int y) {
+// Przejmuje przedmiot na wlasnosc swiata. Gdy na ziemi nie ma miejsca,
+// przedmiot jest zwalniany i funkcja zwraca 0.
+int addItemToGround(GameWorld* world, Item* item, int x, int y) {
     if (world->groundItemCount >= MAX_GROUND_ITEMS) {
-        printf("Nie mozna dodac wiecej przedmiotow na ziemi!\n");
-        free(item); // Dodane zwolnienie pamięci
-        return;
+        freeWorldObject(&world->clone, item);
+        return 0;
     }
 
-    Item* newItem = (Item*)malloc(sizeof(Item));
-    if (newItem == NULL) {
-        printf("Blad alokacji pamieci dla nowego przedmiotu!\n");
-        free(item); // Dodane zwolnienie pamięci
-        return;
-    }
-    memcpy(newItem, item, sizeof(Item));
-    newItem->posX = x;
-    newItem->posY = y;
-    newItem->isEquipped = 0;
+    item->posX = x;
+    item->posY = y;
+    item->inInventory = 0;
 
-    world->groundItems[world->groundItemCount] = newItem;
+    world->groundItems[world->groundItemCount] = item;
     world->groundItemCount++;
+    stampInfluence(world, INFLUENCE_LOOT, x, y, itemInfluenceValue(item));
 
     world->map[y][x] = 'I';
+    return 1;
 }
 
-void removeItemFromGround(GameWorld* world, int index) {
-    if (index < 0 || index >= world->groundItemCount) return;
+// Zdejmuje przedmiot z ziemi i oddaje go wywolujacemu (bez zwalniania)
+Item* takeItemFromGround(GameWorld* world, int index) {
+    if (index < 0 || index >= world->groundItemCount) return NULL;
 
-    free(world->groundItems[index]);
+    Item* item = world->groundItems[index];
+    stampInfluence(world, INFLUENCE_LOOT, item->posX, item->posY, -itemInfluenceValue(item));
     for (int i = index; i < world->groundItemCount - 1; i++) {
         world->groundItems[i] = world->groundItems[i + 1];
     }
     world->groundItemCount--;
+    world->groundItems[world->groundItemCount] = NULL;
+    return item;
 }
 
-void removeItemFromInventory(Inventory* inv, Item* item) {
-    if (!item || !item->isEquipped) return;
+void removeItemFromGround(GameWorld* world, int index) {
+    freeWorldObject(&world->clone, takeItemFromGround(world, index));
+}
+
+void clearGroundItems(GameWorld* world) {
+    for (int i = 0; i < world->groundItemCount; i++) {
+        freeWorldObject(&world->clone, world->groundItems[i]);
+        world->groundItems[i] = NULL;
+    }
+    world->groundItemCount = 0;
+    world->influence.valid = 0;
+}
+
+int groundItemAt(GameWorld* world, int x, int y) {
+    for (int i = 0; i < world->groundItemCount; i++) {
+        if (world->groundItems[i]->posX == x && world->groundItems[i]->posY == y) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Zdejmuje przedmiot z siatki ekwipunku bez zwalniania pamieci
+int detachItemFromInventory(Inventory* inv, Item* item) {
+    if (!item || !item->inInventory) return 0;
 
     int x = item->posX;
     int y = item->posY;
@@ -259,20 +319,21 @@ void removeItemFromInventory(Inventory* inv, Item* item) {
     // Sprawdź czy przedmiot jest w podanej lokalizacji
     if (x < 0 || y < 0 || x >= inv->width || y >= inv->height ||
         inv->items[y][x] != item) {
-        return;
+        return 0;
     }
 
     // Zwolnij wszystkie sloty zajmowane przez przedmiot
-    for (int i = y; i < y + item->height; i++) {
-        for (int j = x; j < x + item->width; j++) {
-            if (i < inv->height && j < inv->width) {
-                inv->slots[i][j] = 0;
-                inv->items[i][j] = NULL;
-            }
-        }
-    }
+    unindexInventoryItem(inv, item);
+    findShapeOps(inv, item)->clear(inv, item, x, y);
+    item->inInventory = 0;
 
-    free(item);
+    return 1;
+}
+
+void removeItemFromInventory(Inventory* inv, Item* item) {
+    if (detachItemFromInventory(inv, item)) {
+        freeWorldObject(&inv->clone, item);
+    }
 }
 
 void printInventory(Inventory* inv) {
@@ -312,17 +373,56 @@ void printInventory(Inventory* inv) {
 
 void inventoryMenu(GameWorld* world) {
     while (1) {
-        system("cls");
+        clearScreen();
         printf("==== EKWIPUNEK ====\n");
         printInventory(world->player->inventory);
 
-        printf("\n1. Przenies przedmiot\n2. Uzyj przedmiotu\n3. Wroc\nWybierz: ");
+        Item* weapon = world->player->equipment[EQUIP_WEAPON];
+        Item* armor = world->player->equipment[EQUIP_ARMOR];
+        printf("\nBron: %s", weapon ? getString(weapon->name) : "brak");
+        if (weapon) printf(" (+%d ataku)", weapon->attackBonus);
+        printf(" | Zbroja: %s", armor ? getString(armor->name) : "brak");
+        if (armor) printf(" (+%d obrony)", armor->defenseBonus);
+        printf("\n");
+
+        // Podsumowanie z indeksu - liczba i najlepszy przedmiot kategorii
+        Inventory* inv = world->player->inventory;
+        static const char* categoryNames[ITEM_CATEGORY_COUNT] = { "Mikstury", "Bronie", "Zbroje" };
+        for (int c = 0; c < ITEM_CATEGORY_COUNT; c++) {
+            Item* best = bestInventoryItem(inv, (ItemCategory)c);
+            printf("%s%s: %d", c ? " | " : "", categoryNames[c], countInventoryItems(inv, (ItemCategory)c));
+            if (best) printf(" (max +%d)", itemRank(best));
+        }
+        printf("\n");
+
+        printf("\n1. Przenies przedmiot\n2. Uzyj / zaloz / zdejmij przedmiot\n3. Szybka mikstura\n"
+            "4. Zaloz najlepszy ekwipunek\n5. Wroc\nWybierz: ");
         int choice;
         scanf_s("%d", &choice);
 
-        if (choice == 3) {
+        if (choice == 5) {
             break;
         }
+        else if (choice == 3) {
+            Player* player = world->player;
+            Item* potion = quickUsePotion(inv, player->max_health - player->health);
+            if (potion) {
+                int before = player->health;
+                useItem(world, player, potion);
+                printf("Wypito miksture leczenia (+%d zdrowia). Zdrowie: %d/%d\n", player->health - before,
+                    player->health, player->max_health);
+            }
+            else {
+                printf("Brak mikstury leczacej od razu!\n");
+            }
+            Sleep(1000);
+        }
+        else if (choice == 4) {
+            int changed = autoEquipUpgrades(world->player);
+            if (changed) printf("Zalozono lepszy ekwipunek (%d).\n", changed);
+            else printf("Nie masz lepszego ekwipunku.\n");
+            Sleep(1000);
+        }
         else if (choice == 2) {
             printf("Podaj pozycje przedmiotu (x y): ");
             int x, y;
@@ -332,8 +432,18 @@ void inventoryMenu(GameWorld* world) {
                 y >= 0 && y < world->player->inventory->height) {
                 Item* item = world->player->inventory->items[y][x];
                 if (item != NULL && item->posX == x && item->posY == y) {
-                    useItem(world->player, item);
-                    printf("Uzyto przedmiotu: %s\n", item->name);
+                    // useItem moze zwolnic miksture, wiec nazwe pobieramy wczesniej
+                    StringId name = item->name;
+                    ItemUseResult result = useItem(world, world->player, item);
+                    if (result == ITEM_EQUIPPED) {
+                        printf("Zalozono przedmiot: %s\n", getString(name));
+                    }
+                    else if (result == ITEM_UNEQUIPPED) {
+                        printf("Zdjeto przedmiot: %s\n", getString(name));
+                    }
+                    else {
+                        printf("Uzyto przedmiotu: %s\n", getString(name));
+                    }
                     Sleep(2000);
                 }
                 else {
@@ -362,7 +472,7 @@ void inventoryMenu(GameWorld* world) {
 
                 Item* item = world->player->inventory->items[oldY][oldX];
                 if (item != NULL && item->posX == oldX && item->posY == oldY) {
-                    removeItemFromInventory(world->player->inventory, item);
+                    detachItemFromInventory(world->player->inventory, item);
                     if (!addItemToInventory(world->player->inventory, item, newX, newY)) {
                         addItemToInventory(world->player->inventory, item, oldX, oldY);
                         printf("Nie mozna przeniesc przedmiotu!\n");
@@ -387,12 +497,13 @@ void inventoryMenu(GameWorld* world) {
 }
 
 Item* createHealthPotion() {
-    Item* potion = (Item*)malloc(sizeof(Item));
-    strcpy_s(potion->name, 50, "Potion of Health");
+    Item* potion = (Item*)trackedMalloc(sizeof(Item), ALLOC_ITEM);
+    potion->name = STR_HEALTH_POTION;
+    potion->category = ITEM_POTION;
     potion->width = 1;
     potion->height = 1;
     potion->symbol = 'H';
-    potion->isEquipped = 0;
+    potion->inInventory = 0;
     potion->posX = -1;
     potion->posY = -1;
     potion->attackBonus = 0;
@@ -401,55 +512,145 @@ Item* createHealthPotion() {
     return potion;
 }
 
-Item* createSword() {
-    Item* sword = (Item*)malloc(sizeof(Item));
-    strcpy_s(sword->name, 50, "Long Sword");
+#define STRENGTH_POTION_TURNS 20
+#define REGENERATION_TURNS 10
+
+Item* createStrengthPotion() {
+    Item* potion = createHealthPotion();
+    potion->name = STR_STRENGTH_POTION;
+    potion->symbol = 'M';
+    potion->attackBonus = 8;
+    potion->healthBonus = 0;
+    return potion;
+}
+
+// Leczy tyle co zwykla mikstura, ale rozlozone na kolejne tury
+Item* createRegenerationPotion() {
+    Item* potion = createHealthPotion();
+    potion->name = STR_REGENERATION_POTION;
+    potion->symbol = 'R';
+    potion->healthBonus = 40;
+    return potion;
+}
+
+Item* createSword(RandomState* random) {
+    Item* sword = (Item*)trackedMalloc(sizeof(Item), ALLOC_ITEM);
+    sword->name = STR_LONG_SWORD;
+    sword->category = ITEM_SWORD;
     sword->width = 1;
     sword->height = 3;
     sword->symbol = 'S';
-    sword->isEquipped = 0;
+    sword->inInventory = 0;
     sword->posX = -1;
     sword->posY = -1;
-    sword->attackBonus = rand() % 15 + 5;
+    sword->attackBonus = randomInt(random, 15) + 5;
     sword->defenseBonus = 0;
     sword->healthBonus = 0;
     return sword;
 }
 
-Item* createArmor() {
-    Item* armor = (Item*)malloc(sizeof(Item));
-    strcpy_s(armor->name, 50, "Plate Armor");
+Item* createArmor(RandomState* random) {
+    Item* armor = (Item*)trackedMalloc(sizeof(Item), ALLOC_ITEM);
+    armor->name = STR_PLATE_ARMOR;
+    armor->category = ITEM_ARMOR;
     armor->width = 2;
     armor->height = 3;
     armor->symbol = 'A';
-    armor->isEquipped = 0;
+    armor->inInventory = 0;
     armor->posX = -1;
     armor->posY = -1;
     armor->attackBonus = 0;
-    armor->defenseBonus = rand() % 20 + 5;
+    armor->defenseBonus = randomInt(random, 20) + 5;
     armor->healthBonus = 0;
     return armor;
 }
 
-void useItem(Player* player, Item* item) {
-    if (!item) return;
+static int slotForCategory(ItemCategory category) {
+    if (category == ITEM_SWORD) return EQUIP_WEAPON;
+    if (category == ITEM_ARMOR) return EQUIP_ARMOR;
+    return -1;
+}
 
-    player->health += item->healthBonus;
+// Dodaje (sign = 1) lub odejmuje (sign = -1) premie przedmiotu od statystyk pochodnych
+static void applyItemStats(Player* player, const Item* item, int sign) {
+    player->attack += sign * item->attackBonus;
+    player->defense += sign * item->defenseBonus;
+    player->max_health += sign * item->healthBonus;
     if (player->health > player->max_health) {
         player->health = player->max_health;
     }
-    player->attack += item->attackBonus;
-    player->defense += item->defenseBonus;
+}
+
+int isItemEquipped(const Player* player, const Item* item) {
+    int slot = slotForCategory(item->category);
+    return slot >= 0 && player->equipment[slot] == item;
+}
+
+int equipItem(Player* player, Item* item) {
+    int slot = slotForCategory(item->category);
+    if (slot < 0) return 0;
+
+    if (player->equipment[slot] == item) return 1;
+    unequipItem(player, (EquipSlot)slot);
 
-    if (strstr(item->name, "Potion") != NULL) {
+    player->equipment[slot] = item;
+    applyItemStats(player, item, 1);
+    return 1;
+}
+
+void unequipItem(Player* player, EquipSlot slot) {
+    Item* item = player->equipment[slot];
+    if (!item) return;
+
+    applyItemStats(player, item, -1);
+    player->equipment[slot] = NULL;
+}
+
+int worldPlayerIndex(const GameWorld* world, const Player* player) {
+    for (int i = 0; i < world->playerCount; i++) {
+        if (world->players[i] == player) return i;
+    }
+    return -1;
+}
+
+ItemUseResult useItem(GameWorld* world, Player* player, Item* item) {
+    if (!item) return ITEM_NOT_USED;
+
+    if (item->category == ITEM_POTION) {
+        // Mikstury sily i regeneracji dzialaja przez kilka tur
+        int index = worldPlayerIndex(world, player);
+        if (item->name == STR_STRENGTH_POTION) {
+            applyStatusEffect(world, 0, index, EFFECT_STRENGTH, item->attackBonus,
+                STRENGTH_POTION_TURNS * ENEMY_TICKS_PER_TURN, 1);
+        }
+        else if (item->name == STR_REGENERATION_POTION) {
+            applyStatusEffect(world, 0, index, EFFECT_REGENERATION, item->healthBonus / REGENERATION_TURNS,
+                ENEMY_TICKS_PER_TURN, REGENERATION_TURNS);
+        }
+        else {
+            player->health += item->healthBonus;
+            if (player->health > player->max_health) {
+                player->health = player->max_health;
+            }
+        }
         removeItemFromInventory(player->inventory, item);
+        return ITEM_CONSUMED;
+    }
+
+    // Bron i zbroja - zalozenie lub zdjecie
+    if (isItemEquipped(player, item)) {
+        unequipItem(player, (EquipSlot)slotForCategory(item->category));
+        return ITEM_UNEQUIPPED;
     }
+    return equipItem(player, item) ? ITEM_EQUIPPED : ITEM_NOT_USED;
 }
 
 int isHere(GameWorld* world, int x, int y, int currentEnemies, int currentTraps) {
-    // Gracz
-    if (world->player->posX == x && world->player->posY == y)
-        return 1;
+    // Gracze (na serwerze wszyscy polaczeni, nie tylko aktywny)
+    for (int i = 0; i < world->playerCount; i++) {
+        if (world->players[i]->posX == x && world->players[i]->posY == y)
+            return 1;
+    }
 
     // zainicjowani przeciwnicy
     for (int i = 0; i < currentEnemies; i++) {
@@ -465,20 +666,20 @@ int isHere(GameWorld* world, int x, int y, int currentEnemies, int currentTraps)
     return 0;
 }
 
-int normalAttack(int attack, int defense) {
-    int damage = attack / 2 + rand() % (attack / 2 + 1) - defense / 3;
+int normalAttack(int attack, int defense, RandomState* random) {
+    int damage = attack / 2 + randomInt(random, attack / 2 + 1) - defense / 3;
     return (damage < 1) ? 1 : damage;
 }
 
-int criticalAttack(int attack, int defense) {
-    int baseDamage = attack + rand() % (attack + 1);
+int criticalAttack(int attack, int defense, RandomState* random) {
+    int baseDamage = attack + randomInt(random, attack + 1);
     int damage = baseDamage - defense / 4;
     return (damage < 1) ? 1 : damage;
 }
 
 // Tworzenie i inicjalizacja gracza
 Player* createPlayer() {
-    Player* player = (Player*)malloc(sizeof(Player));
+    Player* player = (Player*)trackedMalloc(sizeof(Player), ALLOC_PLAYER);
     if (!player) {
         printf("Blad alokacji pamieci dla gracza\n");
         exit(1);
@@ -486,13 +687,19 @@ Player* createPlayer() {
     return player;
 }
 
-void initPlayer(Player* player) {
-    printf("Podaj swoje imie: ");
-    scanf_s("%49s", player->name, (unsigned)_countof(player->name));
-    player->max_health = 200;
+void initPlayer(Player* player, const char* name, RandomState* random) {
+    snprintf(player->name, sizeof(player->name), "%s", name);
+    player->base_max_health = 200;
+    player->base_attack = 17;
+    player->base_defense = randomInt(random, 10) + 5;
+    player->max_health = player->base_max_health;
     player->health = player->max_health;
-    player->attack = 17;
-    player->defense = rand() % 10 + 5;
+    player->attack = player->base_attack;
+    player->defense = player->base_defense;
+    for (int i = 0; i < EQUIP_SLOT_COUNT; i++) {
+        player->equipment[i] = NULL;
+    }
+    player->effect_attack = 0;
     player->gold = 15;
     player->posX = 0;
     player->posY = 0;
@@ -501,74 +708,85 @@ void initPlayer(Player* player) {
 }
 
 // Tworzenie i inicjalizacja przeciwnika
-Enemy* createEnemy(int x, int y) {
-    Enemy* enemy = (Enemy*)malloc(sizeof(Enemy));
+Enemy* createEnemy(int x, int y, RandomState* random) {
+    Enemy* enemy = (Enemy*)trackedMalloc(sizeof(Enemy), ALLOC_ENEMY);
     if (!enemy) {
         printf("Blad alokacji pamieci dla przeciwnika\n");
         exit(1);
     }
-    initEnemy(enemy, x, y);
+    initEnemy(enemy, x, y, random);
     return enemy;
 }
 
-void initEnemy(Enemy* enemy, int x, int y) {
-    strcpy_s(enemy->name, 50, rand() % 2 ? "Goblin" : "Ork");
-    enemy->health = rand() % 50 + 20;
-    enemy->attack = rand() % 5 + 5;
-    enemy->defense = rand() % 5 + 2;
+void initEnemy(Enemy* enemy, int x, int y, RandomState* random) {
+    enemy->name = randomInt(random, 2) ? STR_GOBLIN : STR_ORK;
+    enemy->health = randomInt(random, 50) + 20;
+    enemy->attack = randomInt(random, 5) + 5;
+    enemy->defense = randomInt(random, 5) + 2;
     enemy->EposX = x;
     enemy->EposY = y;
+    enemy->prevX = x;
+    enemy->prevY = y;
+    // Gobliny sa szybsze od orkow
+    enemy->moveDelay = (enemy->name == STR_GOBLIN ? 3 : 5) + randomInt(random, 3);
+    enemy->moveTimer = 1 + randomInt(random, enemy->moveDelay);
 
 }
 
 // Tworzenie i inicjalizacja pulapki
-Trap* createTrap(int x, int y) {
-    Trap* trap = (Trap*)malloc(sizeof(Trap));
+Trap* createTrap(int x, int y, RandomState* random) {
+    Trap* trap = (Trap*)trackedMalloc(sizeof(Trap), ALLOC_TRAP);
     if (!trap) {
         printf("Blad alokacji pamieci dla pulapki\n");
         exit(1);
     }
-    initTrap(trap, x, y);
+    initTrap(trap, x, y, random);
     return trap;
 }
 
-void initTrap(Trap* trap, int x, int y) {
+void initTrap(Trap* trap, int x, int y, RandomState* random) {
     trap->posX = x;
     trap->posY = y;
-    trap->damage = rand() % 15 + 5;
+    trap->damage = randomInt(random, 15) + 5;
     trap->discovered = 0;
-    strcpy_s(trap->description, 100, rand() % 2 ? "Kolce" : "Spadajace glazy");
+    trap->description = randomInt(random, 2) ? STR_TRAP_SPIKES : STR_TRAP_BOULDERS;
 }
 
 
 void checkTraps(GameWorld* world) {
+    PROFILE_SCOPE(PHASE_TRAPS);
+    PROFILE_COUNT(COUNTER_ENTITIES, world->trapCount);
     for (int i = 0; i < world->trapCount; i++) {
         Trap* trap = world->traps[i];
 
         if (world->player->posX == trap->posX && world->player->posY == trap->posY && !trap->discovered) {
-            printf("Odkryles pulapke: %s!\n", trap->description);
             world->player->health -= trap->damage;
-            printf("Zostales ranny! Straciles %d HP.\n", trap->damage);
-            Sleep(2000);
             trap->discovered = 1;
+            stampInfluence(world, INFLUENCE_DANGER, trap->posX, trap->posY, -trap->damage);
+            emitEvent(world, EVENT_TRAP_TRIGGERED, trap->description, trap->damage, 0);
 
             if (world->player->health <= 0) {
-                printf("Zostales zabity przez pulapke!\nKoniec gry.\n");
-				freeGameWorld(world);
-                exit(0);
+                emitEvent(world, EVENT_PLAYER_DIED, trap->description, 0, EVENT_FLAG_BY_TRAP);
+                world->status = GAME_LOST;
+                return;
+            }
+            // Kolce zostawiaja krwawiace rany
+            if (trap->description == STR_TRAP_SPIKES) {
+                applyStatusEffect(world, 0, worldPlayerIndex(world, world->player), EFFECT_BLEEDING,
+                    1 + trap->damage / 10, ENEMY_TICKS_PER_TURN, 3);
             }
         }
     }
 }
 
 void initMap(GameWorld* world) {
-    world->map = (char**)malloc(MAP_HEIGHT * sizeof(char*));
+    world->map = (char**)trackedMalloc(MAP_HEIGHT * sizeof(char*), ALLOC_MAP);
     if (!world->map) {
         printf("Blad alokacji pamieci dla mapy\n");
         exit(1);
     }
     for (int i = 0; i < MAP_HEIGHT; i++) {
-        world->map[i] = (char*)malloc(MAP_WIDTH * sizeof(char));
+        world->map[i] = (char*)trackedMalloc(MAP_WIDTH * sizeof(char), ALLOC_MAP);
         if (!world->map[i]) {
             printf("Blad alokacji pamieci dla wiersza mapy\n");
             exit(1);
@@ -580,6 +798,9 @@ void initMap(GameWorld* world) {
 }
 
 void reloadMap(GameWorld* world) {
+    PROFILE_SCOPE(PHASE_RELOAD_MAP);
+    PROFILE_COUNT(COUNTER_TILES, MAP_HEIGHT * MAP_WIDTH);
+    PROFILE_COUNT(COUNTER_ENTITIES, world->groundItemCount + world->trapCount + world->enemyCount);
     for (int i = 0; i < MAP_HEIGHT; i++) {
         for (int j = 0; j < MAP_WIDTH; j++) {
             world->map[i][j] = '.';
@@ -608,113 +829,115 @@ void reloadMap(GameWorld* world) {
     world->map[world->player->posY][world->player->posX] = 'P';
 }
 
+// Losowe pole bez gracza, przeciwnika i pulapki. Gdy takiego nie ma,
+// gracz zostaje na miejscu.
+static void placePlayerOnFreeCell(GameWorld* world, Player* player) {
+    for (int attempt = 0; attempt < MAP_WIDTH * MAP_HEIGHT; attempt++) {
+        int x = randomInt(&world->random, MAP_WIDTH);
+        int y = randomInt(&world->random, MAP_HEIGHT);
+        if (!isHere(world, x, y, world->enemyCount, world->trapCount)) {
+            player->posX = x;
+            player->posY = y;
+            return;
+        }
+    }
+}
+
 void nextLevel(GameWorld* world) {
     if (world->level >= 3) {
-        printf("Gratulacje! Ukonczyles wszystkie 3 poziomow gry!\n");
-        Sleep(3000);
-        freeGameWorld(world);
-        exit(0);
+        emitEvent(world, EVENT_GAME_WON, STRING_NONE, world->level, 0);
+        world->status = GAME_WON;
+        return;
+    }
+
+    // Poziom zbudowany w tle od otwarcia portalu albo budowany teraz
+    LevelContent next;
+    if (!takePrefetchedLevel(world, &next)) {
+        buildLevelContent(&next, world->level + 1, &world->random, &world->balance);
     }
 
     world->level++;
     world->enemiesDefeated = 0;
     world->portalActive = 0;
 
-    // Zwolnienie pamięci starych przeciwników
-    for (int i = 0; i < world->enemyCount; i++) {
-        free(world->enemies[i]);
-    }
-    free(world->enemies);
-
-    // Zwolnienie pamięci starych pułapek
-    for (int i = 0; i < world->trapCount; i++) {
-        free(world->traps[i]);
-    }
-    free(world->traps);
-
-    // Zwolnienie przedmiotów na ziemi
+    // Stary poziom - z watkiem wyprzedzania zwalniany w tle
+    LevelContent old;
+    old.level = world->level - 1;
+    old.enemies = world->enemies;
+    old.enemyCount = world->enemyCount;
+    old.traps = world->traps;
+    old.trapCount = world->trapCount;
+    old.itemCount = world->groundItemCount;
     for (int i = 0; i < world->groundItemCount; i++) {
-        free(world->groundItems[i]);
+        old.items[i] = world->groundItems[i];
+        world->groundItems[i] = NULL;
     }
     world->groundItemCount = 0;
-
-    world->enemyCount = MAX_ENEMIES + world->level / 2;
-    world->trapCount = MAX_TRAPS + world->level / 2;
-
-    // Inicjalizacja nowych przeciwników
-    world->enemies = (Enemy**)malloc(world->enemyCount * sizeof(Enemy*));
-    for (int i = 0; i < world->enemyCount; i++) {
-        int x, y;
-        do {
-            x = rand() % MAP_WIDTH;
-            y = rand() % MAP_HEIGHT;
-        } while (isHere(world, x, y, i, 0));
-
-        world->enemies[i] = createEnemy(x, y);
-        world->enemies[i]->health += world->level * 5;
-        world->enemies[i]->attack += world->level * 2;
-        world->enemies[i]->defense += world->level;
-    }
-
-    // Inicjalizacja nowych pułapek
-    world->traps = (Trap**)malloc(world->trapCount * sizeof(Trap*));
-    for (int i = 0; i < world->trapCount; i++) {
-        int x, y;
-        do {
-            x = rand() % MAP_WIDTH;
-            y = rand() % MAP_HEIGHT;
-        } while (isHere(world, x, y, world->enemyCount, i));
-
-        world->traps[i] = createTrap(x, y);
-        world->traps[i]->damage += world->level * 2;
+    retireLevelContent(world, &old);
+    memtrackBeginLevel(world->level);
+
+    clearEnemyEffects(world);
+    world->enemies = next.enemies;
+    world->enemyCount = next.enemyCount;
+    world->schedule.valid = 0;
+    world->schedule.clock = 0;
+    world->influence.valid = 0;
+    world->traps = next.traps;
+    world->trapCount = next.trapCount;
+    for (int i = 0; i < next.itemCount; i++) {
+        addItemToGround(world, next.items[i], next.items[i]->posX, next.items[i]->posY);
+    }
+
+    // Aktywny gracz w rogu (pole wolne na kazdym poziomie), pozostali
+    // gracze serwera na wolnych polach nowej mapy
+    world->player->posX = 0;
+    world->player->posY = 0;
+    for (int i = 0; i < world->playerCount; i++) {
+        Player* player = world->players[i];
+        if (player != world->player) {
+            placePlayerOnFreeCell(world, player);
+        }
+        player->health = (int)player->max_health * 0.8;
+        if (player->health < 1) player->health = 1;
     }
 
-    // Generowanie nowych przedmiotów na ziemi
-    int itemsToPlace = 5 + rand() % 6; // 5-10 przedmiotów na nowym poziomie
-    for (int i = 0; i < itemsToPlace && world->groundItemCount < MAX_GROUND_ITEMS; i++) {
-        int x, y;
-        do {
-            x = rand() % MAP_WIDTH;
-            y = rand() % MAP_HEIGHT;
-        } while (isHere(world, x, y, world->enemyCount, world->trapCount) ||
-            world->map[y][x] == 'I');
+    // Odświeżenie mapy
+    reloadMap(world);
 
-        Item* newItem = NULL;
-        int itemType = rand() % 100;
+    emitEvent(world, EVENT_LEVEL_CHANGED, STRING_NONE, world->level, 0);
+}
 
-        if (itemType < 50) { // 40% szansy na miksturę zdrowia
-            newItem = createHealthPotion();
-        }
-        else if (itemType < 75) { // 40% szansy na miecz
-            newItem = createSword();
-        }
-        else { // 20% szansy na zbroję
-            newItem = createArmor();
-        }
 
-        addItemToGround(world, newItem, x, y);
+// Ziarno swiata z globalnego rand() - dla gry i narzedzi, ktore nie podaja
+// wlasnego ziarna (po srand wynik jest powtarzalny)
+unsigned long long newWorldSeed() {
+    unsigned long long seed = 0;
+    for (int i = 0; i < 4; i++) {
+        seed = (seed << 16) ^ (unsigned long long)rand();
     }
+    return seed;
+}
 
-    world->player->posX = 0;
-    world->player->posY = 0;
-
-    world->player->health = (int)world->player->max_health * 0.8;
-    if (world->player->health < 1) world->player->health = 1;
-
-    // Odświeżenie mapy
-    reloadMap(world);
-
-    printf("Witaj na poziomie %d! Przeciwnicy sa silniejsi!\n", world->level);
-    Sleep(2000);
+// Reczne ustawienia gry sprzed strojenia
+void defaultBalance(BalanceConfig* balance) {
+    balance->enemyHealthPerLevel = 5;
+    balance->enemyAttackPerLevel = 2;
+    balance->enemyDefensePerLevel = 1;
+    balance->trapDamagePerLevel = 2;
+    balance->dropChance = 90;
 }
 
+GameWorld* createGameWorld(const char* playerName) {
+    return createSeededGameWorld(playerName, newWorldSeed());
+}
 
-GameWorld* createGameWorld() {
-    GameWorld* world = (GameWorld*)malloc(sizeof(GameWorld));
+GameWorld* createSeededGameWorld(const char* playerName, unsigned long long seed) {
+    GameWorld* world = (GameWorld*)trackedMalloc(sizeof(GameWorld), ALLOC_WORLD);
     if (!world) {
         printf("Blad alokacji pamieci dla swiata gry\n");
         exit(1);
     }
+    memtrackBeginLevel(1);
 
     // Inicjalizacja podstawowych parametrów świata
     world->level = 1;
@@ -724,17 +947,37 @@ GameWorld* createGameWorld() {
     world->portalY = 0;
     world->totalEnemiesDefeated = 0;
     world->groundItemCount = 0;
+    world->status = GAME_RUNNING;
+    world->turn = 0;
+    world->events = createEventQueue();
+    world->journal = NULL;
+    world->saveGeneration = 0;
+    world->saveSlot = 0;
+    // Nazwa slotu jest krotsza niz imie gracza - przyciecie zamierzone
+    snprintf(world->saveSlotName, sizeof(world->saveSlotName), "%.*s", SAVE_SLOT_NAME_LENGTH - 1, playerName);
+    world->clone.start = NULL;
+    world->clone.size = 0;
+    world->prefetch = NULL;
+    seedRandom(&world->random, seed);
+    defaultBalance(&world->balance);
+    memset(&world->schedule, 0, sizeof(EnemySchedule));
+    memset(&world->effects, 0, sizeof(StatusEffects));
+    memset(&world->influence, 0, sizeof(InfluenceMaps));
 
     // Inicjalizacja mapy
     initMap(world);
 
     // Inicjalizacja gracza
     world->player = createPlayer();
-    initPlayer(world->player);
+    initPlayer(world->player, playerName, &world->random);
+    world->players = NULL;
+    world->playerCount = 0;
+    world->playerCapacity = 0;
+    appendWorldPlayer(world, world->player);
 
     // Inicjalizacja przeciwników
     world->enemyCount = MAX_ENEMIES;
-    world->enemies = (Enemy**)malloc(world->enemyCount * sizeof(Enemy*));
+    world->enemies = (Enemy**)trackedMalloc(world->enemyCount * sizeof(Enemy*), ALLOC_ENEMY);
     if (!world->enemies) {
         printf("Blad alokacji pamieci dla przeciwnikow\n");
         exit(1);
@@ -742,14 +985,14 @@ GameWorld* createGameWorld() {
 
     // Inicjalizacja pułapek
     world->trapCount = MAX_TRAPS;
-    world->traps = (Trap**)malloc(world->trapCount * sizeof(Trap*));
+    world->traps = (Trap**)trackedMalloc(world->trapCount * sizeof(Trap*), ALLOC_TRAP);
     if (!world->traps) {
         printf("Blad alokacji pamieci dla pulapek\n");
         exit(1);
     }
 
     // Inicjalizacja przedmiotów na ziemi
-    world->groundItems = (Item**)malloc(MAX_GROUND_ITEMS * sizeof(Item*));
+    world->groundItems = (Item**)trackedCalloc(MAX_GROUND_ITEMS, sizeof(Item*), ALLOC_ITEM);
     if (!world->groundItems) {
         printf("Blad alokacji pamieci dla przedmiotow na ziemi\n");
         exit(1);
@@ -759,45 +1002,51 @@ GameWorld* createGameWorld() {
     for (int i = 0; i < world->enemyCount; i++) {
         int x, y;
         do {
-            x = rand() % MAP_WIDTH;
-            y = rand() % MAP_HEIGHT;
+            x = randomInt(&world->random, MAP_WIDTH);
+            y = randomInt(&world->random, MAP_HEIGHT);
         } while (isHere(world, x, y, i, 0));
 
-        world->enemies[i] = createEnemy(x, y);
+        world->enemies[i] = createEnemy(x, y, &world->random);
     }
 
     // Umieszczanie pułapek na mapie
     for (int i = 0; i < world->trapCount; i++) {
         int x, y;
         do {
-            x = rand() % MAP_WIDTH;
-            y = rand() % MAP_HEIGHT;
+            x = randomInt(&world->random, MAP_WIDTH);
+            y = randomInt(&world->random, MAP_HEIGHT);
         } while (isHere(world, x, y, world->enemyCount, i));
 
-        world->traps[i] = createTrap(x, y);
+        world->traps[i] = createTrap(x, y, &world->random);
     }
 
     // Generowanie losowych przedmiotów na mapie
-    int itemsToPlace = 5 + rand() % 6; // 5-10 przedmiotow na start
+    int itemsToPlace = 5 + randomInt(&world->random, 6); // 5-10 przedmiotow na start
     for (int i = 0; i < itemsToPlace && world->groundItemCount < MAX_GROUND_ITEMS; i++) {
         int x, y;
         do {
-            x = rand() % MAP_WIDTH;
-            y = rand() % MAP_HEIGHT;
+            x = randomInt(&world->random, MAP_WIDTH);
+            y = randomInt(&world->random, MAP_HEIGHT);
         } while (isHere(world, x, y, world->enemyCount, world->trapCount) ||
-            world->map[y][x] == 'I');
+            groundItemAt(world, x, y) >= 0);
 
         Item* newItem = NULL;
-        int itemType = rand() % 100;
+        int itemType = randomInt(&world->random, 100);
 
-        if (itemType < 50) { // 50% szansy na miksturę zdrowia
+        if (itemType < 40) { // 40% szansy na miksturę zdrowia
             newItem = createHealthPotion();
         }
-        else if (itemType < 75) { // 45% szansy na miecz
-            newItem = createSword();
+        else if (itemType < 45) { // 5% szansy na miksturę regeneracji
+            newItem = createRegenerationPotion();
+        }
+        else if (itemType < 50) { // 5% szansy na miksturę siły
+            newItem = createStrengthPotion();
+        }
+        else if (itemType < 75) { // 25% szansy na miecz
+            newItem = createSword(&world->random);
         }
         else { // 25% szansy na zbroję
-            newItem = createArmor();
+            newItem = createArmor(&world->random);
         }
 
         addItemToGround(world, newItem, x, y);
@@ -815,99 +1064,138 @@ GameWorld* createGameWorld() {
 
 void activatePortal(GameWorld* world) {
     do {
-        world->portalX = rand() % MAP_WIDTH;
-        world->portalY = rand() % MAP_HEIGHT;
+        world->portalX = randomInt(&world->random, MAP_WIDTH);
+        world->portalY = randomInt(&world->random, MAP_HEIGHT);
     } while (isHere(world, world->portalX, world->portalY, world->enemyCount, world->trapCount) ||
         (world->player->posX == world->portalX && world->player->posY == world->portalY));
 
     world->portalActive = 1;
-    printf("Pojawil sie magiczny portal prowadzacy do nastepnego poziomu!\n");
+    emitEventAt(world, EVENT_PORTAL_OPENED, STRING_NONE, 0, 0, world->portalX, world->portalY);
     reloadMap(world);
-    Sleep(2000);
-}
 
-int battle(Player* player, Enemy* enemy, GameWorld* world) {
-    system("cls");
-    printf("==== WALKA ====\n");
-    while (1) {
-        printf("Gracz %s: %d/%d HP | Atak: %d | Obrona: %d\n",
-            player->name, player->health, player->max_health, player->attack, player->defense);
-        printf("Przeciwnik %s: %d HP | Atak: %d | Obrona: %d\n\n",
-            enemy->name, enemy->health, enemy->attack, enemy->defense);
-
-        printf("1. Normalny atak\n2. Ucieczka\nWybierz akcje: ");
-        int action;
-        scanf_s("%d", &action);
-        while (getchar() != '\n');
-
-        if (action == 1) {
-            // Losowy wybór typu ataku
-            AttackFunction attackFunc = (rand() % 100 < 15) ? criticalAttack : normalAttack;
-            if (attackFunc == criticalAttack) {
-                printf("Wykonujesz atak krytyczny!\n");
-            }
-            else {
-                printf("Wykonujesz atak normalny.\n");
-            }
+    // Gracz idzie do portalu, a nastepny poziom powstaje w tle
+    requestLevelPrefetch(world);
+}
 
-            int damage = attackFunc(player->attack, enemy->defense);
-            enemy->health -= damage;
-            printf("Zadales %d obrazen!\n", damage);
-        }
-        else if (action == 2) {
-            if (rand() % 2) {
-                printf("Udalo ci sie uciec!\n");
-                return 0;
-            }
-            else {
-                printf("Nie udalo ci sie uciec!\n");
+// Jedna runda walki: akcja gracza i odpowiedz przeciwnika
+BattleResult battleRound(GameWorld* world, Enemy* enemy, BattleAction action) {
+    Player* player = world->player;
+
+    if (action == BATTLE_ATTACK) {
+        // Losowy wybór typu ataku
+        AttackFunction attackFunc = (randomInt(&world->random, 100) < 15) ? criticalAttack : normalAttack;
+        int damage = attackFunc(player->attack + player->effect_attack, enemy->defense, &world->random);
+        enemy->health -= damage;
+        emitEvent(world, EVENT_DAMAGE_DEALT, enemy->name, damage,
+            attackFunc == criticalAttack ? EVENT_FLAG_CRITICAL : 0);
+
+        // Krytyk zostawia krwawiaca rane, jesli przeciwnik przezyl
+        if (attackFunc == criticalAttack && enemy->health > 0) {
+            for (int i = 0; i < world->enemyCount; i++) {
+                if (world->enemies[i] == enemy) {
+                    applyStatusEffect(world, 1, i, EFFECT_BLEEDING, 1 + player->attack / 10, ENEMY_TICKS_PER_TURN, 3);
+                    break;
+                }
             }
         }
-        else {
-            printf("Nieznana akcja. Sprobuj ponownie.\n\n");
-            continue;
+    }
+    else if (action == BATTLE_FLEE) {
+        if (randomInt(&world->random, 2)) {
+            emitEvent(world, EVENT_FLEE_ATTEMPT, enemy->name, 0, EVENT_FLAG_SUCCESS);
+            return BATTLE_FLED;
         }
+        emitEvent(world, EVENT_FLEE_ATTEMPT, enemy->name, 0, 0);
+    }
+    else {
+        return BATTLE_CONTINUE;
+    }
 
-        if (enemy->health <= 0) {
-            printf("Pokonales %s!\n", enemy->name);
-            int gold = 10 + rand() % 20;
-            player->gold += gold;
-            printf("Zdobywasz %d zlota.\n", gold);
-            world->enemiesDefeated++;
-            world->totalEnemiesDefeated++;
+    if (enemy->health <= 0) {
+        int gold = 10 + randomInt(&world->random, 20);
+        player->gold += gold;
+        world->enemiesDefeated++;
+        world->totalEnemiesDefeated++;
+        emitEvent(world, EVENT_ENEMY_DEFEATED, enemy->name, gold, 0);
 
-            if (world->enemiesDefeated >= 5 && !world->portalActive) {
-                activatePortal(world);
-            }
-            return 1;
+        if (world->enemiesDefeated >= 5 && !world->portalActive) {
+            activatePortal(world);
         }
+        return BATTLE_WON;
+    }
 
-        // Tura przeciwnika - przeciwnik używa normalnego ataku
-        int enemyDamage = normalAttack(enemy->attack, player->defense);
-        player->health -= enemyDamage;
-        printf("%s zadaje %d obrazen!\n", enemy->name, enemyDamage);
+    // Tura przeciwnika - przeciwnik używa normalnego ataku
+    int enemyDamage = normalAttack(enemy->attack, player->defense, &world->random);
+    player->health -= enemyDamage;
+    emitEvent(world, EVENT_DAMAGE_DEALT, enemy->name, enemyDamage, EVENT_FLAG_TO_PLAYER);
 
-        if (player->health <= 0) {
-            printf("Zostales pokonany!\nKoniec gry.\n");
-            freeGameWorld(world);
-            exit(0);
-        }
+    if (player->health <= 0) {
+        emitEvent(world, EVENT_PLAYER_DIED, enemy->name, 0, 0);
+        world->status = GAME_LOST;
+        return BATTLE_LOST;
+    }
+    // Ostrza goblinow bywaja zatrute
+    if (enemy->name == STR_GOBLIN && randomInt(&world->random, 100) < 20) {
+        applyStatusEffect(world, 0, worldPlayerIndex(world, player), EFFECT_POISON, 2, ENEMY_TICKS_PER_TURN, 4);
+    }
+    return BATTLE_CONTINUE;
+}
 
+BattleResult battle(GameWorld* world, Enemy* enemy, BattleActionFunction chooseAction, void* context) {
+    BattleResult result = BATTLE_CONTINUE;
+    for (int round = 0; result == BATTLE_CONTINUE; round++) {
+        result = battleRound(world, enemy, chooseAction(world, enemy, round, context));
+    }
+    return result;
+}
+
+// Decyzje gracza w walce czytane z konsoli
+BattleAction promptBattleAction(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)context;
+    Player* player = world->player;
+
+    if (round > 0) {
+        presentEvents(world);
         printf("\nNacisnij Enter, aby kontynuowac...");
         while (getchar() != '\n');
-        system("cls");
     }
-    return 0;
+    clearScreen();
+    printf("==== WALKA ====\n");
+
+    while (1) {
+        printf("Gracz %s: %d/%d HP | Atak: %d | Obrona: %d\n",
+            player->name, player->health, player->max_health, player->attack + player->effect_attack, player->defense);
+        printf("Przeciwnik %s: %d HP | Atak: %d | Obrona: %d\n\n",
+            getString(enemy->name), enemy->health, enemy->attack, enemy->defense);
+
+        printf("1. Normalny atak\n2. Ucieczka\nWybierz akcje: ");
+        int action;
+        scanf_s("%d", &action);
+        while (getchar() != '\n');
+
+        if (action == BATTLE_ATTACK || action == BATTLE_FLEE) {
+            return (BattleAction)action;
+        }
+        printf("Nieznana akcja. Sprobuj ponownie.\n\n");
+    }
 }
 
 
 void printMap(GameWorld* world) {
-    system("cls");
+    PROFILE_SCOPE(PHASE_RENDER);
+    PROFILE_COUNT(COUNTER_TILES, MAP_HEIGHT * MAP_WIDTH);
+    clearScreen();
     printf("Gracz: %s | Poziom: %d | HP: %d/%d | Atak: %d | Obrona: %d | Zloto: %d\n",
-        world->player->name, world->level, world->player->health,
-        world->player->max_health, world->player->attack, world->player->defense, world->player->gold);
+        world->player->name, world->level, world->player->health, world->player->max_health,
+        world->player->attack + world->player->effect_attack, world->player->defense, world->player->gold);
     printf("Pokonani wrogowie: %d/5 (lvl) | %d (total)\n",
         world->enemiesDefeated, world->totalEnemiesDefeated);
+    char effects[128];
+    if (formatStatusEffects(world, world->player, effects, sizeof(effects)) > 0) {
+        printf("Efekty: %s\n", effects);
+    }
+    char hints[128];
+    formatInfluenceHints(world, hints, sizeof(hints));
+    printf("%s\n", hints);
 
     for (int i = 0; i < MAP_HEIGHT; i++) {
         for (int j = 0; j < MAP_WIDTH; j++) {
@@ -918,8 +1206,8 @@ void printMap(GameWorld* world) {
 }
 
 
-void moveEnemy(Enemy* enemy) {
-    int dir = rand() % 4;
+void moveEnemy(Enemy* enemy, RandomState* random) {
+    int dir = randomInt(random, 4);
     int newX = enemy->EposX;
     int newY = enemy->EposY;
 
@@ -938,113 +1226,279 @@ void moveEnemy(Enemy* enemy) {
 void freeGameWorld(GameWorld* world) {
     if (!world) return;
 
-    for (int i = 0; i < world->groundItemCount; i++) {
-        free(world->groundItems[i]);
+    // Najpierw watek wyprzedzania - zwalnia swoje poziomy i konczy sie
+    freeLevelPrefetch(world->prefetch);
+
+    // Klon: zwalniane sa tylko obiekty spoza bloku, na koncu caly blok
+    const CloneBlock* block = &world->clone;
+    if (world->groundItems) {
+        clearGroundItems(world);
     }
-    free(world->groundItems);
+    freeWorldObject(block, world->groundItems);
 
-    // Zwolnij ekwipunek
-    if (world->player && world->player->inventory) {
-        for (int y = 0; y < world->player->inventory->height; y++) {
-            for (int x = 0; x < world->player->inventory->width; x++) {
-                Item* item = world->player->inventory->items[y][x];
-                if (item != NULL && item->posX == x && item->posY == y) {
-                    free(item);
-                }
-            }
+    // Zwolnij graczy - freeInventory zwalnia tez przedmioty
+    for (int i = 0; i < world->playerCount; i++) {
+        if (world->players[i] && world->players[i]->inventory) {
+            freeInventory(world->players[i]->inventory);
         }
-        freeInventory(world->player->inventory);
+        freeWorldObject(block, world->players[i]);
     }
-
-    // Zwolnij gracza
-    free(world->player);
+    freeWorldObject(block, world->players);
 
     // Zwolnij przeciwników
     for (int i = 0; i < world->enemyCount; i++) {
-        free(world->enemies[i]);
+        freeWorldObject(block, world->enemies[i]);
     }
-    free(world->enemies);
+    freeWorldObject(block, world->enemies);
+    freeWorldObject(block, world->schedule.heap);
+    freeWorldObject(block, world->effects.pool);
+    freeWorldObject(block, world->effects.targetHeads[0]);
+    freeWorldObject(block, world->effects.targetHeads[1]);
+    freeWorldObject(block, world->influence.fields[0]);
 
     // Zwolnij pułapki
     for (int i = 0; i < world->trapCount; i++) {
-        free(world->traps[i]);
+        freeWorldObject(block, world->traps[i]);
     }
-    free(world->traps);
+    freeWorldObject(block, world->traps);
 
     // Zwolnij mape
-    if (world->map) {
+    if (world->map && !block->start) {
         for (int i = 0; i < MAP_HEIGHT; i++) {
-            free(world->map[i]);
+            trackedFree(world->map[i]);
+        }
+        trackedFree(world->map);
+    }
+
+    closeSaveJournal(world->journal);
+    freeEventQueue(world->events);
+    trackedFree(block->start ? block->start : (char*)world);
+}
+
+
+// Dopisuje gracza do tablicy graczy swiata. Tablica rosnie nowym blokiem,
+// bo w klonie stara lezy w bloku swiata.
+int appendWorldPlayer(GameWorld* world, Player* player) {
+    if (world->playerCount == world->playerCapacity) {
+        int capacity = world->playerCapacity ? world->playerCapacity * 2 : 4;
+        Player** players = (Player**)trackedMalloc(capacity * sizeof(Player*), ALLOC_PLAYER);
+        if (!players) return 0;
+        if (world->playerCount > 0) {
+            memcpy(players, world->players, world->playerCount * sizeof(Player*));
         }
-        free(world->map);
+        freeWorldObject(&world->clone, world->players);
+        world->players = players;
+        world->playerCapacity = capacity;
     }
+    world->players[world->playerCount++] = player;
+    return 1;
+}
 
-    free(world);
+// Kolejny gracz w istniejacym swiecie (serwer) - na losowym wolnym polu.
+// NULL, gdy swiat jest pelny.
+Player* addWorldPlayer(GameWorld* world, const char* name) {
+    if (world->playerCount >= MAX_PLAYERS) {
+        return NULL;
+    }
+    Player* player = createPlayer();
+    initPlayer(player, name, &world->random);
+    placePlayerOnFreeCell(world, player);
+    if (!appendWorldPlayer(world, player)) {
+        freeInventory(player->inventory);
+        freeWorldObject(&world->clone, player);
+        return NULL;
+    }
+    if (!world->player) {
+        world->player = player;
+    }
+    return player;
 }
 
+// Usuwa gracza ze swiata. Gdy byl aktywny, aktywnym zostaje pierwszy
+// pozostaly (albo NULL, gdy swiat jest pusty).
+void removeWorldPlayer(GameWorld* world, Player* player) {
+    for (int i = 0; i < world->playerCount; i++) {
+        if (world->players[i] != player) continue;
+
+        removePlayerEffects(world, i);
+        freeInventory(player->inventory);
+        freeWorldObject(&world->clone, player);
+        world->players[i] = world->players[--world->playerCount];
+        if (world->player == player) {
+            world->player = world->playerCount > 0 ? world->players[0] : NULL;
+        }
+        return;
+    }
+}
+
+// Subskrybenci zdarzen interfejsu konsolowego
+#define MAX_EVENT_SUBSCRIBERS 8
+static EventSubscriber eventSubscribers[MAX_EVENT_SUBSCRIBERS];
+static int eventSubscriberCount = 0;
+EventStats sessionStats;
+
+int subscribeEvents(EventHandler handle, void* context) {
+    if (eventSubscriberCount >= MAX_EVENT_SUBSCRIBERS) return 0;
+    eventSubscribers[eventSubscriberCount].handle = handle;
+    eventSubscribers[eventSubscriberCount].context = context;
+    eventSubscriberCount++;
+    return 1;
+}
+
+void unsubscribeEvents(EventHandler handle) {
+    for (int i = 0; i < eventSubscriberCount; i++) {
+        if (eventSubscribers[i].handle == handle) {
+            for (int j = i; j < eventSubscriberCount - 1; j++) {
+                eventSubscribers[j] = eventSubscribers[j + 1];
+            }
+            eventSubscriberCount--;
+            return;
+        }
+    }
+}
+
+void presentEvents(GameWorld* world) {
+    drainEvents(world->events, eventSubscribers, eventSubscriberCount);
+}
+
+// Konczy program, gdy logika gry oznaczyla koniec rozgrywki
+void finishGameIfOver(GameWorld* world) {
+    if (world->status == GAME_RUNNING) return;
+
+    presentEvents(world);
+    printEventStats(&sessionStats);
+    freeGameWorld(world);
+    exit(0);
+}
 
 void movePlayerAndEnemy(GameWorld* world) {
     char move;
     printf("Ruch (WASD), I - ekwipunek, Z - zapisz gre, P - podnies przedmiot, Q - wyjscie: ");
-    scanf_s(" %c", &move);
-    while (getchar() != '\n');
+    {
+        PROFILE_SCOPE(PHASE_INPUT);
+        scanf_s(" %c", &move);
+        while (getchar() != '\n');
+    }
+
+    if (isMenuCommand(move)) {
+        handleMenuCommand(world, move);
+    }
+    else {
+        stepWorld(world, move, promptBattleAction, NULL);
+    }
+    journalTurn(world->journal, world);
+
+    presentEvents(world);
+    finishGameIfOver(world);
+}
+
+// Jedna tura symulacji: polecenie gracza, ruch przeciwnikow i walki.
+// Wynik tury trafia do kolejki zdarzen i pola status swiata.
+void stepWorld(GameWorld* world, char move, BattleActionFunction chooseAction, void* context) {
+    {
+        PROFILE_SCOPE(PHASE_TURN);
+        world->turn++;
+
+        int enemiesAct;
+        {
+            PROFILE_SCOPE(PHASE_PLAYER_MOVE);
+            enemiesAct = applyPlayerCommand(world, move);
+        }
+        if (enemiesAct && world->status == GAME_RUNNING) {
+            moveEnemies(world);
+            advanceStatusEffects(world, ENEMY_TICKS_PER_TURN);
+
+            PROFILE_SCOPE(PHASE_COMBAT);
+            resolveEncounters(world, chooseAction, context);
+        }
+        reloadMap(world);
+    }
+    PROFILE_END_TURN();
+}
 
+void moveEnemies(GameWorld* world) {
+    PROFILE_SCOPE(PHASE_ENEMY_MOVE);
+    PROFILE_COUNT(COUNTER_ENTITIES, world->enemyCount);
+    advanceEnemies(world, ENEMY_TICKS_PER_TURN);
+}
+
+// Usuwa przeciwnika z tablicy, kolejki ruchow, kola efektow i pol wplywu
+void removeEnemy(GameWorld* world, int index) {
+    Enemy* enemy = world->enemies[index];
+    stampInfluence(world, INFLUENCE_THREAT, enemy->EposX, enemy->EposY, -enemy->attack);
+    unscheduleEnemy(world, index);
+    removeEnemyEffects(world, index);
+    freeWorldObject(&world->clone, world->enemies[index]);
+    for (int j = index; j < world->enemyCount - 1; j++) {
+        world->enemies[j] = world->enemies[j + 1];
+    }
+    world->enemyCount--;
+}
+
+int isMenuCommand(char move) {
+#ifdef GRA_PROFILE
+    if (move == 'r' || move == 'R') return 1;
+#endif
+    return move == 'i' || move == 'I' || move == 'q' || move == 'Q' || move == 'z' || move == 'Z';
+}
+
+// Polecenia interfejsu, ktore nie zmieniaja stanu symulacji
+int handleMenuCommand(GameWorld* world, char move) {
     if (move == 'i' || move == 'I') {
         inventoryMenu(world);
-        return;
+        return 1;
     }
     else if (move == 'q' || move == 'Q') {
+        presentEvents(world);
+        printEventStats(&sessionStats);
         freeGameWorld(world);
         exit(0);
     }
     else if (move == 'z' || move == 'Z') {
         saveGame(world);
-        return;
+        return 1;
     }
-    else if (move == 'p' || move == 'P') {
-        for (int i = 0; i < world->groundItemCount; i++) {
-            if (world->player->posX == world->groundItems[i]->posX &&
-                world->player->posY == world->groundItems[i]->posY) {
-
-                Item* newItem = (Item*)malloc(sizeof(Item));
-                if (!newItem) {
-                    printf("Błąd alokacji pamięci dla przedmiotu!\n");
-                    Sleep(1000);
-                    return;
-                }
-                memcpy(newItem, world->groundItems[i], sizeof(Item));
-
-                int added = 0;
-                for (int y = 0; y < world->player->inventory->height && !added; y++) {
-                    for (int x = 0; x < world->player->inventory->width && !added; x++) {
-                        if (canPlaceItem(world->player->inventory, newItem, x, y)) {
-                            if (addItemToInventory(world->player->inventory, newItem, x, y)) {
-                                printf("Podniesiono %s!\n", newItem->name);
-                                added = 1;
-                                
-                                free(world->groundItems[i]);
-                                for (int j = i; j < world->groundItemCount - 1; j++) {
-                                    world->groundItems[j] = world->groundItems[j + 1];
-                                }
-                                world->groundItemCount--;
-                            }
-                        }
-                    }
-                }
+#ifdef GRA_PROFILE
+    else if (move == 'r' || move == 'R') {
+        clearScreen();
+        printProfileReport(stdout);
+        printf("\nNacisnij Enter, aby kontynuowac...");
+        while (getchar() != '\n');
+        return 1;
+    }
+#endif
+    return 0;
+}
 
-                if (!added) {
-                    printf("Nie masz miejsca w ekwipunku na %s!\n", newItem->name);
-                    free(newItem); 
-                }
+// Wykonuje polecenie gracza. Zwraca 1, gdy tura toczy sie dalej
+// (ruch przeciwnikow i walka), 0 gdy polecenie konczy ture.
+int applyPlayerCommand(GameWorld* world, char move) {
+    if (move == 'p' || move == 'P') {
+        int index = groundItemAt(world, world->player->posX, world->player->posY);
+        if (index < 0) {
+            emitEvent(world, EVENT_NOTHING_TO_PICK_UP, STRING_NONE, 0, 0);
+            return 0;
+        }
 
-                Sleep(1000);
-                reloadMap(world);
-                return;
+        // Przedmiot przechodzi z ziemi do ekwipunku bez kopiowania
+        Item* item = world->groundItems[index];
+        int x, y;
+        if (findInventorySpace(world->player->inventory, item, &x, &y)) {
+            takeItemFromGround(world, index);
+            if (addItemToInventory(world->player->inventory, item, x, y)) {
+                emitEvent(world, EVENT_ITEM_PICKED_UP, item->name, 0, 0);
+                return 0;
             }
+            // Miejsce jest, ale indeks ekwipunku nie dostal pamieci -
+            // przedmiot wraca na ziemie pod gracza
+            StringId name = item->name;
+            addItemToGround(world, item, world->player->posX, world->player->posY);
+            emitEvent(world, EVENT_INVENTORY_FULL, name, 0, 0);
         }
-        printf("Nie ma przedmiotu do podniesienia!\n");
-        Sleep(1000);
-        return;
+        else {
+            emitEvent(world, EVENT_INVENTORY_FULL, item->name, 0, 0);
+        }
+        return 0;
     }
 
     // Ruch gracza
@@ -1063,262 +1517,142 @@ void movePlayerAndEnemy(GameWorld* world) {
         // Sprawdź portal
         if (world->portalActive && world->player->posX == world->portalX && world->player->posY == world->portalY) {
             nextLevel(world);
-            return;
+            return 0;
         }
 
         checkTraps(world);
     }
 
-    // Ruch przeciwników
-    for (int i = 0; i < world->enemyCount; i++) {
-        if (rand() % 2) moveEnemy(world->enemies[i]);
-    }
+    return 1;
+}
 
-    // Walka z przeciwnikami
+int playerMeetsEnemy(GameWorld* world) {
     for (int i = 0; i < world->enemyCount; i++) {
         if (world->player->posX == world->enemies[i]->EposX &&
             world->player->posY == world->enemies[i]->EposY) {
+            return 1;
+        }
+    }
+    return 0;
+}
 
-            printf("Znalazles przeciwnika: %s!\n", world->enemies[i]->name);
-            if (battle(world->player, world->enemies[i], world)) {
-                // Szansa na drop przedmiotu
-                int dropChance = rand() % 100;
-                Item* droppedItem = NULL;
-
-                if (dropChance < 90) {
-                    int itemType = rand() % 100;
-                    Item* droppedItem = NULL;
-
-                    if (itemType < 60) {
-                        droppedItem = createHealthPotion();
-                        printf("Przeciwnik upuscil miksture zdrowia!\n");
-                    }
-                    else if (itemType < 90) {
-                        droppedItem = createSword();
-                        printf("Przeciwnik upuscil miecz!\n");
-                    }
-                    else {
-                        droppedItem = createArmor();
-                        printf("Przeciwnik upuscil zbroje!\n");
-                    }
+// Szansa na drop przedmiotu po wygranej walce
+void dropLoot(GameWorld* world) {
+    if (randomInt(&world->random, 100) >= world->balance.dropChance) {
+        emitEvent(world, EVENT_ITEM_DROPPED, STRING_NONE, 0, EVENT_FLAG_NO_ITEM);
+        return;
+    }
 
-                    int added = 0;
-                    for (int y = 0; y < world->player->inventory->height && !added; y++) {
-                        for (int x = 0; x < world->player->inventory->width && !added; x++) {
-                            if (canPlaceItem(world->player->inventory, droppedItem, x, y)) {
-                                if (addItemToInventory(world->player->inventory, droppedItem, x, y)) {
-                                    printf("Zdobyto %s!\n", droppedItem->name);
-                                    added = 1;
-                                }
-                            }
-                        }
-                    }
+    int itemType = randomInt(&world->random, 100);
+    Item* droppedItem = NULL;
 
-                    if (!added) {
-                        Item* groundItem = (Item*)malloc(sizeof(Item));
-                        if (groundItem) {
-                            memcpy(groundItem, droppedItem, sizeof(Item));
-                            addItemToGround(world, groundItem, world->player->posX, world->player->posY);
-                            printf("Położono %s na ziemi (brak miejsca w ekwipunku).\n", groundItem->name);
-                        }
-                        free(droppedItem);
-                    }
-                }
-                else {
-                    printf("Przeciwnik nie upuscil zadnych przedmiotow.\n");
-                }
+    if (itemType < 45) {
+        droppedItem = createHealthPotion();
+    }
+    else if (itemType < 52) {
+        droppedItem = createRegenerationPotion();
+    }
+    else if (itemType < 60) {
+        droppedItem = createStrengthPotion();
+    }
+    else if (itemType < 90) {
+        droppedItem = createSword(&world->random);
+    }
+    else {
+        droppedItem = createArmor(&world->random);
+    }
 
-                // Usuń pokonanego przeciwnika
-                free(world->enemies[i]);
-                for (int j = i; j < world->enemyCount - 1; j++) {
-                    world->enemies[j] = world->enemies[j + 1];
-                }
-                world->enemyCount--;
-                i--; 
+    int x, y;
+    if (findInventorySpace(world->player->inventory, droppedItem, &x, &y) &&
+        addItemToInventory(world->player->inventory, droppedItem, x, y)) {
+        emitEvent(world, EVENT_ITEM_DROPPED, droppedItem->name, 0, EVENT_FLAG_IN_INVENTORY);
+        return;
+    }
 
-                Sleep(2000);
-            }
-        }
+    // Swiat przejmuje przedmiot; przy pelnej ziemi zostaje on zwolniony
+    StringId name = droppedItem->name;
+    if (addItemToGround(world, droppedItem, world->player->posX, world->player->posY)) {
+        emitEvent(world, EVENT_ITEM_DROPPED, name, 0, EVENT_FLAG_ON_GROUND);
+    }
+    else {
+        emitEvent(world, EVENT_ITEM_DROPPED, name, 0, EVENT_FLAG_LOST);
     }
-    reloadMap(world);
 }
 
-void saveGame(GameWorld* world) {
-    FILE* file;
-    if (fopen_s(&file, "savegame.dat", "wb") != 0) {
-        printf("Nie mozna otworzyc pliku do zapisu!\n");
-        Sleep(1000);
-        return;
-    }
+// Walka z przeciwnikami stojacymi na polu gracza
+void resolveEncounters(GameWorld* world, BattleActionFunction chooseAction, void* context) {
+    for (int i = 0; i < world->enemyCount; i++) {
+        if (world->player->posX == world->enemies[i]->EposX &&
+            world->player->posY == world->enemies[i]->EposY) {
 
-    // Zapisz podstawowe informacje o swiecie
-    fwrite(&world->level, sizeof(int), 1, file);
-    fwrite(&world->enemiesDefeated, sizeof(int), 1, file);
-    fwrite(&world->portalActive, sizeof(int), 1, file);
-    fwrite(&world->portalX, sizeof(int), 1, file);
-    fwrite(&world->portalY, sizeof(int), 1, file);
-    fwrite(&world->totalEnemiesDefeated, sizeof(int), 1, file);
-    fwrite(&world->enemyCount, sizeof(int), 1, file);
-    fwrite(&world->trapCount, sizeof(int), 1, file);
-
-    // Zapisz dane gracza
-    fwrite(world->player->name, sizeof(char), 50, file);
-    fwrite(&world->player->health, sizeof(int), 1, file);
-    fwrite(&world->player->max_health, sizeof(int), 1, file);
-    fwrite(&world->player->attack, sizeof(int), 1, file);
-    fwrite(&world->player->defense, sizeof(int), 1, file);
-    fwrite(&world->player->posX, sizeof(int), 1, file);
-    fwrite(&world->player->posY, sizeof(int), 1, file);
-    fwrite(&world->player->gold, sizeof(int), 1, file);
-
-    // Zapisz ekwipunek
-    Inventory* inv = world->player->inventory;
-    fwrite(&inv->width, sizeof(int), 1, file);
-    fwrite(&inv->height, sizeof(int), 1, file);
-
-    // Zapisz przedmioty w ekwipunku
-    int itemCount = 0;
-    for (int y = 0; y < inv->height; y++) {
-        for (int x = 0; x < inv->width; x++) {
-            if (inv->items[y][x] != NULL && inv->items[y][x]->posX == x && inv->items[y][x]->posY == y) {
-                itemCount++;
+            emitEvent(world, EVENT_ENCOUNTER, world->enemies[i]->name, 0, 0);
+            BattleResult result = battle(world, world->enemies[i], chooseAction, context);
+            if (result == BATTLE_LOST) {
+                return;
             }
-        }
-    }
-    fwrite(&itemCount, sizeof(int), 1, file);
+            if (result == BATTLE_WON) {
+                dropLoot(world);
 
-    for (int y = 0; y < inv->height; y++) {
-        for (int x = 0; x < inv->width; x++) {
-            Item* item = inv->items[y][x];
-            if (item != NULL && item->posX == x && item->posY == y) {
-                fwrite(item, sizeof(Item), 1, file);
+                // Usuń pokonanego przeciwnika
+                removeEnemy(world, i);
+                i--; 
             }
         }
     }
+}
 
-    // Zapisz przeciwnikow
-    for (int i = 0; i < world->enemyCount; i++) {
-        fwrite(world->enemies[i], sizeof(Enemy), 1, file);
+// Z autozapisem pelny zapis trafia do watku zapisu i gra nie czeka na dysk.
+// Wynik zapisu jest zdarzeniem - bledy zapisu w tle zglasza pozniej journalTurn.
+void saveGame(GameWorld* world) {
+    int saved;
+    if (world->journal) {
+        saved = compactSaveJournal(world->journal, world);
     }
+    else {
+        char savePath[64];
+        char journalPath[64];
+        saveSlotPath(world->saveSlot, savePath, sizeof(savePath));
+        journalSlotPath(world->saveSlot, journalPath, sizeof(journalPath));
 
-    // Zapisz pulapki
-    for (int i = 0; i < world->trapCount; i++) {
-        fwrite(world->traps[i], sizeof(Trap), 1, file);
+        // Dziennik poprzedniego zapisu nie pasuje do nowego
+        world->saveGeneration++;
+        removeSaveJournal(journalPath);
+        saved = writeSaveFile(world, savePath) && updateSaveIndex(world);
     }
-
-    fclose(file);
-    printf("Gra zapisana pomyslnie!\n");
-    Sleep(1000);
+    emitEvent(world, EVENT_GAME_SAVED, STRING_NONE, world->saveGeneration, saved ? EVENT_FLAG_SUCCESS : 0);
 }
 
-GameWorld* loadGame() {
+GameWorld* loadGame(int slot) {
+    char savePath[64];
+    char journalPath[64];
+    saveSlotPath(slot, savePath, sizeof(savePath));
+    journalSlotPath(slot, journalPath, sizeof(journalPath));
+
     FILE* file;
-    if (fopen_s(&file, "savegame.dat", "rb") != 0) {
+    if (fopen_s(&file, savePath, "rb") != 0) {
         printf("Nie znaleziono zapisu gry!\n");
         Sleep(1000);
         return NULL;
     }
+    fclose(file);
 
-    GameWorld* world = (GameWorld*)malloc(sizeof(GameWorld));
+    GameWorld* world = readSaveFile(savePath);
     if (!world) {
-        printf("Blad alokacji pamieci dla swiata gry\n");
-        fclose(file);
+        printf("Nieobslugiwany format zapisu gry!\n");
+        Sleep(1000);
         return NULL;
     }
+    world->saveSlot = slot;
+    SaveIndex index;
+    readSaveIndex(&index);
+    snprintf(world->saveSlotName, sizeof(world->saveSlotName), "%.*s", SAVE_SLOT_NAME_LENGTH - 1,
+        index.slots[slot].used ? index.slots[slot].slotName : world->player->name);
 
-    // Inicjalizuj wszystkie pola na NULL/0
-    memset(world, 0, sizeof(GameWorld));
-
-    // Wczytaj podstawowe informacje o swiecie
-    fread(&world->level, sizeof(int), 1, file);
-    fread(&world->enemiesDefeated, sizeof(int), 1, file);
-    fread(&world->portalActive, sizeof(int), 1, file);
-    fread(&world->portalX, sizeof(int), 1, file);
-    fread(&world->portalY, sizeof(int), 1, file);
-    fread(&world->totalEnemiesDefeated, sizeof(int), 1, file);
-    fread(&world->enemyCount, sizeof(int), 1, file);
-    fread(&world->trapCount, sizeof(int), 1, file);
-
-    // Wczytaj gracza
-    world->player = (Player*)malloc(sizeof(Player));
-    fread(world->player->name, sizeof(char), 50, file);
-    fread(&world->player->health, sizeof(int), 1, file);
-    fread(&world->player->max_health, sizeof(int), 1, file);
-    fread(&world->player->attack, sizeof(int), 1, file);
-    fread(&world->player->defense, sizeof(int), 1, file);
-    fread(&world->player->posX, sizeof(int), 1, file);
-    fread(&world->player->posY, sizeof(int), 1, file);
-    fread(&world->player->gold, sizeof(int), 1, file);
-
-    // Wczytaj ekwipunek
-    int invWidth, invHeight;
-    fread(&invWidth, sizeof(int), 1, file);
-    fread(&invHeight, sizeof(int), 1, file);
-    world->player->inventory = createInventory(invWidth, invHeight);
-
-    // Wczytaj przedmioty
-    int itemCount;
-    fread(&itemCount, sizeof(int), 1, file);
-    for (int i = 0; i < itemCount; i++) {
-        Item* item = (Item*)malloc(sizeof(Item));
-        fread(item, sizeof(Item), 1, file);
-        addItemToInventory(world->player->inventory, item, item->posX, item->posY);
-    }
-
-    // Wczytaj przeciwnikow
-    world->enemies = (Enemy**)malloc(world->enemyCount * sizeof(Enemy*));
-    for (int i = 0; i < world->enemyCount; i++) {
-        world->enemies[i] = (Enemy*)malloc(sizeof(Enemy));
-        fread(world->enemies[i], sizeof(Enemy), 1, file);
+    int replayed = replaySaveJournal(world, journalPath);
+    if (replayed > 0) {
+        printf("Odtworzono %d tur z dziennika autozapisu.\n", replayed);
     }
-
-    // Wczytaj pulapki
-    world->traps = (Trap**)malloc(world->trapCount * sizeof(Trap*));
-    for (int i = 0; i < world->trapCount; i++) {
-        world->traps[i] = (Trap*)malloc(sizeof(Trap));
-        fread(world->traps[i], sizeof(Trap), 1, file);
-    }
-
-    // Inicjalizacja mapy
-    initMap(world);
-    reloadMap(world);
-
-    fclose(file);
     printf("Gra wczytana pomyslnie!\n");
     Sleep(1000);
     return world;
 }
-
-int main() {
-    srand((unsigned)time(NULL));
-    GameWorld* world = NULL;
-
-    printf("1. Nowa gra\n2. Wczytaj gre\nWybierz: ");
-    int choice;
-    scanf_s("%d", &choice);
-    while (getchar() != '\n');
-
-    if (choice == 1) {
-        world = createGameWorld();
-    }
-    else if (choice == 2) {
-        world = loadGame();
-        if (world == NULL) {
-            printf("Tworzenie nowej gry...\n");
-            Sleep(1000);
-            world = createGameWorld();
-        }
-    }
-    else {
-        printf("Nieprawidlowy wybor. Tworzenie nowej gry...\n");
-        Sleep(1000);
-        world = createGameWorld();
-    }
-
-    while (1) {
-        printMap(world);
-        movePlayerAndEnemy(world);
-    }
-
-    return 0;
-}
@@ -0,0 +1,635 @@
+﻿#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "platform.h"
+#include "profiler.h"
+#include "memtrack.h"
+#include "savewriter.h"
+
+// Rozmiary swiata mozna nadpisac przy kompilacji (np. konfiguracje benchmarkow)
+#ifndef MAP_HEIGHT
+#define MAP_HEIGHT 12
+#endif
+#ifndef MAP_WIDTH
+#define MAP_WIDTH 10
+#endif
+#ifndef MAX_ENEMIES
+#define MAX_ENEMIES 5
+#endif
+#ifndef MAX_TRAPS
+#define MAX_TRAPS 12
+#endif
+#ifndef INVENTORY_WIDTH
+#define INVENTORY_WIDTH 10
+#endif
+#ifndef INVENTORY_HEIGHT
+#define INVENTORY_HEIGHT 10
+#endif
+#ifndef MAX_GROUND_ITEMS
+#define MAX_GROUND_ITEMS 10
+#endif
+#define MAX_PLAYERS 512  // Gracze jednego swiata (serwer wieloosobowy)
+
+#define MAX_INTERNED_STRINGS 256
+#define STRING_POOL_SIZE 4096
+#define STRING_HASH_SIZE 512  // potega dwojki, co najmniej 2x MAX_INTERNED_STRINGS
+
+#define SAVE_MAGIC 0x47505247  // "GRPG"
+#define SAVE_VERSION 6
+#define SAVE_SLOT_COUNT 5
+#define SAVE_SLOT_NAME_LENGTH 32
+#define SAVE_SLOT_PATH "savegame%d.dat"
+#define JOURNAL_SLOT_PATH "savegame%d.jnl"  // Zmiany z kolejnych tur od ostatniego pelnego zapisu
+#define SAVE_INDEX_PATH "savegame.idx"   // Spis slotow - menu nie musi otwierac zapisow
+#define SAVE_INDEX_MAGIC 0x58444947      // "GIDX"
+#define SAVE_INDEX_VERSION 1
+
+// Generator liczb losowych swiata (splitmix64). Kazdy swiat ma wlasny stan,
+// wiec swiaty w roznych watkach nie dziela rand() i z tym samym ziarnem
+// przebiegaja tak samo niezaleznie od watku.
+typedef struct {
+    unsigned long long state;
+} RandomState;
+
+static inline void seedRandom(RandomState* random, unsigned long long seed) {
+    random->state = seed;
+}
+
+static inline unsigned long long nextRandom64(RandomState* random) {
+    unsigned long long z = (random->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Liczba z [0, bound) - odpowiednik rand() % bound
+static inline int randomInt(RandomState* random, int bound) {
+    return (int)((nextRandom64(random) >> 33) % (unsigned int)bound);
+}
+
+typedef int (*AttackFunction)(int attack, int defense, RandomState* random);
+
+// Identyfikator napisu w tablicy internowanych napisow
+typedef unsigned int StringId;
+#define STRING_NONE ((StringId)0xFFFFFFFFu)  // Brak napisu (np. zdarzenie bez nazwy)
+
+// Napisy wbudowane - internowane przy starcie w tej kolejnosci,
+// wiec ich identyfikatory sa stale i moga trafic do pliku zapisu
+typedef enum {
+    STR_HEALTH_POTION,
+    STR_LONG_SWORD,
+    STR_PLATE_ARMOR,
+    STR_GOBLIN,
+    STR_ORK,
+    STR_TRAP_SPIKES,
+    STR_TRAP_BOULDERS,
+    STR_STRENGTH_POTION,
+    STR_REGENERATION_POTION,
+    STR_POISON,
+    STR_BLEEDING,
+    STR_REGENERATION,
+    STR_STRENGTH,
+    STR_BUILTIN_COUNT
+} BuiltinString;
+
+typedef struct {
+    char pool[STRING_POOL_SIZE];   // Wszystkie napisy jeden za drugim, zakonczone '\0'
+    int poolUsed;
+    int offsets[MAX_INTERNED_STRINGS];
+    int count;
+    int hash[STRING_HASH_SIZE];    // Indeks napisu + 1 (0 - pusty kubelek)
+} StringTable;
+
+typedef enum {
+    ITEM_POTION,
+    ITEM_SWORD,
+    ITEM_ARMOR,
+    ITEM_CATEGORY_COUNT
+} ItemCategory;
+
+typedef struct {
+    StringId name;
+    ItemCategory category;
+    int posX;
+    int posY;
+    int attackBonus;
+    int defenseBonus;
+    int healthBonus;
+    unsigned char width;
+    unsigned char height;
+    char symbol;
+    unsigned char inInventory;
+} Item;
+
+// Sloty wyposazenia gracza
+typedef enum {
+    EQUIP_WEAPON,
+    EQUIP_ARMOR,
+    EQUIP_SLOT_COUNT
+} EquipSlot;
+
+typedef enum {
+    ITEM_NOT_USED,
+    ITEM_CONSUMED,
+    ITEM_EQUIPPED,
+    ITEM_UNEQUIPPED
+} ItemUseResult;
+
+// Jeden blok pamieci klonu swiata (cloneGameWorld). Obiekty skopiowane przy
+// klonowaniu leza w bloku i nie sa zwalniane pojedynczo - blok znika razem
+// ze swiatem. Obiekty utworzone w klonie pozniej sa zwyklymi alokacjami.
+typedef struct {
+    char* start;  // NULL - zwykly swiat
+    size_t size;
+} CloneBlock;
+
+static inline void freeWorldObject(const CloneBlock* block, void* ptr) {
+    if (block->start && (char*)ptr >= block->start && (char*)ptr < block->start + block->size) return;
+    trackedFree(ptr);
+}
+
+// Przedmioty jednej kategorii w ekwipunku rosnaco wedlug premii (itemRank),
+// przy rownych wedlug pola - najlepszy na koncu. Zapytania bez przegladania
+// siatki; dodanie i zdjecie przedmiotu to wyszukiwanie binarne i przesuniecie.
+typedef struct {
+    Item** items;
+    int count;
+    int capacity;
+} InventoryIndex;
+
+typedef struct {
+    int width;
+    int height;
+    int** slots;  // Macierz slotow (0 - wolny, 1 - zajety)
+    Item*** items;
+    unsigned int* rowMask;  // Zajetosc wierszy jako maski bitowe (NULL gdy width > 32)
+    CloneBlock clone;       // Blok klonu, w ktorym lezy ekwipunek (pusty poza klonem)
+    InventoryIndex index[ITEM_CATEGORY_COUNT];  // Utrzymywany przez addItemToInventory/detachItemFromInventory
+} Inventory;
+
+// Operacje rozmieszczania przedmiotu o danym ksztalcie w ekwipunku.
+// Pozycja jest juz sprawdzona pod katem granic ekwipunku.
+typedef int (*CanPlaceFunction)(const Inventory* inv, const Item* item, int x, int y);
+typedef int (*FindSpaceFunction)(const Inventory* inv, const Item* item, int* outX, int* outY);
+typedef void (*PlaceFunction)(Inventory* inv, Item* item, int x, int y);
+typedef void (*ClearFunction)(Inventory* inv, const Item* item, int x, int y);
+
+typedef struct {
+    int width;
+    int height;
+    CanPlaceFunction canPlace;
+    FindSpaceFunction findSpace;
+    PlaceFunction place;
+    ClearFunction clear;
+} ItemShapeOps;
+
+typedef struct {
+    char name[50];
+    int health;
+    // Statystyki pochodne = bazowe + premie z wyposazenia.
+    // Aktualizowane przyrostowo przy zakladaniu/zdejmowaniu przedmiotow.
+    int max_health;
+    int attack;
+    int defense;
+    int base_max_health;
+    int base_attack;
+    int base_defense;
+    int posX;
+    int posY;
+    int gold;
+    Inventory* inventory;
+    Item* equipment[EQUIP_SLOT_COUNT];  // Zalozone przedmioty (leza tez w ekwipunku)
+    int effect_attack;  // Premia z efektow statusu - poza statystykami pochodnymi, nie trafia do zapisu gracza
+} Player;
+
+typedef struct {
+    StringId name;
+    int health;
+    int attack;
+    int defense;
+    int EposX;
+    int EposY;
+    int prevX;      // Pozycja z poprzedniego ticku (interpolacja w trybie czasu rzeczywistego)
+    int prevY;
+    int moveDelay;  // Co ile tickow zegara przeciwnikow sie rusza (szybkosc)
+    int moveTimer;  // Tick zegara kolejki nastepnego ruchu; kolejka aktualizuje go po kazdym ruchu
+} Enemy;
+
+typedef struct {
+    int posX;
+    int posY;
+    int damage;
+    int discovered;
+    StringId description;
+} Trap;
+
+// Zdarzenia rozgrywki. Logika gry nie wypisuje niczego sama - wrzuca zdarzenia
+// do bufora cyklicznego swiata, a renderery, logi i statystyki czytaja je pozniej.
+typedef enum {
+    EVENT_ENCOUNTER,          // name - przeciwnik
+    EVENT_DAMAGE_DEALT,       // name - przeciwnik, value - obrazenia, flagi: kierunek, krytyk
+    EVENT_FLEE_ATTEMPT,       // name - przeciwnik, EVENT_FLAG_SUCCESS gdy sie udalo
+    EVENT_ENEMY_DEFEATED,     // name - przeciwnik, value - zdobyte zloto
+    EVENT_ITEM_DROPPED,       // name - przedmiot, flagi: gdzie trafil
+    EVENT_ITEM_PICKED_UP,     // name - przedmiot
+    EVENT_INVENTORY_FULL,     // name - przedmiot, ktory sie nie zmiescil
+    EVENT_NOTHING_TO_PICK_UP,
+    EVENT_TRAP_TRIGGERED,     // name - opis pulapki, value - obrazenia
+    EVENT_PORTAL_OPENED,      // x, y - pozycja portalu
+    EVENT_LEVEL_CHANGED,      // value - nowy poziom
+    EVENT_PLAYER_DIED,        // name - przeciwnik lub pulapka, ktora zabila gracza
+    EVENT_GAME_WON,           // value - ukonczony poziom
+    EVENT_GAME_SAVED,         // value - numer zapisu, EVENT_FLAG_SUCCESS gdy sie udal
+    EVENT_STATUS_APPLIED,     // name - efekt, value - czas trwania w turach
+    EVENT_STATUS_TICK,        // name - efekt, value - zmiana zdrowia gracza
+    EVENT_STATUS_EXPIRED,     // name - efekt
+    EVENT_TYPE_COUNT
+} GameEventType;
+
+#define EVENT_FLAG_CRITICAL     0x01  // Atak krytyczny
+#define EVENT_FLAG_TO_PLAYER    0x02  // Obrazenia zadane graczowi (domyslnie przez gracza)
+#define EVENT_FLAG_SUCCESS      0x04
+#define EVENT_FLAG_IN_INVENTORY 0x08  // Przedmiot trafil do ekwipunku
+#define EVENT_FLAG_ON_GROUND    0x10  // Przedmiot polozono na ziemi
+#define EVENT_FLAG_LOST         0x20  // Przedmiot przepadl
+#define EVENT_FLAG_BY_TRAP      0x40  // Smierc od pulapki
+#define EVENT_FLAG_NO_ITEM      0x80  // Przeciwnik nic nie upuscil
+
+typedef struct {
+    GameEventType type;
+    int turn;
+    int value;
+    int x;
+    int y;
+    StringId name;
+    int flags;
+} GameEvent;
+
+#define EVENT_QUEUE_SIZE 256  // potega dwojki
+
+typedef struct EventQueue EventQueue;
+
+typedef void (*EventHandler)(const GameEvent* event, void* context);
+
+typedef struct {
+    EventHandler handle;
+    void* context;
+} EventSubscriber;
+
+// Statystyki zbierane z zdarzen przez collectEventStats
+typedef struct {
+    int counts[EVENT_TYPE_COUNT];
+    int damageDealt;
+    int damageTaken;
+    int criticalHits;
+    int goldEarned;
+} EventStats;
+
+typedef enum {
+    GAME_RUNNING,
+    GAME_LOST,
+    GAME_WON
+} GameStatus;
+
+typedef enum {
+    BATTLE_ATTACK = 1,
+    BATTLE_FLEE = 2
+} BattleAction;
+
+typedef enum {
+    BATTLE_CONTINUE,
+    BATTLE_WON,
+    BATTLE_FLED,
+    BATTLE_LOST
+} BattleResult;
+
+typedef struct GameWorld GameWorld;
+typedef struct SaveJournal SaveJournal;
+
+#define ENEMY_TICKS_PER_TURN 2  // Tura gracza trwa tyle tickow zegara przeciwnikow
+
+// Nastepny ruch przeciwnika o indeksie enemy w world->enemies
+typedef struct {
+    long long tick;
+    int enemy;
+} EnemyTurn;
+
+// Przeciwnicy wedlug ticku nastepnego ruchu (kopiec 4-arny). Zegar rusza
+// tylko tych, na ktorych przyszla kolej - koszt O(log n) na ruch zamiast
+// przegladania wszystkich przeciwnikow co ture.
+typedef struct {
+    EnemyTurn* heap;
+    int count;
+    int capacity;
+    long long clock;  // Biezacy tick, od 0 na poczatku poziomu
+    int valid;        // 0 - do odbudowy z moveTimer przeciwnikow (nowy poziom, wczytanie)
+} EnemySchedule;
+
+typedef enum {
+    EFFECT_POISON,        // Obrazenia co okres
+    EFFECT_BLEEDING,      // Obrazenia co okres
+    EFFECT_REGENERATION,  // Leczenie co okres
+    EFFECT_STRENGTH,      // Premia do ataku gracza na czas trwania
+    EFFECT_TYPE_COUNT
+} StatusEffectType;
+
+#define EFFECT_WHEEL_BITS 6
+#define EFFECT_WHEEL_SLOTS (1 << EFFECT_WHEEL_BITS)
+#define EFFECT_WHEEL_LEVELS 3  // Zasieg kola: 64^3 tickow
+
+// Aktywny efekt statusu. Wezly leza w puli swiata i sa laczone indeksami + 1
+// (0 - koniec listy) w listy przegrodek kola (next/prev) oraz w listy
+// efektow swojego celu (targetNext/targetPrev).
+typedef struct {
+    unsigned char type;     // StatusEffectType
+    unsigned char onEnemy;  // 1 - cel to world->enemies[target], 0 - world->players[target]
+    unsigned char active;
+    short slot;             // Przegrodka kola (poziom * EFFECT_WHEEL_SLOTS + indeks)
+    int target;
+    int magnitude;          // Zdrowie na okres albo premia do statystyki
+    int period;             // Ticki miedzy dzialaniami
+    int remaining;          // Pozostale dzialania
+    long long due;          // Tick nastepnego dzialania
+    int next;
+    int prev;
+    int targetNext;
+    int targetPrev;
+} StatusEffect;
+
+// Efekty statusu wszystkich postaci swiata w hierarchicznym kole czasowym.
+// Tick przeglada jedna przegrodke najnizszego poziomu; wyzsze poziomy
+// zsypuja sie nizej co 64 (i 4096) tickow - koszt nie zalezy od liczby
+// efektow, ktore tego ticku nic nie robia.
+typedef struct {
+    StatusEffect* pool;
+    int capacity;
+    int count;
+    int freeList;  // Indeks + 1 pierwszego wolnego wezla
+    long long clock;
+    int wheel[EFFECT_WHEEL_LEVELS][EFFECT_WHEEL_SLOTS];  // Indeks + 1 pierwszego wezla przegrodki
+    int* targetHeads[2];    // [onEnemy][target] - indeks + 1 pierwszego efektu celu
+    int targetCapacity[2];
+} StatusEffects;
+
+typedef enum {
+    INFLUENCE_THREAT,  // Atak przeciwnikow
+    INFLUENCE_DANGER,  // Obrazenia nieodkrytych pulapek
+    INFLUENCE_LOOT,    // Wartosc przedmiotow na ziemi
+    INFLUENCE_FIELD_COUNT
+} InfluenceField;
+
+#define INFLUENCE_RADIUS 3  // Zasieg wplywu encji w polach
+
+// Pola wplywu poziomu: kazda encja dodaje wokol siebie swoja wartosc razy
+// wage malejaca z odlegloscia. Ruch encji odejmuje jej stempel ze starego
+// miejsca i dodaje w nowym; od zera pola sa liczone tylko po zmianie poziomu.
+typedef struct {
+    int* fields[INFLUENCE_FIELD_COUNT];  // MAP_HEIGHT * MAP_WIDTH, wiersz po wierszu
+    int* scratch;                         // Dwie siatki robocze przebudowy
+    int valid;                            // 0 - do przebudowy (nowy poziom, wczytanie)
+} InfluenceMaps;
+
+// Stale balansu rozgrywki. Domyslne wartosci (defaultBalance) to reczne
+// ustawienia gry; graRPG10_tune dobiera je symulacjami.
+typedef struct {
+    int enemyHealthPerLevel;   // Premia zdrowia przeciwnika za kazdy poziom
+    int enemyAttackPerLevel;
+    int enemyDefensePerLevel;
+    int trapDamagePerLevel;
+    int dropChance;            // Szansa na lup po pokonaniu przeciwnika w procentach
+} BalanceConfig;
+
+typedef struct LevelPrefetch LevelPrefetch;
+
+// Zawartosc poziomu poza mapa i graczami - budowana przed wejsciem na poziom
+typedef struct {
+    int level;                      // 0 - brak zawartosci
+    Enemy** enemies;
+    int enemyCount;
+    Trap** traps;
+    int trapCount;
+    Item* items[MAX_GROUND_ITEMS];  // Przedmioty na ziemi, pozycje w posX/posY
+    int itemCount;
+} LevelContent;
+
+// Wpis spisu zapisow - tyle, ile potrzeba do pokazania slotu w menu
+typedef struct {
+    int used;
+    char slotName[SAVE_SLOT_NAME_LENGTH];
+    char playerName[50];
+    int level;
+    int gold;
+    long long timestamp;  // Czas zapisu (time_t)
+} SaveSlotInfo;
+
+typedef struct {
+    SaveSlotInfo slots[SAVE_SLOT_COUNT];
+} SaveIndex;
+
+// Zrodlo decyzji w walce - gracz przy klawiaturze albo strategia automatyczna
+typedef BattleAction (*BattleActionFunction)(GameWorld* world, Enemy* enemy, int round, void* context);
+
+struct GameWorld {
+    Player* player;  // Aktywny gracz - jego dotycza polecenia, pulapki i walki
+    Player** players;  // Wszyscy gracze swiata (players[0] w grze jednoosobowej)
+    int playerCount;
+    int playerCapacity;
+    Enemy** enemies;
+    int enemyCount;
+    Trap** traps;
+    int trapCount;
+    char** map;
+    int enemiesDefeated;
+    int level;
+    int portalX;
+    int portalY;
+    int portalActive;
+    int totalEnemiesDefeated;
+    Item** groundItems;
+    int groundItemCount;
+    GameStatus status;
+    int turn;
+    EventQueue* events;  // NULL - zdarzenia wylaczone (np. symulacje bez renderera)
+    SaveJournal* journal;  // NULL - bez autozapisu
+    int saveGeneration;    // Numer pelnego zapisu - dziennik pasuje tylko do swojego zapisu
+    int saveSlot;          // Slot, do ktorego trafiaja zapisy tej gry
+    char saveSlotName[SAVE_SLOT_NAME_LENGTH];
+    CloneBlock clone;      // Pusty poza klonem swiata
+    LevelPrefetch* prefetch;  // NULL - nastepny poziom budowany dopiero w nextLevel
+    RandomState random;    // Wszystkie losowania symulacji tego swiata
+    EnemySchedule schedule;  // Kolejnosc ruchow przeciwnikow
+    StatusEffects effects;   // Trucizny, krwawienia i premie z mikstur
+    InfluenceMaps influence; // Zagrozenie, pulapki i lup - ruch przeciwnikow i podpowiedzi
+    BalanceConfig balance;   // Skalowanie poziomow i lup - nie trafia do zapisu
+};
+
+// Prototypy funkcji
+void initStringTable();
+StringId internString(const char* str);
+const char* getString(StringId id);
+int isHere(GameWorld* world, int x, int y, int currentEnemies, int currentTraps);
+Player* createPlayer();
+void initPlayer(Player* player, const char* name, RandomState* random);
+Enemy* createEnemy(int x, int y, RandomState* random);
+void initEnemy(Enemy* enemy, int x, int y, RandomState* random);
+Trap* createTrap(int x, int y, RandomState* random);
+void initTrap(Trap* trap, int x, int y, RandomState* random);
+void checkTraps(GameWorld* world);
+unsigned long long newWorldSeed();
+void defaultBalance(BalanceConfig* balance);
+GameWorld* createGameWorld(const char* playerName);
+GameWorld* createSeededGameWorld(const char* playerName, unsigned long long seed);
+BattleResult battleRound(GameWorld* world, Enemy* enemy, BattleAction action);
+BattleResult battle(GameWorld* world, Enemy* enemy, BattleActionFunction chooseAction, void* context);
+void printMap(GameWorld* world);
+void moveEnemy(Enemy* enemy, RandomState* random);
+void moveEnemies(GameWorld* world);
+void removeEnemy(GameWorld* world, int index);
+void movePlayerAndEnemy(GameWorld* world);
+int applyPlayerCommand(GameWorld* world, char move);
+void stepWorld(GameWorld* world, char move, BattleActionFunction chooseAction, void* context);
+int playerMeetsEnemy(GameWorld* world);
+void resolveEncounters(GameWorld* world, BattleActionFunction chooseAction, void* context);
+void dropLoot(GameWorld* world);
+void freeGameWorld(GameWorld* world);
+GameWorld* cloneGameWorld(const GameWorld* world);
+Player* addWorldPlayer(GameWorld* world, const char* name);
+int appendWorldPlayer(GameWorld* world, Player* player);  // 0 - brak pamieci
+void removeWorldPlayer(GameWorld* world, Player* player);
+int worldPlayerIndex(const GameWorld* world, const Player* player);  // -1 - gracz spoza swiata
+void initMap(GameWorld* world);
+void reloadMap(GameWorld* world);
+void nextLevel(GameWorld* world);
+void activatePortal(GameWorld* world);
+int addItemToGround(GameWorld* world, Item* item, int x, int y);
+Item* takeItemFromGround(GameWorld* world, int index);
+void removeItemFromGround(GameWorld* world, int index);
+void clearGroundItems(GameWorld* world);
+int groundItemAt(GameWorld* world, int x, int y);
+int normalAttack(int attack, int defense, RandomState* random);
+int criticalAttack(int attack, int defense, RandomState* random);
+
+// Kolejka ruchow przeciwnikow
+int advanceEnemies(GameWorld* world, int ticks);
+void rebuildEnemySchedule(GameWorld* world);
+void unscheduleEnemy(GameWorld* world, int index);
+
+// Efekty statusu
+int applyStatusEffect(GameWorld* world, int onEnemy, int target, StatusEffectType type, int magnitude, int period,
+    int count);
+int restoreStatusEffect(GameWorld* world, int onEnemy, int target, StatusEffectType type, int magnitude, int period,
+    int count, int delay);
+void advanceStatusEffects(GameWorld* world, int ticks);
+int statusEffectTurns(const GameWorld* world, const Player* player, StatusEffectType type);
+int formatStatusEffects(const GameWorld* world, const Player* player, char* buffer, int size);
+void removeEnemyEffects(GameWorld* world, int index);
+void removePlayerEffects(GameWorld* world, int index);
+void clearPlayerEffects(GameWorld* world, int index);
+void clearEnemyEffects(GameWorld* world);
+
+// Pola wplywu
+void rebuildInfluence(GameWorld* world);
+int influenceAt(GameWorld* world, InfluenceField field, int x, int y);
+void stampInfluence(GameWorld* world, InfluenceField field, int x, int y, int value);
+int itemInfluenceValue(const Item* item);
+void steerEnemy(GameWorld* world, Enemy* enemy);
+int formatInfluenceHints(GameWorld* world, char* buffer, int size);
+
+// Budowa poziomow i watek budujacy nastepny poziom w tle
+void buildLevelContent(LevelContent* content, int level, RandomState* random, const BalanceConfig* balance);
+void freeLevelContent(LevelContent* content);
+void enableLevelPrefetch(GameWorld* world);
+void requestLevelPrefetch(GameWorld* world);
+int takePrefetchedLevel(GameWorld* world, LevelContent* out);
+void retireLevelContent(GameWorld* world, LevelContent* old);
+void freeLevelPrefetch(LevelPrefetch* prefetch);
+
+// Funkcje ekwipunku
+Inventory* createInventory(int width, int height);
+void freeInventory(Inventory* inv);
+int canPlaceItem(Inventory* inv, Item* item, int x, int y);
+int addItemToInventory(Inventory* inv, Item* item, int x, int y);
+void removeItemFromInventory(Inventory* inv, Item* item);
+int detachItemFromInventory(Inventory* inv, Item* item);
+int findInventorySpace(Inventory* inv, Item* item, int* outX, int* outY);
+const ItemShapeOps* findShapeOps(const Inventory* inv, const Item* item);
+extern const ItemShapeOps genericShapeOps;
+void printInventory(Inventory* inv);
+void inventoryMenu(GameWorld* world);
+Item* createHealthPotion();
+Item* createSword(RandomState* random);
+Item* createArmor(RandomState* random);
+Item* createStrengthPotion();
+Item* createRegenerationPotion();
+ItemUseResult useItem(GameWorld* world, Player* player, Item* item);
+int equipItem(Player* player, Item* item);
+void unequipItem(Player* player, EquipSlot slot);
+int isItemEquipped(const Player* player, const Item* item);
+
+// Indeks ekwipunku wedlug kategorii
+int itemRank(const Item* item);
+int indexInventoryItem(Inventory* inv, Item* item);
+void unindexInventoryItem(Inventory* inv, const Item* item);
+void freeInventoryIndex(Inventory* inv);
+int countInventoryItems(const Inventory* inv, ItemCategory category);
+Item* bestInventoryItem(const Inventory* inv, ItemCategory category);
+Item* quickUsePotion(const Inventory* inv, int missingHealth);
+int autoEquipUpgrades(Player* player);
+
+void saveGame(GameWorld* world);
+GameWorld* loadGame(int slot);
+extern int saveCompression;  // 0 - sekcje zapisu bez kompresji
+void* serializeSave(GameWorld* world, size_t* outSize);
+GameWorld* parseSave(const void* data, size_t size);
+int writeSaveFile(GameWorld* world, const char* path);
+GameWorld* readSaveFile(const char* path);
+
+// Sloty zapisu i ich spis
+void saveSlotPath(int slot, char* out, size_t size);
+void journalSlotPath(int slot, char* out, size_t size);
+int readSaveIndex(SaveIndex* index);
+void* serializeSaveIndex(GameWorld* world, size_t* outSize);
+int updateSaveIndex(GameWorld* world);
+
+// Dziennik autozapisu
+SaveJournal* openSaveJournal(GameWorld* world, const char* snapshotPath, const char* journalPath);
+int compactSaveJournal(SaveJournal* journal, GameWorld* world);
+int journalTurn(SaveJournal* journal, GameWorld* world);
+void closeSaveJournal(SaveJournal* journal);
+void removeSaveJournal(const char* journalPath);
+int replaySaveJournal(GameWorld* world, const char* journalPath);
+
+// Zdarzenia
+EventQueue* createEventQueue();
+void freeEventQueue(EventQueue* queue);
+void emitEvent(GameWorld* world, GameEventType type, StringId name, int value, int flags);
+void emitEventAt(GameWorld* world, GameEventType type, StringId name, int value, int flags, int x, int y);
+int pollEvent(EventQueue* queue, GameEvent* out);
+int drainEvents(EventQueue* queue, const EventSubscriber* subscribers, int subscriberCount);
+unsigned int droppedEventCount(const EventQueue* queue);
+const char* eventTypeName(GameEventType type);
+int formatEvent(const GameEvent* event, char* buffer, int size);
+void renderEventToConsole(const GameEvent* event, void* context);
+void logEventToFile(const GameEvent* event, void* context);
+void collectEventStats(const GameEvent* event, void* context);
+void printEventStats(const EventStats* stats);
+
+// Interfejs konsolowy
+int isMenuCommand(char move);
+int handleMenuCommand(GameWorld* world, char move);
+BattleAction promptBattleAction(GameWorld* world, Enemy* enemy, int round, void* context);
+int subscribeEvents(EventHandler handle, void* context);
+void unsubscribeEvents(EventHandler handle);
+void presentEvents(GameWorld* world);
+extern EventStats sessionStats;
+void finishGameIfOver(GameWorld* world);
+
+// Tryb czasu rzeczywistego
+void runRealTimeGame(GameWorld* world);
+
+// Benchmarki
+void runInventoryBenchmark();
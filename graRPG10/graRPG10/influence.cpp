@@ -0,0 +1,203 @@
+﻿#include "graRPG10.h"
+
+// Pola wplywu: zagrozenie od przeciwnikow, niebezpieczenstwo nieodkrytych
+// pulapek i wartosc lupu. Waga encji w odleglosci (dx, dy) to
+// (R + 1 - |dx|) * (R + 1 - |dy|) dla |dx|, |dy| <= R - iloczyn dwoch
+// trojkatow, wiec przebudowa to dwa przebiegi rozmycia (wiersze, potem
+// kolumny) po ciaglych wierszach bez rozgalezien, ktore kompilator
+// wektoryzuje. Ruch encji to stempel (2R + 1)^2 pol odjety i dodany -
+// liczby calkowite, wiec pola zawsze rowne przebudowie od zera.
+
+#define INFLUENCE_CELLS (MAP_WIDTH * MAP_HEIGHT)
+
+// Wagi wyboru ruchu przeciwnika
+#define STEER_LOOT_WEIGHT 1      // Pilnuje lupu
+#define STEER_DANGER_WEIGHT 4    // Omija pulapki
+#define STEER_CROWD_DIVISOR 2    // Nie tloczy sie z innymi przeciwnikami
+#define STEER_NOISE 48           // Reszta ruchu pozostaje losowa
+
+static int tentWeight(int d) {
+    int distance = d < 0 ? -d : d;
+    return distance > INFLUENCE_RADIUS ? 0 : INFLUENCE_RADIUS + 1 - distance;
+}
+
+int itemInfluenceValue(const Item* item) {
+    return item->attackBonus + item->defenseBonus + item->healthBonus / 2;
+}
+
+static int allocateInfluence(GameWorld* world) {
+    InfluenceMaps* influence = &world->influence;
+    if (influence->fields[0]) return 1;
+    int* cells = (int*)trackedMalloc((INFLUENCE_FIELD_COUNT + 2) * INFLUENCE_CELLS * sizeof(int), ALLOC_MAP);
+    if (!cells) return 0;
+    for (int i = 0; i < INFLUENCE_FIELD_COUNT; i++) {
+        influence->fields[i] = cells + i * INFLUENCE_CELLS;
+    }
+    influence->scratch = cells + INFLUENCE_FIELD_COUNT * INFLUENCE_CELLS;
+    return 1;
+}
+
+// Rozmycie trojkatem wzdluz wierszy: out[x] = suma w(d) * in[x + d]
+static void blurRows(const int* in, int* out) {
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        const int* src = in + y * MAP_WIDTH;
+        int* dst = out + y * MAP_WIDTH;
+        memset(dst, 0, MAP_WIDTH * sizeof(int));
+        for (int d = -INFLUENCE_RADIUS; d <= INFLUENCE_RADIUS; d++) {
+            int weight = tentWeight(d);
+            int from = d < 0 ? -d : 0;
+            int to = d > 0 ? MAP_WIDTH - d : MAP_WIDTH;
+            for (int x = from; x < to; x++) {
+                dst[x] += weight * src[x + d];
+            }
+        }
+    }
+}
+
+// To samo wzdluz kolumn - wiersze zrodla dodawane w calosci
+static void blurColumns(const int* in, int* out) {
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        int* dst = out + y * MAP_WIDTH;
+        memset(dst, 0, MAP_WIDTH * sizeof(int));
+        for (int d = -INFLUENCE_RADIUS; d <= INFLUENCE_RADIUS; d++) {
+            int row = y + d;
+            if (row < 0 || row >= MAP_HEIGHT) continue;
+            int weight = tentWeight(d);
+            const int* src = in + row * MAP_WIDTH;
+            for (int x = 0; x < MAP_WIDTH; x++) {
+                dst[x] += weight * src[x];
+            }
+        }
+    }
+}
+
+// Pola od zera: wartosci encji w ich polach, potem rozmycie
+void rebuildInfluence(GameWorld* world) {
+    InfluenceMaps* influence = &world->influence;
+    if (!allocateInfluence(world)) return;
+
+    int* points = influence->scratch;
+    int* rows = influence->scratch + INFLUENCE_CELLS;
+    for (int field = 0; field < INFLUENCE_FIELD_COUNT; field++) {
+        memset(points, 0, INFLUENCE_CELLS * sizeof(int));
+        if (field == INFLUENCE_THREAT) {
+            for (int i = 0; i < world->enemyCount; i++) {
+                const Enemy* enemy = world->enemies[i];
+                points[enemy->EposY * MAP_WIDTH + enemy->EposX] += enemy->attack;
+            }
+        }
+        else if (field == INFLUENCE_DANGER) {
+            for (int i = 0; i < world->trapCount; i++) {
+                const Trap* trap = world->traps[i];
+                if (!trap->discovered) points[trap->posY * MAP_WIDTH + trap->posX] += trap->damage;
+            }
+        }
+        else {
+            for (int i = 0; i < world->groundItemCount; i++) {
+                const Item* item = world->groundItems[i];
+                points[item->posY * MAP_WIDTH + item->posX] += itemInfluenceValue(item);
+            }
+        }
+        blurRows(points, rows);
+        blurColumns(rows, influence->fields[field]);
+    }
+    influence->valid = 1;
+}
+
+int influenceAt(GameWorld* world, InfluenceField field, int x, int y) {
+    if (!world->influence.valid) rebuildInfluence(world);
+    if (!world->influence.valid) return 0;
+    return world->influence.fields[field][y * MAP_WIDTH + x];
+}
+
+// Dodaje (value > 0) lub odejmuje stempel encji. Bez zbudowanych pol nic
+// nie robi - przebudowa i tak uwzgledni encje.
+void stampInfluence(GameWorld* world, InfluenceField field, int x, int y, int value) {
+    if (!world->influence.valid) return;
+    int* cells = world->influence.fields[field];
+    int top = y - INFLUENCE_RADIUS < 0 ? 0 : y - INFLUENCE_RADIUS;
+    int bottom = y + INFLUENCE_RADIUS >= MAP_HEIGHT ? MAP_HEIGHT - 1 : y + INFLUENCE_RADIUS;
+    int left = x - INFLUENCE_RADIUS < 0 ? 0 : x - INFLUENCE_RADIUS;
+    int right = x + INFLUENCE_RADIUS >= MAP_WIDTH ? MAP_WIDTH - 1 : x + INFLUENCE_RADIUS;
+    for (int cy = top; cy <= bottom; cy++) {
+        int rowValue = value * tentWeight(cy - y);
+        int* row = cells + cy * MAP_WIDTH;
+        for (int cx = left; cx <= right; cx++) {
+            row[cx] += rowValue * tentWeight(cx - x);
+        }
+    }
+}
+
+// Ruch przeciwnika wedlug pol: pilnuje lupu, omija pulapki i nie tloczy
+// sie z innymi; szum zostawia ruch czesciowo losowym. Mozliwe jest tez
+// zostanie w miejscu.
+void steerEnemy(GameWorld* world, Enemy* enemy) {
+    static const int stepX[] = { 0, 0, 0, -1, 1 };
+    static const int stepY[] = { 0, -1, 1, 0, 0 };
+    if (!world->influence.valid) rebuildInfluence(world);
+    if (!world->influence.valid) {
+        moveEnemy(enemy, &world->random);
+        return;
+    }
+
+    const InfluenceMaps* influence = &world->influence;
+    int bestX = enemy->EposX;
+    int bestY = enemy->EposY;
+    int bestScore = 0;
+    int haveBest = 0;
+    for (int i = 0; i < 5; i++) {
+        int x = enemy->EposX + stepX[i];
+        int y = enemy->EposY + stepY[i];
+        if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT) continue;
+
+        int cell = y * MAP_WIDTH + x;
+        // Zagrozenie bez wlasnego stempla - tylko inni przeciwnicy
+        int crowd = influence->fields[INFLUENCE_THREAT][cell] - enemy->attack * tentWeight(stepX[i]) * tentWeight(stepY[i]);
+        int score = influence->fields[INFLUENCE_LOOT][cell] * STEER_LOOT_WEIGHT -
+            influence->fields[INFLUENCE_DANGER][cell] * STEER_DANGER_WEIGHT - crowd / STEER_CROWD_DIVISOR +
+            randomInt(&world->random, STEER_NOISE);
+        if (!haveBest || score > bestScore) {
+            bestScore = score;
+            bestX = x;
+            bestY = y;
+            haveBest = 1;
+        }
+    }
+
+    if (bestX != enemy->EposX || bestY != enemy->EposY) {
+        stampInfluence(world, INFLUENCE_THREAT, enemy->EposX, enemy->EposY, -enemy->attack);
+        enemy->EposX = bestX;
+        enemy->EposY = bestY;
+        stampInfluence(world, INFLUENCE_THREAT, bestX, bestY, enemy->attack);
+    }
+}
+
+// Podpowiedzi pod mapa: zagrozenie w polu gracza, przeczucie pulapki i
+// kierunek do najcenniejszego lupu w zasiegu
+int formatInfluenceHints(GameWorld* world, char* buffer, int size) {
+    static const char* directions[] = { "na polnoc", "na poludnie", "na zachod", "na wschod" };
+    static const int stepX[] = { 0, 0, -1, 1 };
+    static const int stepY[] = { -1, 1, 0, 0 };
+    int x = world->player->posX;
+    int y = world->player->posY;
+
+    int threat = influenceAt(world, INFLUENCE_THREAT, x, y);
+    const char* threatText = threat == 0 ? "brak" : threat < 100 ? "niskie" : threat < 300 ? "srednie" : "wysokie";
+
+    int bestLoot = influenceAt(world, INFLUENCE_LOOT, x, y);
+    int bestDirection = -1;
+    for (int i = 0; i < 4; i++) {
+        int nx = x + stepX[i];
+        int ny = y + stepY[i];
+        if (nx < 0 || nx >= MAP_WIDTH || ny < 0 || ny >= MAP_HEIGHT) continue;
+        int loot = influenceAt(world, INFLUENCE_LOOT, nx, ny);
+        if (loot > bestLoot) {
+            bestLoot = loot;
+            bestDirection = i;
+        }
+    }
+
+    return snprintf(buffer, size, "Zagrozenie: %s%s%s%s", threatText,
+        influenceAt(world, INFLUENCE_DANGER, x, y) > 0 ? " | Wyczuwasz pulapke w poblizu" : "",
+        bestDirection >= 0 ? " | Lup " : "", bestDirection >= 0 ? directions[bestDirection] : "");
+}
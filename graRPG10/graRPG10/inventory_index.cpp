@@ -0,0 +1,132 @@
+﻿#include "graRPG10.h"
+
+// Indeks ekwipunku: dla kazdej kategorii tablica przedmiotow posortowana
+// wedlug premii. Najlepszy przedmiot lezy na koncu, a mikstura dobrana do
+// brakujacego zdrowia to wyszukiwanie binarne - zapytania nie zaleza od
+// rozmiaru siatki, takze przy tysiacach przedmiotow.
+
+#define INVENTORY_INDEX_MIN_CAPACITY 16
+
+// Premia, wedlug ktorej porownuje sie przedmioty kategorii. Mikstury
+// wedlug leczenia od razu - regeneracja leczy rozlozona na tury, a
+// mikstura sily wcale, wiec obie maja 0.
+int itemRank(const Item* item) {
+    if (item->category == ITEM_SWORD) return item->attackBonus;
+    if (item->category == ITEM_ARMOR) return item->defenseBonus;
+    if (item->name == STR_STRENGTH_POTION || item->name == STR_REGENERATION_POTION) return 0;
+    return item->healthBonus;
+}
+
+static int validCategory(int category) {
+    return category >= 0 && category < ITEM_CATEGORY_COUNT;
+}
+
+// Kolejnosc w indeksie: premia, potem pole lewego gornego rogu - klucz jest
+// jednoznaczny, wiec zdjecie przedmiotu nie przeglada rownych premii
+static int indexBefore(const Inventory* inv, const Item* a, const Item* b) {
+    int rankA = itemRank(a);
+    int rankB = itemRank(b);
+    if (rankA != rankB) return rankA < rankB;
+    return a->posY * inv->width + a->posX < b->posY * inv->width + b->posX;
+}
+
+// Pierwsza pozycja, ktorej przedmiot nie jest przed item
+static int indexLowerBound(const Inventory* inv, const InventoryIndex* index, const Item* item) {
+    int low = 0;
+    int high = index->count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (indexBefore(inv, index->items[middle], item)) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+// Nowa tablica zamiast realloc - w klonie stara lezy w bloku swiata
+static int growIndex(Inventory* inv, InventoryIndex* index) {
+    int capacity = index->capacity ? index->capacity * 2 : INVENTORY_INDEX_MIN_CAPACITY;
+    Item** items = (Item**)trackedMalloc(capacity * sizeof(Item*), ALLOC_INVENTORY);
+    if (!items) return 0;
+    if (index->count > 0) {
+        memcpy(items, index->items, index->count * sizeof(Item*));
+    }
+    freeWorldObject(&inv->clone, index->items);
+    index->items = items;
+    index->capacity = capacity;
+    return 1;
+}
+
+// Po ustawieniu pozycji przedmiotu w ekwipunku. 0 - brak pamieci.
+int indexInventoryItem(Inventory* inv, Item* item) {
+    if (!validCategory(item->category)) return 1;
+    InventoryIndex* index = &inv->index[item->category];
+    if (index->count == index->capacity && !growIndex(inv, index)) return 0;
+
+    int at = indexLowerBound(inv, index, item);
+    memmove(&index->items[at + 1], &index->items[at], (index->count - at) * sizeof(Item*));
+    index->items[at] = item;
+    index->count++;
+    return 1;
+}
+
+// Przed zmiana pozycji lub premii przedmiotu
+void unindexInventoryItem(Inventory* inv, const Item* item) {
+    if (!validCategory(item->category)) return;
+    InventoryIndex* index = &inv->index[item->category];
+    int at = indexLowerBound(inv, index, item);
+    if (at < index->count && index->items[at] == item) {
+        index->count--;
+        memmove(&index->items[at], &index->items[at + 1], (index->count - at) * sizeof(Item*));
+    }
+}
+
+void freeInventoryIndex(Inventory* inv) {
+    for (int i = 0; i < ITEM_CATEGORY_COUNT; i++) {
+        freeWorldObject(&inv->clone, inv->index[i].items);
+        inv->index[i].items = NULL;
+        inv->index[i].count = 0;
+        inv->index[i].capacity = 0;
+    }
+}
+
+int countInventoryItems(const Inventory* inv, ItemCategory category) {
+    return validCategory(category) ? inv->index[category].count : 0;
+}
+
+Item* bestInventoryItem(const Inventory* inv, ItemCategory category) {
+    if (!validCategory(category) || inv->index[category].count == 0) return NULL;
+    return inv->index[category].items[inv->index[category].count - 1];
+}
+
+// Najslabsza mikstura, ktora od razu uzupelnia brakujace zdrowie, a gdy
+// zadna nie wystarcza - najsilniejsza. Mikstury bez natychmiastowego
+// leczenia (sily, regeneracji) nie sa brane.
+Item* quickUsePotion(const Inventory* inv, int missingHealth) {
+    if (missingHealth <= 0) return NULL;
+    const InventoryIndex* index = &inv->index[ITEM_POTION];
+    int low = 0;
+    int high = index->count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (itemRank(index->items[middle]) < missingHealth) low = middle + 1;
+        else high = middle;
+    }
+    if (low < index->count) return index->items[low];
+    Item* strongest = bestInventoryItem(inv, ITEM_POTION);
+    return strongest && itemRank(strongest) > 0 ? strongest : NULL;
+}
+
+// Zaklada najlepsza bron i zbroje, jesli sa lepsze od zalozonych.
+// Wynik - liczba zmienionych slotow.
+int autoEquipUpgrades(Player* player) {
+    static const ItemCategory categories[EQUIP_SLOT_COUNT] = { ITEM_SWORD, ITEM_ARMOR };
+    int changed = 0;
+    for (int slot = 0; slot < EQUIP_SLOT_COUNT; slot++) {
+        Item* best = bestInventoryItem(player->inventory, categories[slot]);
+        const Item* worn = player->equipment[slot];
+        if (best && (!worn || itemRank(best) > itemRank(worn)) && equipItem(player, best)) {
+            changed++;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include "graRPG10.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Wyspecjalizowane rozmieszczanie przedmiotow o stalym ksztalcie.
+// Maska wiersza jest stala czasu kompilacji, wiec sprawdzenie zajetosci
+// to H operacji AND na maskach bitowych zamiast petli po slotach.
+
+static inline int lowestSetBit(unsigned int mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+template <int W, int H>
+struct ItemShape {
+    static_assert(W > 0 && W <= 32 && H > 0, "Nieobslugiwany ksztalt przedmiotu");
+    static constexpr unsigned int rowMask = (W == 32) ? 0xFFFFFFFFu : ((1u << W) - 1u);
+};
+
+template <int W, int H>
+int canPlaceShape(const Inventory* inv, const Item* item, int x, int y) {
+    (void)item;
+    const unsigned int mask = ItemShape<W, H>::rowMask << x;
+    const unsigned int* rows = inv->rowMask + y;
+
+    unsigned int occupied = 0;
+    for (int i = 0; i < H; i++) {
+        occupied |= rows[i];
+    }
+    return (occupied & mask) == 0;
+}
+
+// Pierwsza wolna pozycja (wierszami, od lewej) - jedno przejscie po wierszach
+// zamiast wywolywania canPlace dla kazdego slotu.
+template <int W, int H>
+int findSpaceShape(const Inventory* inv, const Item* item, int* outX, int* outY) {
+    (void)item;
+    if (W > inv->width || H > inv->height) {
+        return 0;
+    }
+
+    // Bity pozycji x, od ktorych przedmiot miesci sie w szerokosci ekwipunku
+    const unsigned int startMask = (inv->width - W + 1 >= 32) ? 0xFFFFFFFFu : ((1u << (inv->width - W + 1)) - 1u);
+
+    for (int y = 0; y + H <= inv->height; y++) {
+        unsigned int occupied = 0;
+        for (int i = 0; i < H; i++) {
+            occupied |= inv->rowMask[y + i];
+        }
+
+        // Pozycja x jest wolna, gdy bity x..x+W-1 sa wolne
+        unsigned int available = ~occupied;
+        for (int k = 1; k < W; k++) {
+            available &= ~occupied >> k;
+        }
+        available &= startMask;
+
+        if (available) {
+            *outX = lowestSetBit(available);
+            *outY = y;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <int W, int H>
+void placeShape(Inventory* inv, Item* item, int x, int y) {
+    const unsigned int mask = ItemShape<W, H>::rowMask << x;
+
+    for (int i = 0; i < H; i++) {
+        inv->rowMask[y + i] |= mask;
+        int* slotRow = inv->slots[y + i] + x;
+        Item** itemRow = inv->items[y + i] + x;
+        for (int j = 0; j < W; j++) {
+            slotRow[j] = 1;
+            itemRow[j] = item;
+        }
+    }
+}
+
+template <int W, int H>
+void clearShape(Inventory* inv, const Item* item, int x, int y) {
+    (void)item;
+    const unsigned int mask = ItemShape<W, H>::rowMask << x;
+
+    for (int i = 0; i < H; i++) {
+        inv->rowMask[y + i] &= ~mask;
+        int* slotRow = inv->slots[y + i] + x;
+        Item** itemRow = inv->items[y + i] + x;
+        for (int j = 0; j < W; j++) {
+            slotRow[j] = 0;
+            itemRow[j] = NULL;
+        }
+    }
+}
+
+#define ITEM_SHAPE_OPS(W, H) { W, H, canPlaceShape<W, H>, findSpaceShape<W, H>, placeShape<W, H>, clearShape<W, H> }
@@ -0,0 +1,671 @@
+﻿#include "graRPG10.h"
+
+// Dziennik autozapisu. Pelny zapis powstaje tylko przy otwarciu dziennika,
+// zmianie poziomu i co JOURNAL_COMPACT_TURNS tur - miedzy nimi po kazdej
+// turze do dziennika trafiaja rekordy encji, ktore zmienily sie od poprzedniej
+// tury. Tura ma sume kontrolna i przy odczycie jest odrzucana w calosci, wiec
+// po awarii przepada najwyzej ostatnia tura.
+//
+// Pelny zapis pisze w tle watek zapisu. Do czasu, az trafi na dysk, poprzedni
+// dziennik lezy obok jako <dziennik>.prev: stary zapis + poprzedni dziennik +
+// nowy dziennik daja ten sam stan co nowy zapis + nowy dziennik.
+
+#define JOURNAL_MAGIC 0x4A505247       // "GRPJ"
+#define JOURNAL_TURN_MAGIC 0x4E525554  // "TURN"
+#define JOURNAL_COMPACT_TURNS 100
+#define JOURNAL_COMPACT_BYTES (256 * 1024)
+#define JOURNAL_MAX_PATH 260
+
+// Pojemnosc kopii stanu - wiecej encji wymusza pelny zapis zamiast dziennika
+#define JOURNAL_MAX_ENEMIES (MAX_ENEMIES + 4)
+#define JOURNAL_MAX_TRAPS (MAX_TRAPS + 4)
+#define JOURNAL_MAX_ITEMS (INVENTORY_WIDTH * INVENTORY_HEIGHT)
+#define JOURNAL_MAX_EFFECTS (2 * JOURNAL_MAX_ENEMIES + 16)
+
+typedef enum {
+    RECORD_WORLD,      // JournalWorldState
+    RECORD_PLAYER,     // JournalPlayerState
+    RECORD_ENEMY,      // index - pozycja w world->enemies
+    RECORD_TRAP,       // index - pozycja w world->traps
+    RECORD_INVENTORY,  // Wszystkie przedmioty ekwipunku
+    RECORD_GROUND,     // Wszystkie przedmioty na ziemi
+    RECORD_EFFECTS     // Wszystkie efekty statusu gracza i przeciwnikow
+} JournalRecordType;
+
+typedef struct {
+    int magic;
+    int version;
+    int generation;  // Numer pelnego zapisu, do ktorego dopisywane sa tury
+} JournalHeader;
+
+// Po naglowku tury: size bajtow rekordow i suma kontrolna (unsigned int)
+typedef struct {
+    int magic;
+    int turn;
+    int size;
+} JournalTurnHeader;
+
+typedef struct {
+    int type;
+    int index;
+    int size;
+} JournalRecordHeader;
+
+typedef struct {
+    int level;
+    int enemiesDefeated;
+    int portalActive;
+    int portalX;
+    int portalY;
+    int totalEnemiesDefeated;
+    int enemyCount;
+    int trapCount;
+    int scheduleClock;  // Zegar kolejki ruchow - moveTimer przeciwnikow liczy sie od niego
+} JournalWorldState;
+
+typedef struct {
+    int health;
+    int base_max_health;
+    int base_attack;
+    int base_defense;
+    int posX;
+    int posY;
+    int gold;
+    int equipment[EQUIP_SLOT_COUNT][2];  // Pozycje w ekwipunku (-1 - pusty slot)
+} JournalPlayerState;
+
+// Efekt statusu jak w sekcji efektow zapisu - termin wzgledem zegara kola,
+// wiec rekord zmienia sie w kazdej turze, w ktorej jakis efekt trwa
+typedef struct {
+    int type;
+    int onEnemy;
+    int target;  // Indeks przeciwnika; efekty gracza zawsze 0
+    int magnitude;
+    int period;
+    int remaining;
+    int delay;
+} JournalEffect;
+
+struct SaveJournal {
+    FILE* file;
+    char snapshotPath[JOURNAL_MAX_PATH];
+    char journalPath[JOURNAL_MAX_PATH];
+    char previousPath[JOURNAL_MAX_PATH + 8];
+    SaveWriter* writer;
+    long long reportedFailures;
+    int snapshotLevel;  // Poziom z ostatniego pelnego zapisu
+    int turnsSinceCompact;
+    long bytesSinceCompact;
+
+    // Stan z ostatniej zapisanej tury - porownywany z biezacym swiatem
+    JournalWorldState world;
+    JournalPlayerState player;
+    Enemy enemies[JOURNAL_MAX_ENEMIES];
+    Trap traps[JOURNAL_MAX_TRAPS];
+    Item inventory[JOURNAL_MAX_ITEMS];
+    int inventoryCount;
+    Item ground[MAX_GROUND_ITEMS];
+    int groundCount;
+    JournalEffect effects[JOURNAL_MAX_EFFECTS];
+    int effectCount;
+
+    Item scratch[JOURNAL_MAX_ITEMS];  // Biezacy ekwipunek podczas porownania
+    JournalEffect effectScratch[JOURNAL_MAX_EFFECTS];
+    char* buffer;                     // Rekordy budowanej tury
+    int bufferUsed;
+};
+
+// Najwieksza mozliwa tura: wszystkie rekordy naraz
+static int maxTurnSize() {
+    return (int)(sizeof(JournalTurnHeader) + sizeof(unsigned int) +
+        7 * sizeof(JournalRecordHeader) + sizeof(JournalWorldState) + sizeof(JournalPlayerState) +
+        JOURNAL_MAX_ENEMIES * (sizeof(JournalRecordHeader) + sizeof(Enemy)) +
+        JOURNAL_MAX_TRAPS * (sizeof(JournalRecordHeader) + sizeof(Trap)) +
+        (JOURNAL_MAX_ITEMS + MAX_GROUND_ITEMS) * sizeof(Item) + JOURNAL_MAX_EFFECTS * sizeof(JournalEffect));
+}
+
+// FNV-1a
+static unsigned int journalChecksum(const char* data, int size) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void captureWorld(JournalWorldState* state, const GameWorld* world) {
+    memset(state, 0, sizeof(JournalWorldState));
+    state->level = world->level;
+    state->enemiesDefeated = world->enemiesDefeated;
+    state->portalActive = world->portalActive;
+    state->portalX = world->portalX;
+    state->portalY = world->portalY;
+    state->totalEnemiesDefeated = world->totalEnemiesDefeated;
+    state->enemyCount = world->enemyCount;
+    state->trapCount = world->trapCount;
+    state->scheduleClock = (int)world->schedule.clock;
+}
+
+static void capturePlayer(JournalPlayerState* state, const Player* player) {
+    memset(state, 0, sizeof(JournalPlayerState));
+    state->health = player->health;
+    state->base_max_health = player->base_max_health;
+    state->base_attack = player->base_attack;
+    state->base_defense = player->base_defense;
+    state->posX = player->posX;
+    state->posY = player->posY;
+    state->gold = player->gold;
+    for (int i = 0; i < EQUIP_SLOT_COUNT; i++) {
+        const Item* item = player->equipment[i];
+        state->equipment[i][0] = item ? item->posX : -1;
+        state->equipment[i][1] = item ? item->posY : -1;
+    }
+}
+
+// Przedmioty ekwipunku w kolejnosci zapisu (lewy gorny rog przedmiotu)
+static int collectInventory(const Inventory* inv, Item* out) {
+    int count = 0;
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            Item* item = inv->items[y][x];
+            if (item && item->posX == x && item->posY == y && count < JOURNAL_MAX_ITEMS) {
+                out[count++] = *item;
+            }
+        }
+    }
+    return count;
+}
+
+// Efekty gracza, potem przeciwnikow po kolei - z list celow, bez przegladania puli
+static int collectEffects(const GameWorld* world, JournalEffect* out) {
+    const StatusEffects* effects = &world->effects;
+    int count = 0;
+    int playerIndex = worldPlayerIndex(world, world->player);
+    for (int onEnemy = 0; onEnemy < 2; onEnemy++) {
+        int from = onEnemy ? 0 : playerIndex;
+        int to = onEnemy ? world->enemyCount : playerIndex + 1;
+        for (int target = from < 0 ? 0 : from; target < to && target < effects->targetCapacity[onEnemy]; target++) {
+            for (int node = effects->targetHeads[onEnemy][target]; node; node = effects->pool[node - 1].targetNext) {
+                const StatusEffect* effect = &effects->pool[node - 1];
+                if (count >= JOURNAL_MAX_EFFECTS) return count;
+                JournalEffect* record = &out[count++];
+                record->type = effect->type;
+                record->onEnemy = onEnemy;
+                record->target = onEnemy ? target : 0;
+                record->magnitude = effect->magnitude;
+                record->period = effect->period;
+                record->remaining = effect->remaining;
+                record->delay = (int)(effect->due - effects->clock);
+            }
+        }
+    }
+    return count;
+}
+
+static int fitsJournal(const GameWorld* world) {
+    return world->enemyCount <= JOURNAL_MAX_ENEMIES && world->trapCount <= JOURNAL_MAX_TRAPS &&
+        world->effects.count <= JOURNAL_MAX_EFFECTS;
+}
+
+// Kopia calego stanu po pelnym zapisie
+static void captureAll(SaveJournal* journal, const GameWorld* world) {
+    journal->snapshotLevel = world->level;
+    captureWorld(&journal->world, world);
+    capturePlayer(&journal->player, world->player);
+    for (int i = 0; i < world->enemyCount && i < JOURNAL_MAX_ENEMIES; i++) {
+        journal->enemies[i] = *world->enemies[i];
+    }
+    for (int i = 0; i < world->trapCount && i < JOURNAL_MAX_TRAPS; i++) {
+        journal->traps[i] = *world->traps[i];
+    }
+    journal->inventoryCount = collectInventory(world->player->inventory, journal->inventory);
+    journal->groundCount = world->groundItemCount;
+    for (int i = 0; i < world->groundItemCount; i++) {
+        journal->ground[i] = *world->groundItems[i];
+    }
+    journal->effectCount = collectEffects(world, journal->effects);
+}
+
+static void appendRecord(SaveJournal* journal, JournalRecordType type, int index, const void* data, int size) {
+    JournalRecordHeader header = { type, index, size };
+    memcpy(journal->buffer + journal->bufferUsed, &header, sizeof(header));
+    journal->bufferUsed += sizeof(header);
+    memcpy(journal->buffer + journal->bufferUsed, data, size);
+    journal->bufferUsed += size;
+}
+
+static int startJournalFile(SaveJournal* journal, int generation) {
+    if (journal->file) {
+        fclose(journal->file);
+        journal->file = NULL;
+    }
+    if (fopen_s(&journal->file, journal->journalPath, "wb") != 0) {
+        journal->file = NULL;
+        return 0;
+    }
+    JournalHeader header = { JOURNAL_MAGIC, SAVE_VERSION, generation };
+    fwrite(&header, sizeof(header), 1, journal->file);
+    fflush(journal->file);
+    return 1;
+}
+
+// Zmiany z zakonczonej tury jako jeden rekord tury na koncu dziennika
+static int appendTurn(SaveJournal* journal, GameWorld* world) {
+    if (!journal->file) return 0;
+
+    journal->bufferUsed = sizeof(JournalTurnHeader);
+    int previousEnemies = journal->world.enemyCount;
+
+    JournalWorldState worldState;
+    captureWorld(&worldState, world);
+    if (memcmp(&worldState, &journal->world, sizeof(worldState)) != 0) {
+        appendRecord(journal, RECORD_WORLD, 0, &worldState, sizeof(worldState));
+        journal->world = worldState;
+    }
+
+    JournalPlayerState playerState;
+    capturePlayer(&playerState, world->player);
+    if (memcmp(&playerState, &journal->player, sizeof(playerState)) != 0) {
+        appendRecord(journal, RECORD_PLAYER, 0, &playerState, sizeof(playerState));
+        journal->player = playerState;
+    }
+
+    // Przeciwnicy spoza poprzedniej liczby sa zawsze nowi
+    PROFILE_COUNT(COUNTER_ENTITIES, world->enemyCount + world->trapCount);
+    for (int i = 0; i < world->enemyCount; i++) {
+        if (memcmp(world->enemies[i], &journal->enemies[i], sizeof(Enemy)) != 0 || i >= previousEnemies) {
+            appendRecord(journal, RECORD_ENEMY, i, world->enemies[i], sizeof(Enemy));
+            journal->enemies[i] = *world->enemies[i];
+        }
+    }
+    for (int i = 0; i < world->trapCount; i++) {
+        if (memcmp(world->traps[i], &journal->traps[i], sizeof(Trap)) != 0) {
+            appendRecord(journal, RECORD_TRAP, i, world->traps[i], sizeof(Trap));
+            journal->traps[i] = *world->traps[i];
+        }
+    }
+
+    int itemCount = collectInventory(world->player->inventory, journal->scratch);
+    if (itemCount != journal->inventoryCount ||
+        memcmp(journal->scratch, journal->inventory, itemCount * sizeof(Item)) != 0) {
+        appendRecord(journal, RECORD_INVENTORY, itemCount, journal->scratch, itemCount * sizeof(Item));
+        memcpy(journal->inventory, journal->scratch, itemCount * sizeof(Item));
+        journal->inventoryCount = itemCount;
+    }
+
+    int groundChanged = world->groundItemCount != journal->groundCount;
+    for (int i = 0; i < world->groundItemCount && !groundChanged; i++) {
+        groundChanged = memcmp(world->groundItems[i], &journal->ground[i], sizeof(Item)) != 0;
+    }
+    if (groundChanged) {
+        for (int i = 0; i < world->groundItemCount; i++) {
+            journal->ground[i] = *world->groundItems[i];
+        }
+        journal->groundCount = world->groundItemCount;
+        appendRecord(journal, RECORD_GROUND, journal->groundCount, journal->ground,
+            journal->groundCount * sizeof(Item));
+    }
+
+    int effectCount = collectEffects(world, journal->effectScratch);
+    if (effectCount != journal->effectCount ||
+        memcmp(journal->effectScratch, journal->effects, effectCount * sizeof(JournalEffect)) != 0) {
+        appendRecord(journal, RECORD_EFFECTS, effectCount, journal->effectScratch, effectCount * sizeof(JournalEffect));
+        memcpy(journal->effects, journal->effectScratch, effectCount * sizeof(JournalEffect));
+        journal->effectCount = effectCount;
+    }
+
+    // Tura bez zmian to sam naglowek - licznik tur po odczycie sie zgadza
+    JournalTurnHeader header = { JOURNAL_TURN_MAGIC, world->turn, journal->bufferUsed - (int)sizeof(JournalTurnHeader) };
+    memcpy(journal->buffer, &header, sizeof(header));
+    unsigned int checksum = journalChecksum(journal->buffer + sizeof(header), header.size);
+    memcpy(journal->buffer + journal->bufferUsed, &checksum, sizeof(checksum));
+    journal->bufferUsed += sizeof(checksum);
+
+    // Jeden zapis na ture - niepelna tura zostanie odrzucona przy odczycie
+    size_t written = fwrite(journal->buffer, 1, journal->bufferUsed, journal->file);
+    fflush(journal->file);
+    journal->turnsSinceCompact++;
+    journal->bytesSinceCompact += journal->bufferUsed;
+    return written == (size_t)journal->bufferUsed;
+}
+
+// Pelny zapis i pusty dziennik. Nowy numer zapisu uniewaznia stary dziennik,
+// a dotychczasowy dziennik zostaje jako poprzedni, dopoki zapis jest w drodze.
+static int rotateJournal(SaveJournal* journal, GameWorld* world) {
+    if (journal->file) {
+        fclose(journal->file);
+        journal->file = NULL;
+        remove(journal->previousPath);
+        replaceFile(journal->journalPath, journal->previousPath);
+    }
+
+    world->saveGeneration++;
+    size_t size;
+    void* data = serializeSave(world, &size);
+    if (!data) {
+        return 0;
+    }
+    if (!submitSave(journal->writer, journal->snapshotPath, data, size)) {
+        int ok = writeFileAtomic(journal->snapshotPath, data, size);
+        trackedFree(data);
+        if (!ok) return 0;
+    }
+
+    // Spis slotow za zapisem - kolejka watku zapisu zachowuje kolejnosc
+    data = serializeSaveIndex(world, &size);
+    if (data && !submitSave(journal->writer, SAVE_INDEX_PATH, data, size)) {
+        writeFileAtomic(SAVE_INDEX_PATH, data, size);
+        trackedFree(data);
+    }
+
+    if (!startJournalFile(journal, world->saveGeneration)) {
+        return 0;
+    }
+    captureAll(journal, world);
+    journal->turnsSinceCompact = 0;
+    journal->bytesSinceCompact = 0;
+    return 1;
+}
+
+// Zapis na zadanie gracza. Poprzedni pelny zapis musi juz lezec na dysku,
+// inaczej dziennik sprzed niego nie mialby do czego pasowac.
+int compactSaveJournal(SaveJournal* journal, GameWorld* world) {
+    waitForSaves(journal->writer);
+    if (fitsJournal(world)) {
+        appendTurn(journal, world);
+    }
+    return rotateJournal(journal, world);
+}
+
+SaveJournal* openSaveJournal(GameWorld* world, const char* snapshotPath, const char* journalPath) {
+    SaveJournal* journal = (SaveJournal*)trackedCalloc(1, sizeof(SaveJournal), ALLOC_SAVE);
+    if (!journal) return NULL;
+
+    journal->buffer = (char*)trackedMalloc(maxTurnSize(), ALLOC_SAVE);
+    journal->writer = startSaveWriter();
+    snprintf(journal->snapshotPath, sizeof(journal->snapshotPath), "%s", snapshotPath);
+    snprintf(journal->journalPath, sizeof(journal->journalPath), "%s", journalPath);
+    snprintf(journal->previousPath, sizeof(journal->previousPath), "%s.prev", journalPath);
+    if (!journal->buffer || !journal->writer || !rotateJournal(journal, world)) {
+        closeSaveJournal(journal);
+        return NULL;
+    }
+
+    // Pierwszy zapis czeka na dysk - stare pliki moga pochodzic z innej gry
+    waitForSaves(journal->writer);
+    remove(journal->previousPath);
+    if (saveWriterStats(journal->writer).failed > 0) {
+        closeSaveJournal(journal);
+        return NULL;
+    }
+    return journal;
+}
+
+void closeSaveJournal(SaveJournal* journal) {
+    if (!journal) return;
+    stopSaveWriter(journal->writer);
+    if (journal->file) {
+        fclose(journal->file);
+    }
+    trackedFree(journal->buffer);
+    trackedFree(journal);
+}
+
+void removeSaveJournal(const char* journalPath) {
+    char previousPath[JOURNAL_MAX_PATH + 8];
+    snprintf(previousPath, sizeof(previousPath), "%s.prev", journalPath);
+    remove(journalPath);
+    remove(previousPath);
+}
+
+// Dopisuje zmiany z zakonczonej tury i w razie potrzeby zleca pelny zapis.
+// Zwraca 0, gdy zapis sie nie udal.
+int journalTurn(SaveJournal* journal, GameWorld* world) {
+    if (!journal || world->status != GAME_RUNNING) return 1;
+
+    // Bledy zapisu w tle wychodza dopiero tutaj
+    long long failed = saveWriterStats(journal->writer).failed;
+    if (failed > journal->reportedFailures) {
+        journal->reportedFailures = failed;
+        emitEvent(world, EVENT_GAME_SAVED, STRING_NONE, world->saveGeneration, 0);
+    }
+
+    int fits = fitsJournal(world);
+    int ok = fits ? appendTurn(journal, world) : 1;
+
+    // Nowy poziom zmienia prawie wszystko - taniej zapisac go w calosci.
+    // Gdy poprzedni pelny zapis jest jeszcze w drodze, dziennik rosnie dalej.
+    if (!fits || world->level != journal->snapshotLevel ||
+        journal->turnsSinceCompact >= JOURNAL_COMPACT_TURNS ||
+        journal->bytesSinceCompact >= JOURNAL_COMPACT_BYTES) {
+        if (!fits) {
+            waitForSaves(journal->writer);
+        }
+        if (!isSavePending(journal->writer)) {
+            ok = rotateJournal(journal, world);
+        }
+    }
+    return ok;
+}
+
+// Zmienia liczbe przeciwnikow lub pulapek; nowe encje wypelnia dalsza czesc dziennika
+static void** resizeEntityArray(void** entities, int oldCount, int newCount, size_t entitySize, AllocTag tag) {
+    void** resized = (void**)trackedMalloc((newCount > 0 ? newCount : 1) * sizeof(void*), tag);
+    for (int i = 0; i < newCount; i++) {
+        resized[i] = i < oldCount ? entities[i] : trackedCalloc(1, entitySize, tag);
+    }
+    for (int i = newCount; i < oldCount; i++) {
+        trackedFree(entities[i]);
+    }
+    trackedFree(entities);
+    return resized;
+}
+
+static void applyWorldRecord(GameWorld* world, const JournalWorldState* state) {
+    world->level = state->level;
+    world->enemiesDefeated = state->enemiesDefeated;
+    world->portalActive = state->portalActive;
+    world->portalX = state->portalX;
+    world->portalY = state->portalY;
+    world->totalEnemiesDefeated = state->totalEnemiesDefeated;
+    world->schedule.clock = state->scheduleClock;
+    if (state->enemyCount != world->enemyCount) {
+        clearEnemyEffects(world);  // Indeksy przeciwnikow juz nie pasuja
+        world->enemies = (Enemy**)resizeEntityArray((void**)world->enemies, world->enemyCount,
+            state->enemyCount, sizeof(Enemy), ALLOC_ENEMY);
+        world->enemyCount = state->enemyCount;
+    }
+    if (state->trapCount != world->trapCount) {
+        world->traps = (Trap**)resizeEntityArray((void**)world->traps, world->trapCount,
+            state->trapCount, sizeof(Trap), ALLOC_TRAP);
+        world->trapCount = state->trapCount;
+    }
+}
+
+static void applyPlayerRecord(Player* player, const JournalPlayerState* state) {
+    player->health = state->health;
+    player->base_max_health = state->base_max_health;
+    player->base_attack = state->base_attack;
+    player->base_defense = state->base_defense;
+    player->posX = state->posX;
+    player->posY = state->posY;
+    player->gold = state->gold;
+}
+
+// Ekwipunek jest odtwarzany od zera - wyposazenie wraca na koniec odczytu
+static void applyInventoryRecord(GameWorld* world, const Item* items, int count) {
+    Player* player = world->player;
+    Inventory* inv = player->inventory;
+    int width = inv->width;
+    int height = inv->height;
+    for (int i = 0; i < EQUIP_SLOT_COUNT; i++) {
+        player->equipment[i] = NULL;
+    }
+    freeInventory(inv);
+    player->inventory = createInventory(width, height);
+    for (int i = 0; i < count; i++) {
+        Item* item = (Item*)trackedMalloc(sizeof(Item), ALLOC_ITEM);
+        *item = items[i];
+        item->inInventory = 0;
+        if (!addItemToInventory(player->inventory, item, item->posX, item->posY)) {
+            // Brak pamieci na indeks - przedmiot zostaje pod graczem
+            StringId name = item->name;
+            addItemToGround(world, item, player->posX, player->posY);
+            emitEvent(world, EVENT_INVENTORY_FULL, name, 0, 0);
+        }
+    }
+}
+
+// Efekty sa odtwarzane od zera - premie gracza schodza i wracaja z efektami
+static void applyEffectsRecord(GameWorld* world, const JournalEffect* effects, int count) {
+    int playerIndex = worldPlayerIndex(world, world->player);
+    clearPlayerEffects(world, playerIndex);
+    clearEnemyEffects(world);
+    for (int i = 0; i < count; i++) {
+        const JournalEffect* effect = &effects[i];
+        restoreStatusEffect(world, effect->onEnemy, effect->onEnemy ? effect->target : playerIndex,
+            (StatusEffectType)effect->type, effect->magnitude, effect->period, effect->remaining, effect->delay);
+    }
+}
+
+static void applyGroundRecord(GameWorld* world, const Item* items, int count) {
+    clearGroundItems(world);
+    for (int i = 0; i < count && i < MAX_GROUND_ITEMS; i++) {
+        Item* item = (Item*)trackedMalloc(sizeof(Item), ALLOC_ITEM);
+        *item = items[i];
+        world->groundItems[world->groundItemCount++] = item;
+    }
+}
+
+static int applyRecords(GameWorld* world, JournalPlayerState* player, const char* data, int size) {
+    int offset = 0;
+    while (offset + (int)sizeof(JournalRecordHeader) <= size) {
+        JournalRecordHeader header;
+        memcpy(&header, data + offset, sizeof(header));
+        offset += sizeof(header);
+        if (header.size < 0 || offset + header.size > size) return 0;
+        const char* payload = data + offset;
+        offset += header.size;
+
+        switch (header.type) {
+        case RECORD_WORLD:
+            if (header.size != sizeof(JournalWorldState)) return 0;
+            applyWorldRecord(world, (const JournalWorldState*)payload);
+            break;
+        case RECORD_PLAYER:
+            if (header.size != sizeof(JournalPlayerState)) return 0;
+            memcpy(player, payload, sizeof(JournalPlayerState));
+            applyPlayerRecord(world->player, player);
+            break;
+        case RECORD_ENEMY:
+            if (header.size != sizeof(Enemy) || header.index < 0 || header.index >= world->enemyCount) return 0;
+            memcpy(world->enemies[header.index], payload, sizeof(Enemy));
+            break;
+        case RECORD_TRAP:
+            if (header.size != sizeof(Trap) || header.index < 0 || header.index >= world->trapCount) return 0;
+            memcpy(world->traps[header.index], payload, sizeof(Trap));
+            break;
+        case RECORD_INVENTORY:
+            if (header.size != header.index * (int)sizeof(Item)) return 0;
+            applyInventoryRecord(world, (const Item*)payload, header.index);
+            break;
+        case RECORD_GROUND:
+            if (header.size != header.index * (int)sizeof(Item)) return 0;
+            applyGroundRecord(world, (const Item*)payload, header.index);
+            break;
+        case RECORD_EFFECTS:
+            if (header.index < 0 || header.index > JOURNAL_MAX_EFFECTS ||
+                header.size != header.index * (int)sizeof(JournalEffect)) return 0;
+            applyEffectsRecord(world, (const JournalEffect*)payload, header.index);
+            break;
+        default:
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Odtwarza jeden plik dziennika. -1 - brak pliku albo dziennik innego zapisu.
+static int replayJournalFile(GameWorld* world, JournalPlayerState* player, const char* path) {
+    FILE* file;
+    if (fopen_s(&file, path, "rb") != 0) {
+        return -1;
+    }
+
+    JournalHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != JOURNAL_MAGIC ||
+        header.version != SAVE_VERSION || header.generation != world->saveGeneration) {
+        fclose(file);
+        return -1;
+    }
+
+    int capacity = maxTurnSize();
+    char* payload = (char*)trackedMalloc(capacity, ALLOC_SAVE);
+    int replayed = 0;
+    JournalTurnHeader turn;
+    while (payload && fread(&turn, sizeof(turn), 1, file) == 1) {
+        // Urwana lub uszkodzona tura konczy odczyt - to ostatnia tura przed awaria
+        unsigned int checksum;
+        if (turn.magic != JOURNAL_TURN_MAGIC || turn.size < 0 || turn.size > capacity ||
+            fread(payload, 1, turn.size, file) != (size_t)turn.size ||
+            fread(&checksum, sizeof(checksum), 1, file) != 1 ||
+            checksum != journalChecksum(payload, turn.size)) {
+            break;
+        }
+        if (!applyRecords(world, player, payload, turn.size)) {
+            break;
+        }
+        world->turn = turn.turn;
+        replayed++;
+    }
+    trackedFree(payload);
+    fclose(file);
+    return replayed;
+}
+
+// Odtwarza tury zapisane po pelnym zapisie, z ktorego wczytano swiat. Gdy
+// nowszy pelny zapis nie zdazyl trafic na dysk, najpierw idzie poprzedni
+// dziennik, a po nim biezacy. Zwraca liczbe odtworzonych tur.
+int replaySaveJournal(GameWorld* world, const char* journalPath) {
+    char previousPath[JOURNAL_MAX_PATH + 8];
+    snprintf(previousPath, sizeof(previousPath), "%s.prev", journalPath);
+
+    JournalPlayerState player;
+    capturePlayer(&player, world->player);
+
+    int replayed = 0;
+    int previous = replayJournalFile(world, &player, previousPath);
+    if (previous >= 0) {
+        // Stan po poprzednim dzienniku to stan, ktory mial trafic do nowego zapisu
+        replayed += previous;
+        world->saveGeneration++;
+    }
+    int current = replayJournalFile(world, &player, journalPath);
+    if (current >= 0) {
+        replayed += current;
+    }
+
+    // Statystyki pochodne od nowa z wyposazenia, jak przy wczytaniu pelnego zapisu
+    Player* p = world->player;
+    int savedHealth = p->health;
+    for (int i = 0; i < EQUIP_SLOT_COUNT; i++) {
+        p->equipment[i] = NULL;
+    }
+    p->max_health = p->base_max_health;
+    p->attack = p->base_attack;
+    p->defense = p->base_defense;
+    for (int i = 0; i < EQUIP_SLOT_COUNT; i++) {
+        int x = player.equipment[i][0];
+        int y = player.equipment[i][1];
+        if (x >= 0 && x < p->inventory->width && y >= 0 && y < p->inventory->height && p->inventory->items[y][x]) {
+            equipItem(p, p->inventory->items[y][x]);
+        }
+    }
+    p->health = savedHealth;
+
+    world->influence.valid = 0;
+    world->schedule.valid = 0;  // Kolejka od nowa z odtworzonych moveTimer
+    reloadMap(world);
+    return replayed;
+}
@@ -0,0 +1,261 @@
+﻿#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "graRPG10.h"
+
+// Budowa zawartosci poziomu (przeciwnicy, pulapki, przedmioty) poza swiatem.
+// Swiat z wlaczonym wyprzedzaniem ma watek, ktory buduje nastepny poziom od
+// otwarcia portalu i zwalnia stare poziomy - wejscie w portal tylko podmienia
+// wskazniki.
+
+#define PREFETCH_RETIRED_LEVELS 4
+
+struct LevelPrefetch {
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;      // Zlecenie, stary poziom albo koniec
+    std::condition_variable finished;  // Zlecony poziom gotowy
+    int stop;
+    int requestedLevel;                // 0 - brak zlecenia
+    RandomState random;                // Losowania zleconej budowy - ziarno z losowan swiata
+    BalanceConfig balance;             // Balans swiata z chwili zlecenia
+    int buildingLevel;                 // 0 - watek nie buduje
+    LevelContent ready;
+    LevelContent retired[PREFETCH_RETIRED_LEVELS];  // Do zwolnienia w tle
+    int retiredCount;
+};
+
+// Gracz zaczyna poziom w lewym gornym rogu - tam nic nie stawiamy
+static int isOccupied(const LevelContent* content, int x, int y, int enemies, int traps) {
+    if (x == 0 && y == 0) return 1;
+    for (int i = 0; i < enemies; i++) {
+        if (content->enemies[i]->EposX == x && content->enemies[i]->EposY == y) return 1;
+    }
+    for (int i = 0; i < traps; i++) {
+        if (content->traps[i]->posX == x && content->traps[i]->posY == y) return 1;
+    }
+    return 0;
+}
+
+static int hasItemAt(const LevelContent* content, int x, int y) {
+    for (int i = 0; i < content->itemCount; i++) {
+        if (content->items[i]->posX == x && content->items[i]->posY == y) return 1;
+    }
+    return 0;
+}
+
+void buildLevelContent(LevelContent* content, int level, RandomState* random, const BalanceConfig* balance) {
+    content->level = level;
+    content->enemyCount = MAX_ENEMIES + level / 2;
+    content->trapCount = MAX_TRAPS + level / 2;
+    content->itemCount = 0;
+
+    // Przeciwnicy silniejsi z kazdym poziomem
+    content->enemies = (Enemy**)trackedMalloc(content->enemyCount * sizeof(Enemy*), ALLOC_ENEMY);
+    for (int i = 0; i < content->enemyCount; i++) {
+        int x, y;
+        do {
+            x = randomInt(random, MAP_WIDTH);
+            y = randomInt(random, MAP_HEIGHT);
+        } while (isOccupied(content, x, y, i, 0));
+
+        Enemy* enemy = createEnemy(x, y, random);
+        enemy->health += level * balance->enemyHealthPerLevel;
+        enemy->attack += level * balance->enemyAttackPerLevel;
+        enemy->defense += level * balance->enemyDefensePerLevel;
+        content->enemies[i] = enemy;
+    }
+
+    content->traps = (Trap**)trackedMalloc(content->trapCount * sizeof(Trap*), ALLOC_TRAP);
+    for (int i = 0; i < content->trapCount; i++) {
+        int x, y;
+        do {
+            x = randomInt(random, MAP_WIDTH);
+            y = randomInt(random, MAP_HEIGHT);
+        } while (isOccupied(content, x, y, content->enemyCount, i));
+
+        content->traps[i] = createTrap(x, y, random);
+        content->traps[i]->damage += level * balance->trapDamagePerLevel;
+    }
+
+    int itemsToPlace = 5 + randomInt(random, 6); // 5-10 przedmiotów na nowym poziomie
+    for (int i = 0; i < itemsToPlace && content->itemCount < MAX_GROUND_ITEMS; i++) {
+        int x, y;
+        do {
+            x = randomInt(random, MAP_WIDTH);
+            y = randomInt(random, MAP_HEIGHT);
+        } while (isOccupied(content, x, y, content->enemyCount, content->trapCount) || hasItemAt(content, x, y));
+
+        Item* item = NULL;
+        int itemType = randomInt(random, 100);
+        if (itemType < 40) { // 40% szansy na miksturę zdrowia
+            item = createHealthPotion();
+        }
+        else if (itemType < 45) { // 5% szansy na miksturę regeneracji
+            item = createRegenerationPotion();
+        }
+        else if (itemType < 50) { // 5% szansy na miksturę siły
+            item = createStrengthPotion();
+        }
+        else if (itemType < 75) { // 25% szansy na miecz
+            item = createSword(random);
+        }
+        else { // 25% szansy na zbroję
+            item = createArmor(random);
+        }
+        item->posX = x;
+        item->posY = y;
+        item->inInventory = 0;
+        content->items[content->itemCount++] = item;
+    }
+}
+
+void freeLevelContent(LevelContent* content) {
+    for (int i = 0; i < content->enemyCount; i++) {
+        trackedFree(content->enemies[i]);
+    }
+    trackedFree(content->enemies);
+    for (int i = 0; i < content->trapCount; i++) {
+        trackedFree(content->traps[i]);
+    }
+    trackedFree(content->traps);
+    for (int i = 0; i < content->itemCount; i++) {
+        trackedFree(content->items[i]);
+    }
+    memset(content, 0, sizeof(LevelContent));
+}
+
+static void runPrefetchWorker(LevelPrefetch* prefetch) {
+    std::unique_lock<std::mutex> lock(prefetch->mutex);
+    while (1) {
+        while (!prefetch->stop && !prefetch->requestedLevel && prefetch->retiredCount == 0) {
+            prefetch->wake.wait(lock);
+        }
+
+        // Stare poziomy najpierw - przy zamykaniu nic nie moze zostac
+        if (prefetch->retiredCount > 0) {
+            LevelContent old = prefetch->retired[--prefetch->retiredCount];
+            lock.unlock();
+            freeLevelContent(&old);
+            lock.lock();
+            continue;
+        }
+        if (prefetch->stop) break;
+
+        int level = prefetch->requestedLevel;
+        RandomState random = prefetch->random;
+        BalanceConfig balance = prefetch->balance;
+        prefetch->requestedLevel = 0;
+        prefetch->buildingLevel = level;
+        lock.unlock();
+
+        LevelContent content;
+        buildLevelContent(&content, level, &random, &balance);
+
+        lock.lock();
+        prefetch->ready = content;
+        prefetch->buildingLevel = 0;
+        prefetch->finished.notify_all();
+    }
+}
+
+void enableLevelPrefetch(GameWorld* world) {
+    if (world->prefetch || world->clone.start) return;
+
+    LevelPrefetch* prefetch = new LevelPrefetch();
+    prefetch->worker = std::thread(runPrefetchWorker, prefetch);
+    world->prefetch = prefetch;
+
+    // Wczytana gra moze miec juz otwarty portal
+    if (world->portalActive) {
+        requestLevelPrefetch(world);
+    }
+}
+
+// Oddaje gotowy poziom do zwolnienia w tle; wolac z zablokowanym mutexem
+static int queueRetired(LevelPrefetch* prefetch, LevelContent* content) {
+    if (prefetch->retiredCount >= PREFETCH_RETIRED_LEVELS) return 0;
+    prefetch->retired[prefetch->retiredCount++] = *content;
+    memset(content, 0, sizeof(LevelContent));
+    prefetch->wake.notify_one();
+    return 1;
+}
+
+void requestLevelPrefetch(GameWorld* world) {
+    LevelPrefetch* prefetch = world->prefetch;
+    if (!prefetch || world->level >= 3) return;
+
+    int level = world->level + 1;
+    LevelContent stale;
+    memset(&stale, 0, sizeof(LevelContent));
+    {
+        std::lock_guard<std::mutex> lock(prefetch->mutex);
+        if (prefetch->requestedLevel == level || prefetch->buildingLevel == level || prefetch->ready.level == level) {
+            return;
+        }
+        if (prefetch->ready.level != 0 && !queueRetired(prefetch, &prefetch->ready)) {
+            stale = prefetch->ready;
+            memset(&prefetch->ready, 0, sizeof(LevelContent));
+        }
+        prefetch->requestedLevel = level;
+        seedRandom(&prefetch->random, nextRandom64(&world->random));
+        prefetch->balance = world->balance;
+        prefetch->wake.notify_one();
+    }
+    if (stale.level != 0) freeLevelContent(&stale);
+}
+
+// 1 - out to gotowy nastepny poziom swiata. Czeka na budowe, ktora juz trwa
+// (i tak jest krotsza niz budowa od zera).
+int takePrefetchedLevel(GameWorld* world, LevelContent* out) {
+    LevelPrefetch* prefetch = world->prefetch;
+    if (!prefetch) return 0;
+
+    int level = world->level + 1;
+    std::unique_lock<std::mutex> lock(prefetch->mutex);
+    while (prefetch->buildingLevel || prefetch->requestedLevel) {
+        prefetch->finished.wait(lock);
+    }
+    if (prefetch->ready.level != level) return 0;
+
+    *out = prefetch->ready;
+    memset(&prefetch->ready, 0, sizeof(LevelContent));
+    return 1;
+}
+
+void retireLevelContent(GameWorld* world, LevelContent* old) {
+    LevelPrefetch* prefetch = world->prefetch;
+    if (prefetch) {
+        std::lock_guard<std::mutex> lock(prefetch->mutex);
+        if (queueRetired(prefetch, old)) return;
+    }
+
+    // Bez watku (albo z pelna kolejka) od razu; obiekty klonu zostaja w jego bloku
+    for (int i = 0; i < old->enemyCount; i++) {
+        freeWorldObject(&world->clone, old->enemies[i]);
+    }
+    freeWorldObject(&world->clone, old->enemies);
+    for (int i = 0; i < old->trapCount; i++) {
+        freeWorldObject(&world->clone, old->traps[i]);
+    }
+    freeWorldObject(&world->clone, old->traps);
+    for (int i = 0; i < old->itemCount; i++) {
+        freeWorldObject(&world->clone, old->items[i]);
+    }
+    memset(old, 0, sizeof(LevelContent));
+}
+
+void freeLevelPrefetch(LevelPrefetch* prefetch) {
+    if (!prefetch) return;
+    {
+        std::lock_guard<std::mutex> lock(prefetch->mutex);
+        prefetch->stop = 1;
+        prefetch->requestedLevel = 0;
+        prefetch->wake.notify_one();
+    }
+    prefetch->worker.join();
+    if (prefetch->ready.level != 0) {
+        freeLevelContent(&prefetch->ready);
+    }
+    delete prefetch;
+}
@@ -0,0 +1,134 @@
+﻿#include <string.h>
+#include "lz.h"
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 12
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)
+
+static unsigned int readU32(const unsigned char* p) {
+    unsigned int value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static int hashSequence(const unsigned char* p) {
+    return (int)((readU32(p) * 2654435761u) >> (32 - LZ_HASH_BITS));
+}
+
+// Dlugosc powyzej 15 zapisywana jako kolejne bajty 255 i reszta
+static unsigned char* writeLength(unsigned char* op, int length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (unsigned char)length;
+    return op;
+}
+
+int lzCompressBound(int size) {
+    return size + size / 255 + 16;
+}
+
+int lzCompress(const unsigned char* src, int size, unsigned char* dst, int capacity) {
+    if (capacity < lzCompressBound(size)) return 0;
+
+    int table[LZ_HASH_SIZE];
+    for (int i = 0; i < LZ_HASH_SIZE; i++) {
+        table[i] = -1;
+    }
+
+    const unsigned char* anchor = src;
+    unsigned char* op = dst;
+    int pos = 0;
+    const int matchLimit = size - LZ_MIN_MATCH;
+
+    while (pos <= matchLimit) {
+        int h = hashSequence(src + pos);
+        int candidate = table[h];
+        table[h] = pos;
+
+        if (candidate < 0 || pos - candidate > LZ_MAX_OFFSET || readU32(src + candidate) != readU32(src + pos)) {
+            pos++;
+            continue;
+        }
+
+        int matchLength = LZ_MIN_MATCH;
+        while (pos + matchLength < size && src[candidate + matchLength] == src[pos + matchLength]) {
+            matchLength++;
+        }
+
+        int literalLength = (int)(src + pos - anchor);
+        unsigned char* token = op++;
+        *token = (unsigned char)((literalLength >= 15 ? 15 : literalLength) << 4);
+        if (literalLength >= 15) op = writeLength(op, literalLength - 15);
+        memcpy(op, anchor, literalLength);
+        op += literalLength;
+
+        int offset = pos - candidate;
+        *op++ = (unsigned char)(offset & 0xFF);
+        *op++ = (unsigned char)(offset >> 8);
+
+        int extra = matchLength - LZ_MIN_MATCH;
+        *token |= (unsigned char)(extra >= 15 ? 15 : extra);
+        if (extra >= 15) op = writeLength(op, extra - 15);
+
+        pos += matchLength;
+        anchor = src + pos;
+    }
+
+    // Ostatnie literaly bez dopasowania
+    int literalLength = (int)(src + size - anchor);
+    *op++ = (unsigned char)((literalLength >= 15 ? 15 : literalLength) << 4);
+    if (literalLength >= 15) op = writeLength(op, literalLength - 15);
+    memcpy(op, anchor, literalLength);
+    op += literalLength;
+
+    return (int)(op - dst);
+}
+
+static int readLength(const unsigned char** ip, const unsigned char* end, int length) {
+    if (length != 15) return length;
+    unsigned char byte;
+    do {
+        if (*ip >= end) return -1;
+        byte = *(*ip)++;
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+int lzDecompress(const unsigned char* src, int size, unsigned char* dst, int capacity) {
+    const unsigned char* ip = src;
+    const unsigned char* end = src + size;
+    unsigned char* op = dst;
+    unsigned char* opEnd = dst + capacity;
+
+    while (ip < end) {
+        unsigned char token = *ip++;
+
+        int literalLength = readLength(&ip, end, token >> 4);
+        if (literalLength < 0 || literalLength > end - ip || literalLength > opEnd - op) return -1;
+        memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == end) break;  // Ostatnia sekwencja
+
+        if (end - ip < 2) return -1;
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        int matchLength = readLength(&ip, end, token & 15);
+        if (matchLength < 0) return -1;
+        matchLength += LZ_MIN_MATCH;
+        if (offset == 0 || offset > op - dst || matchLength > opEnd - op) return -1;
+
+        // Kopia bajt po bajcie - dopasowanie moze zachodzic na siebie
+        const unsigned char* match = op - offset;
+        for (int i = 0; i < matchLength; i++) {
+            op[i] = match[i];
+        }
+        op += matchLength;
+    }
+    return (int)(op - dst);
+}
@@ -0,0 +1,15 @@
+﻿#pragma once
+
+// Szybka kompresja LZ77 w stylu LZ4 dla sekcji pliku zapisu. Strumien to
+// ciag sekwencji: bajt tokenu (dlugosc literalow w starszych 4 bitach,
+// dlugosc dopasowania - 4 w mlodszych, 15 - dalsze bajty dlugosci), literaly,
+// 2 bajty przesuniecia wstecz. Ostatnia sekwencja ma tylko literaly.
+
+// Najwiekszy mozliwy rozmiar wyniku kompresji danych o rozmiarze size
+int lzCompressBound(int size);
+
+// Zwraca rozmiar skompresowanych danych albo 0, gdy nie mieszcza sie w dst
+int lzCompress(const unsigned char* src, int size, unsigned char* dst, int capacity);
+
+// Zwraca rozmiar rozpakowanych danych albo -1 dla uszkodzonego strumienia
+int lzDecompress(const unsigned char* src, int size, unsigned char* dst, int capacity);
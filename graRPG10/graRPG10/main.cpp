@@ -0,0 +1,211 @@
+﻿#include "graRPG10.h"
+#include "autoplayer.h"
+
+// Nowa gra - imie gracza czytane z konsoli
+static GameWorld* newGame() {
+    char name[50];
+    printf("Podaj swoje imie: ");
+    scanf_s("%49s", name, (unsigned)_countof(name));
+    return createGameWorld(name);
+}
+
+// Lista slotow tylko ze spisu - bez otwierania plikow zapisu
+static void printSaveSlots(const SaveIndex* index) {
+    for (int i = 0; i < SAVE_SLOT_COUNT; i++) {
+        const SaveSlotInfo* slot = &index->slots[i];
+        if (!slot->used) {
+            printf("%d. (pusty)\n", i + 1);
+            continue;
+        }
+        char date[32] = "?";
+        time_t timestamp = (time_t)slot->timestamp;
+        struct tm local;
+        if (localtime_s(&local, &timestamp) == 0) {
+            strftime(date, sizeof(date), "%Y-%m-%d %H:%M", &local);
+        }
+        printf("%d. %s - %s, poziom %d, zloto %d (%s)\n", i + 1, slot->slotName, slot->playerName,
+            slot->level, slot->gold, date);
+    }
+}
+
+// Numer slotu od 1 wpisany przez gracza; -1 - nieprawidlowy wybor
+static int chooseSaveSlot(const char* prompt) {
+    int slot;
+    printf("%s (1-%d): ", prompt, SAVE_SLOT_COUNT);
+    if (scanf_s("%d", &slot) != 1) slot = 0;
+    while (getchar() != '\n');
+    return slot >= 1 && slot <= SAVE_SLOT_COUNT ? slot - 1 : -1;
+}
+
+// Nowa gra w wybranym slocie - nazwa slotu domyslnie jest imieniem gracza
+static GameWorld* newGameInSlot(const SaveIndex* index) {
+    GameWorld* world = newGame();
+    while (getchar() != '\n');
+
+    printSaveSlots(index);
+    int slot = chooseSaveSlot("Slot zapisu");
+    world->saveSlot = slot >= 0 ? slot : 0;
+
+    char slotName[SAVE_SLOT_NAME_LENGTH];
+    printf("Nazwa zapisu (Enter - %s): ", world->saveSlotName);
+    if (fgets(slotName, sizeof(slotName), stdin)) {
+        slotName[strcspn(slotName, "\r\n")] = '\0';
+        if (slotName[0] != '\0') {
+            snprintf(world->saveSlotName, sizeof(world->saveSlotName), "%s", slotName);
+        }
+    }
+    return world;
+}
+
+// Gra prowadzona przez autogracza - mapa po kazdej turze, bez wejscia z konsoli
+static void runAutoplayGame(GameWorld* world, const AutoplayerConfig* config) {
+    Autoplayer* autoplayer = createAutoplayer(config);
+    if (!autoplayer) {
+        printf("Nie mozna utworzyc autogracza!\n");
+        return;
+    }
+    while (1) {
+        printMap(world);
+        autoplayerTurn(autoplayer, world);
+        journalTurn(world->journal, world);
+        presentEvents(world);
+        if (world->status != GAME_RUNNING) {
+            AutoplayerStats stats = autoplayerStats(autoplayer);
+            printf("Autogracz: %lld decyzji, %.0f rozgrywek/s\n", stats.decisions,
+                stats.searchSeconds > 0.0 ? stats.rollouts / stats.searchSeconds : 0.0);
+            freeAutoplayer(autoplayer);
+        }
+        finishGameIfOver(world);
+    }
+}
+
+#if defined(GRA_TRACK_ALLOC) || defined(GRA_FIXED_POOLS)
+// Po zwolnieniu swiata wszystko, co zostalo w raporcie, jest wyciekiem
+static void dumpMemtrackAtExit() {
+    printMemtrackReport(stdout);
+}
+#endif
+
+#ifdef GRA_PROFILE
+// Raport profilera przy kazdym wyjsciu z gry (Q, smierc, wygrana)
+static void dumpProfileAtExit() {
+    printProfileReport(stdout);
+    if (writeProfileJson("profile_metrics.json")) {
+        printf("Metryki profilera zapisano do profile_metrics.json\n");
+    }
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    srand((unsigned)time(NULL));
+    initStringTable();
+#ifdef GRA_PROFILE
+    atexit(dumpProfileAtExit);
+#endif
+#if defined(GRA_TRACK_ALLOC) || defined(GRA_FIXED_POOLS)
+    atexit(dumpMemtrackAtExit);
+#endif
+
+    if (argc > 1 && strcmp(argv[1], "--bench-inventory") == 0) {
+        runInventoryBenchmark();
+        return 0;
+    }
+
+    int realTime = 0;
+    int autosave = 1;
+    int autoplay = 0;
+    AutoplayerConfig autoplayConfig;
+    memset(&autoplayConfig, 0, sizeof(AutoplayerConfig));
+    FILE* eventLog = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--realtime") == 0) {
+            realTime = 1;
+        }
+        else if (strcmp(argv[i], "--auto") == 0) {
+            autoplay = 1;  // Ruchy i walki wybiera autogracz (MCTS)
+        }
+        else if (strcmp(argv[i], "--auto-ms") == 0 && i + 1 < argc) {
+            autoplayConfig.budgetMs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--auto-threads") == 0 && i + 1 < argc) {
+            autoplayConfig.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--no-autosave") == 0) {
+            autosave = 0;
+        }
+        else if (strcmp(argv[i], "--raw-saves") == 0) {
+            saveCompression = 0;  // Sekcje zapisu bez kompresji LZ
+        }
+        else if (strcmp(argv[i], "--event-log") == 0 && i + 1 < argc) {
+            // Zapis wszystkich zdarzen rozgrywki do pliku CSV
+            if (fopen_s(&eventLog, argv[++i], "w") != 0) {
+                printf("Nie mozna otworzyc pliku logu zdarzen!\n");
+                eventLog = NULL;
+            }
+        }
+    }
+
+    subscribeEvents(renderEventToConsole, NULL);
+    subscribeEvents(collectEventStats, &sessionStats);
+    if (eventLog) {
+        subscribeEvents(logEventToFile, eventLog);
+    }
+
+    GameWorld* world = NULL;
+    SaveIndex index;
+    readSaveIndex(&index);
+
+    printf("1. Nowa gra\n2. Wczytaj gre\nWybierz: ");
+    int choice;
+    scanf_s("%d", &choice);
+    while (getchar() != '\n');
+
+    if (choice == 1) {
+        world = newGameInSlot(&index);
+    }
+    else if (choice == 2) {
+        printSaveSlots(&index);
+        int slot = chooseSaveSlot("Wczytaj slot");
+        world = slot >= 0 ? loadGame(slot) : NULL;
+        if (world == NULL) {
+            printf("Tworzenie nowej gry...\n");
+            Sleep(1000);
+            world = newGameInSlot(&index);
+        }
+    }
+    else {
+        printf("Nieprawidlowy wybor. Tworzenie nowej gry...\n");
+        Sleep(1000);
+        world = newGameInSlot(&index);
+    }
+
+    // Autozapis: pelny zapis teraz, potem dziennik zmian po kazdej turze
+    if (autosave) {
+        char savePath[64];
+        char journalPath[64];
+        saveSlotPath(world->saveSlot, savePath, sizeof(savePath));
+        journalSlotPath(world->saveSlot, journalPath, sizeof(journalPath));
+        world->journal = openSaveJournal(world, savePath, journalPath);
+        if (!world->journal) {
+            printf("Nie mozna utworzyc autozapisu - gra bez autozapisu.\n");
+            Sleep(1000);
+        }
+    }
+
+    // Nastepny poziom budowany w tle od otwarcia portalu
+    enableLevelPrefetch(world);
+
+    if (autoplay) {
+        runAutoplayGame(world, &autoplayConfig);
+    }
+    if (realTime) {
+        runRealTimeGame(world);
+    }
+
+    while (1) {
+        printMap(world);
+        movePlayerAndEnemy(world);
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+﻿#include "memtrack.h"
+
+#ifdef GRA_TRACK_ALLOC
+
+#include <mutex>
+#include <string.h>
+
+#define MAX_TRACKED_LEVELS 8
+
+// Naglowek przed kazdym blokiem - lista zywych blokow pozwala policzyc,
+// co zostalo po zakonczeniu poziomu
+struct alignas(16) AllocHeader {
+    AllocHeader* prev;
+    AllocHeader* next;
+    size_t size;
+    int tag;
+    int level;
+    long long epoch;  // Kolejne wejscie na poziom - odroznia ten sam poziom w nowej grze
+};
+
+typedef struct {
+    long long entered;
+    long long bytesAllocated;
+    long long peakLiveBytes;
+    long long retainedBlocks[ALLOC_TAG_COUNT];  // Bloki zywe po opuszczeniu poziomu
+} LevelAllocStats;
+
+static const char* tagNames[ALLOC_TAG_COUNT] = {
+    "przedmioty",
+    "przeciwnicy",
+    "pulapki",
+    "mapa",
+    "ekwipunek",
+    "gracz",
+    "swiat",
+    "zdarzenia",
+    "zapis"
+};
+
+static std::mutex trackerMutex;
+static AllocHeader* liveList = NULL;
+static AllocTagStats tagStats[ALLOC_TAG_COUNT];
+static LevelAllocStats levelStats[MAX_TRACKED_LEVELS + 1];
+static long long liveBytes = 0;
+static long long peakBytes = 0;
+static int currentLevel = 0;
+static long long currentEpoch = 0;
+
+static int levelSlot(int level) {
+    if (level < 0) return 0;
+    return level > MAX_TRACKED_LEVELS ? MAX_TRACKED_LEVELS : level;
+}
+
+static void* registerBlock(AllocHeader* header, size_t size, AllocTag tag) {
+    header->size = size;
+    header->tag = tag;
+    header->level = currentLevel;
+    header->epoch = currentEpoch;
+    header->prev = NULL;
+    header->next = liveList;
+    if (liveList) liveList->prev = header;
+    liveList = header;
+
+    AllocTagStats* stats = &tagStats[tag];
+    stats->liveBytes += size;
+    stats->liveBlocks++;
+    stats->totalAllocs++;
+    if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+
+    liveBytes += size;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+
+    LevelAllocStats* level = &levelStats[levelSlot(currentLevel)];
+    level->bytesAllocated += size;
+    if (liveBytes > level->peakLiveBytes) level->peakLiveBytes = liveBytes;
+
+    return header + 1;
+}
+
+void* trackedMalloc(size_t size, AllocTag tag) {
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    AllocHeader* header = (AllocHeader*)malloc(sizeof(AllocHeader) + size);
+    if (!header) return NULL;
+
+    std::lock_guard<std::mutex> lock(trackerMutex);
+    return registerBlock(header, size, tag);
+}
+
+void* trackedCalloc(size_t count, size_t size, AllocTag tag) {
+    void* ptr = trackedMalloc(count * size, tag);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void trackedFree(void* ptr) {
+    if (!ptr) return;
+
+    AllocHeader* header = (AllocHeader*)ptr - 1;
+    {
+        std::lock_guard<std::mutex> lock(trackerMutex);
+        if (header->prev) header->prev->next = header->next;
+        else liveList = header->next;
+        if (header->next) header->next->prev = header->prev;
+
+        AllocTagStats* stats = &tagStats[header->tag];
+        stats->liveBytes -= header->size;
+        stats->liveBlocks--;
+        liveBytes -= header->size;
+    }
+    free(header);
+}
+
+// Zamyka biezacy poziom (liczac bloki, ktore go przezyly) i otwiera nowy
+void memtrackBeginLevel(int level) {
+    std::lock_guard<std::mutex> lock(trackerMutex);
+
+    if (currentEpoch > 0) {
+        LevelAllocStats* previous = &levelStats[levelSlot(currentLevel)];
+        for (AllocHeader* header = liveList; header; header = header->next) {
+            if (header->epoch == currentEpoch) {
+                previous->retainedBlocks[header->tag]++;
+            }
+        }
+    }
+
+    currentEpoch++;
+    currentLevel = level;
+    LevelAllocStats* stats = &levelStats[levelSlot(level)];
+    stats->entered++;
+    if (liveBytes > stats->peakLiveBytes) stats->peakLiveBytes = liveBytes;
+}
+
+AllocTagStats memtrackTagStats(AllocTag tag) {
+    std::lock_guard<std::mutex> lock(trackerMutex);
+    return tagStats[tag];
+}
+
+long long memtrackLiveBytes() {
+    std::lock_guard<std::mutex> lock(trackerMutex);
+    return liveBytes;
+}
+
+long long memtrackPeakBytes() {
+    std::lock_guard<std::mutex> lock(trackerMutex);
+    return peakBytes;
+}
+
+void printMemtrackReport(FILE* out) {
+    std::lock_guard<std::mutex> lock(trackerMutex);
+
+    fprintf(out, "==== PAMIEC (zywe %lld B, szczyt %lld B) ====\n", liveBytes, peakBytes);
+    fprintf(out, "%-12s %12s %12s %10s %12s\n", "podsystem", "zywe B", "szczyt B", "bloki", "alokacje");
+    for (int i = 0; i < ALLOC_TAG_COUNT; i++) {
+        fprintf(out, "%-12s %12lld %12lld %10lld %12lld\n", tagNames[i], tagStats[i].liveBytes,
+            tagStats[i].peakBytes, tagStats[i].liveBlocks, tagStats[i].totalAllocs);
+    }
+
+    // Przeciwnicy, pulapki i mapa nie powinni przezyc poziomu; przedmioty
+    // z ekwipunku przechodza na kolejny poziom i sa tu liczone zgodnie z zamiarem
+    fprintf(out, "%-7s %8s %14s %14s %12s %12s %12s\n", "poziom", "wejscia", "alokowano B", "szczyt B",
+        "przedmioty", "przeciwnicy", "pulapki");
+    for (int i = 1; i <= MAX_TRACKED_LEVELS; i++) {
+        const LevelAllocStats* stats = &levelStats[i];
+        if (stats->entered == 0) continue;
+        fprintf(out, "%-7d %8lld %14lld %14lld %12lld %12lld %12lld\n", i, stats->entered,
+            stats->bytesAllocated, stats->peakLiveBytes, stats->retainedBlocks[ALLOC_ITEM],
+            stats->retainedBlocks[ALLOC_ENEMY], stats->retainedBlocks[ALLOC_TRAP]);
+    }
+}
+
+#endif
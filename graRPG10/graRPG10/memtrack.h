@@ -0,0 +1,93 @@
+﻿#pragma once
+
+// Alokacje obiektow gry oznaczone podsystemem. Z GRA_TRACK_ALLOC kazdy blok
+// dostaje naglowek z rozmiarem, znacznikiem i poziomem gry, a tracker liczy
+// zywe i szczytowe bajty oraz bloki, ktore przezyly swoj poziom. Z
+// GRA_FIXED_POOLS bloki pochodza z pul w statycznej arenie (fixedpool.cpp) i
+// sterta nie jest uzywana wcale. Bez tych definicji funkcje sa zwyklymi
+// malloc/calloc/free.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "profiler.h"
+
+typedef enum {
+    ALLOC_ITEM,
+    ALLOC_ENEMY,
+    ALLOC_TRAP,
+    ALLOC_MAP,
+    ALLOC_INVENTORY,
+    ALLOC_PLAYER,
+    ALLOC_WORLD,
+    ALLOC_EVENTS,
+    ALLOC_SAVE,
+    ALLOC_TAG_COUNT
+} AllocTag;
+
+typedef struct {
+    long long liveBytes;
+    long long peakBytes;
+    long long liveBlocks;
+    long long totalAllocs;
+} AllocTagStats;
+
+#if defined(GRA_TRACK_ALLOC) && defined(GRA_FIXED_POOLS)
+#error "GRA_TRACK_ALLOC i GRA_FIXED_POOLS wykluczaja sie - oba dostarczaja trackedMalloc"
+#endif
+
+#if defined(GRA_TRACK_ALLOC) || defined(GRA_FIXED_POOLS)
+
+void* trackedMalloc(size_t size, AllocTag tag);
+void* trackedCalloc(size_t count, size_t size, AllocTag tag);
+void trackedFree(void* ptr);
+
+AllocTagStats memtrackTagStats(AllocTag tag);
+long long memtrackLiveBytes();
+long long memtrackPeakBytes();
+void printMemtrackReport(FILE* out);
+
+#endif
+
+#ifdef GRA_TRACK_ALLOC
+
+void memtrackBeginLevel(int level);
+
+#elif defined(GRA_FIXED_POOLS)
+
+// Stan areny pul stalych
+typedef struct {
+    long long arenaBytes;    // Rozmiar areny (stala kompilacji)
+    long long carvedBytes;   // Wykrojone z areny - nigdy nie wracaja, bloki kraza w pulach
+    long long poolAllocs;    // Alokacje obsluzone z pul
+    long long failedAllocs;  // Brak miejsca w arenie - trackedMalloc zwrocil NULL
+} FixedPoolStats;
+
+FixedPoolStats fixedPoolStats();
+
+static inline void memtrackBeginLevel(int level) {
+    (void)level;
+}
+
+#else
+
+static inline void* trackedMalloc(size_t size, AllocTag tag) {
+    (void)tag;
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    return malloc(size);
+}
+
+static inline void* trackedCalloc(size_t count, size_t size, AllocTag tag) {
+    (void)tag;
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    return calloc(count, size);
+}
+
+static inline void trackedFree(void* ptr) {
+    free(ptr);
+}
+
+static inline void memtrackBeginLevel(int level) {
+    (void)level;
+}
+
+#endif
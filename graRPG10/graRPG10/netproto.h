@@ -0,0 +1,85 @@
+﻿#pragma once
+
+// Binarny protokol serwera wieloosobowego. Kazda wiadomosc to 2 bajty dlugosci
+// (bez nich samych), 1 bajt typu i dane. Liczby sa little-endian.
+//
+// Klient -> serwer:
+//   NET_HELLO    u8 dlugosc imienia, imie
+//   NET_COMMAND  u16 numer polecenia, u8 polecenie (w/a/s/d/p/i jak w grze, bez zapisu 'z')
+// Serwer -> klient:
+//   NET_WELCOME  u16 id gracza, u16 szerokosc mapy, u16 wysokosc mapy, u16 ms na tick
+//   NET_TICK     u32 tick, u8 flagi (NET_TICK_*), rekordy zmian (NET_RECORD_*)
+//   NET_ACK      u16 numer polecenia, u32 tick, w ktorym je wykonano
+//   NET_INVENTORY u8 liczba, przedmioty: u16 nazwa, u8 kategoria, u8 x, u8 y
+//   NET_DIED     u32 tick - serwer zamyka potem polaczenie
+//
+// Rekordy NET_TICK (po bajcie rodzaju):
+//   NET_RECORD_WORLD  u8 poziom, u8 portal aktywny, u16 x, u16 y portalu,
+//                     u16 przeciwnicy, u16 pulapki
+//   NET_RECORD_PLAYER u16 id, u16 x, u16 y, i16 zdrowie, i32 zloto
+//   NET_RECORD_LEAVE  u8 rodzaj rekordu obiektu, u16 id lub indeks
+//   NET_RECORD_ENEMY  u16 indeks, u16 x, u16 y, i16 zdrowie
+//   NET_RECORD_TRAP   u16 indeks, u16 x, u16 y (tylko odkryte pulapki)
+//   NET_RECORD_ITEM   u16 indeks, u16 x, u16 y, u8 symbol (przedmiot na ziemi)
+//
+// Klient dostaje tylko obiekty ze swojego pola widzenia (kwadrat wokol gracza,
+// ServerConfig.viewRadius): rekord obiektu, ktory wszedl w pole widzenia albo
+// sie w nim zmienil, i NET_RECORD_LEAVE, gdy obiekt z niego zniknal (wyszedl,
+// zginal, zmienil sie poziom). Tick z flaga NET_TICK_FULL jest pierwszym
+// tickiem klienta i zawiera wszystko w jego polu widzenia oraz NET_RECORD_WORLD.
+// Tick wiekszy niz jedna wiadomosc jest dzielony - kolejne czesci maja flage
+// NET_TICK_CONTINUED.
+
+#define NET_DEFAULT_PORT 47000
+#define NET_MAX_MESSAGE 65535
+#define NET_HEADER_SIZE 3
+
+typedef enum {
+    NET_HELLO = 1,
+    NET_COMMAND,
+    NET_WELCOME = 16,
+    NET_TICK,
+    NET_ACK,
+    NET_INVENTORY,
+    NET_DIED
+} NetMessageType;
+
+#define NET_TICK_FULL 0x01
+#define NET_TICK_CONTINUED 0x02
+#define NET_TICK_LEVEL_WON 0x04  // Ktos przeszedl ostatni poziom - swiat zaczyna od nowa
+
+typedef enum {
+    NET_RECORD_WORLD = 1,
+    NET_RECORD_PLAYER,
+    NET_RECORD_LEAVE,
+    NET_RECORD_ENEMY,
+    NET_RECORD_TRAP,
+    NET_RECORD_ITEM
+} NetRecordType;
+
+static inline unsigned char* netPutU8(unsigned char* p, unsigned int value) {
+    p[0] = (unsigned char)value;
+    return p + 1;
+}
+
+static inline unsigned char* netPutU16(unsigned char* p, unsigned int value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    return p + 2;
+}
+
+static inline unsigned char* netPutU32(unsigned char* p, unsigned int value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+    return p + 4;
+}
+
+static inline unsigned int netGetU16(const unsigned char* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static inline unsigned int netGetU32(const unsigned char* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
@@ -0,0 +1,170 @@
+﻿#include <chrono>
+#include <thread>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+
+#ifdef _WIN32
+#include <conio.h>
+#include <io.h>
+#else
+#include <termios.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+static int rawInputEnabled = 0;
+static int rawInputAtExit = 0;
+
+#ifdef _WIN32
+static DWORD savedConsoleMode;
+#else
+static struct termios savedTermios;
+static int savedFileFlags;
+#endif
+
+void clearScreen() {
+#ifdef _WIN32
+    system("cls");
+#else
+    // Kursor na poczatek i czyszczenie ekranu bez uruchamiania powloki
+    fputs("\x1b[H\x1b[2J", stdout);
+    fflush(stdout);
+#endif
+}
+
+void enableRawInput() {
+    if (rawInputEnabled) return;
+
+#ifdef _WIN32
+    // Sekwencje ANSI dla renderowania w czasie rzeczywistym
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    GetConsoleMode(out, &savedConsoleMode);
+    SetConsoleMode(out, savedConsoleMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#else
+    tcgetattr(STDIN_FILENO, &savedTermios);
+    struct termios raw = savedTermios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+    savedFileFlags = fcntl(STDIN_FILENO, F_GETFL, 0);
+    fcntl(STDIN_FILENO, F_SETFL, savedFileFlags | O_NONBLOCK);
+#endif
+
+    // Ukryj kursor
+    fputs("\x1b[?25l", stdout);
+    fflush(stdout);
+
+    rawInputEnabled = 1;
+    if (!rawInputAtExit) {
+        // exit(0) w logice gry nie moze zostawic terminala w trybie surowym
+        atexit(disableRawInput);
+        rawInputAtExit = 1;
+    }
+}
+
+void disableRawInput() {
+    if (!rawInputEnabled) return;
+
+#ifdef _WIN32
+    SetConsoleMode(GetStdHandle(STD_OUTPUT_HANDLE), savedConsoleMode);
+#else
+    tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+    fcntl(STDIN_FILENO, F_SETFL, savedFileFlags);
+#endif
+
+    fputs("\x1b[?25h", stdout);
+    fflush(stdout);
+    rawInputEnabled = 0;
+}
+
+int isRawInputEnabled() {
+    return rawInputEnabled;
+}
+
+int pollKey() {
+#ifdef _WIN32
+    if (_kbhit()) {
+        return _getch();
+    }
+    return -1;
+#else
+    unsigned char c;
+    if (read(STDIN_FILENO, &c, 1) == 1) {
+        return c;
+    }
+    return -1;
+#endif
+}
+
+double nowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+void sleepSeconds(double seconds) {
+    if (seconds > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    }
+}
+
+int syncFile(FILE* file) {
+    if (fflush(file) != 0) return 0;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Atomowa podmiana - czytelnik widzi stary albo nowy plik, nigdy polowe
+int replaceFile(const char* from, const char* to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+int listFiles(const char* directory, FileVisitor visit, void* context) {
+    char path[1024];
+#ifdef _WIN32
+    char pattern[1024];
+    snprintf(pattern, sizeof(pattern), "%s\\*", directory);
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find == INVALID_HANDLE_VALUE) return 0;
+    do {
+        if (strcmp(entry.cFileName, ".") == 0 || strcmp(entry.cFileName, "..") == 0) continue;
+        snprintf(path, sizeof(path), "%s\\%s", directory, entry.cFileName);
+        if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            listFiles(path, visit, context);
+        }
+        else {
+            visit(path, context);
+        }
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory);
+    if (!dir) return 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+        struct stat info;
+        if (stat(path, &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) {
+            listFiles(path, visit, context);
+        }
+        else if (S_ISREG(info.st_mode)) {
+            visit(path, context);
+        }
+    }
+    closedir(dir);
+#endif
+    return 1;
+}
@@ -0,0 +1,58 @@
+﻿#pragma once
+
+// Warstwa zgodnosci Windows / Linux: terminal, czas i funkcje *_s z CRT Microsoftu
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static inline void Sleep(unsigned int milliseconds) {
+    usleep(milliseconds * 1000u);
+}
+
+static inline int fopen_s(FILE** file, const char* path, const char* mode) {
+    *file = fopen(path, mode);
+    return *file ? 0 : 1;
+}
+
+static inline int localtime_s(struct tm* out, const time_t* time) {
+    return localtime_r(time, out) ? 0 : 1;
+}
+
+// vscanf pomija argumenty rozmiaru bufora z wywolan scanf_s - makro na
+// scanf dawaloby ostrzezenia o nadmiarowych argumentach formatu
+static inline int scanf_s(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int result = vscanf(format, args);
+    va_end(args);
+    return result;
+}
+#define _countof(array) (sizeof(array) / sizeof((array)[0]))
+#endif
+
+void clearScreen();
+
+// Tryb surowego terminala: bez echa, bez buforowania linii, nieblokujacy odczyt
+void enableRawInput();
+void disableRawInput();
+int isRawInputEnabled();
+int pollKey();  // -1 gdy zaden klawisz nie czeka
+
+double nowSeconds();  // Zegar monotoniczny
+void sleepSeconds(double seconds);
+
+// Pliki: wymuszenie zapisu na dysk i podmiana pliku docelowego jednym ruchem
+int syncFile(FILE* file);
+int replaceFile(const char* from, const char* to);
+
+// Rekurencyjne przejscie katalogu - visit dostaje sciezke kazdego zwyklego pliku.
+// Zwraca 0, gdy katalogu nie da sie otworzyc.
+typedef void (*FileVisitor)(const char* path, void* context);
+int listFiles(const char* directory, FileVisitor visit, void* context);
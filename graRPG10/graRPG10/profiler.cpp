@@ -0,0 +1,166 @@
+﻿#include "profiler.h"
+
+#ifdef GRA_PROFILE
+
+#include <string.h>
+#include "platform.h"
+
+// Histogram logarytmiczny czasow w nanosekundach: wartosci ponizej 16 ns maja
+// wlasne kubelki, wieksze - 8 kubelkow na kazda potege dwojki (blad < 12.5%).
+#define HISTOGRAM_LINEAR 16
+#define HISTOGRAM_SUB_BUCKETS 8
+#define HISTOGRAM_MAX_OCTAVE 40
+#define HISTOGRAM_BUCKETS (HISTOGRAM_LINEAR + (HISTOGRAM_MAX_OCTAVE - 3) * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct {
+    unsigned int buckets[HISTOGRAM_BUCKETS];
+    long long samples;
+    double total;
+    double max;
+} PhaseHistogram;
+
+typedef struct {
+    PhaseHistogram phases[PHASE_COUNT];
+    long long counters[COUNTER_COUNT];
+    long long turnCounters[COUNTER_COUNT];  // Wartosci w biezacej turze
+    long long maxPerTurn[COUNTER_COUNT];
+    long long turns;
+} Profiler;
+
+static Profiler profiler;
+
+static const char* phaseNames[PHASE_COUNT] = {
+    "turn",
+    "input",
+    "player_move",
+    "check_traps",
+    "enemy_move",
+    "combat",
+    "reload_map",
+    "render"
+};
+
+static const char* counterNames[COUNTER_COUNT] = {
+    "allocations",
+    "entities",
+    "tiles"
+};
+
+static int octaveOf(unsigned long long value) {
+    int octave = 0;
+    while (value >>= 1) octave++;
+    return octave;
+}
+
+static int bucketIndex(unsigned long long ns) {
+    if (ns < HISTOGRAM_LINEAR) {
+        return (int)ns;
+    }
+    int octave = octaveOf(ns);
+    if (octave > HISTOGRAM_MAX_OCTAVE) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+    int sub = (int)((ns >> (octave - 3)) & (HISTOGRAM_SUB_BUCKETS - 1));
+    return HISTOGRAM_LINEAR + (octave - 4) * HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+// Srodek przedzialu kubelka w nanosekundach
+static double bucketValue(int index) {
+    if (index < HISTOGRAM_LINEAR) {
+        return (double)index;
+    }
+    int octave = (index - HISTOGRAM_LINEAR) / HISTOGRAM_SUB_BUCKETS + 4;
+    int sub = (index - HISTOGRAM_LINEAR) % HISTOGRAM_SUB_BUCKETS;
+    double width = (double)(1ULL << (octave - 3));
+    return (double)(1ULL << octave) + width * sub + width / 2.0;
+}
+
+static double percentile(const PhaseHistogram* histogram, double fraction) {
+    if (histogram->samples == 0) return 0.0;
+
+    long long target = (long long)(fraction * (double)histogram->samples);
+    if (target >= histogram->samples) target = histogram->samples - 1;
+
+    long long seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen > target) {
+            // Srodek kubelka moze przekroczyc najwiekszy zmierzony czas
+            double value = bucketValue(i);
+            return value < histogram->max * 1e9 ? value : histogram->max * 1e9;
+        }
+    }
+    return histogram->max * 1e9;
+}
+
+double profileNow() {
+    return nowSeconds();
+}
+
+void profileRecord(ProfilePhase phase, double seconds) {
+    PhaseHistogram* histogram = &profiler.phases[phase];
+    double ns = seconds * 1e9;
+    histogram->buckets[bucketIndex(ns > 0.0 ? (unsigned long long)ns : 0)]++;
+    histogram->samples++;
+    histogram->total += seconds;
+    if (seconds > histogram->max) histogram->max = seconds;
+}
+
+void profileCount(ProfileCounter counter, long long amount) {
+    profiler.counters[counter] += amount;
+    profiler.turnCounters[counter] += amount;
+}
+
+void profileEndTurn() {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (profiler.turnCounters[i] > profiler.maxPerTurn[i]) {
+            profiler.maxPerTurn[i] = profiler.turnCounters[i];
+        }
+        profiler.turnCounters[i] = 0;
+    }
+    profiler.turns++;
+}
+
+void printProfileReport(FILE* out) {
+    fprintf(out, "==== PROFIL TURY (%lld tur) ====\n", profiler.turns);
+    fprintf(out, "%-12s %10s %12s %12s %12s %12s\n", "faza", "proby", "srednio us", "p50 us", "p99 us", "max us");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        const PhaseHistogram* histogram = &profiler.phases[i];
+        double mean = histogram->samples ? histogram->total / histogram->samples : 0.0;
+        fprintf(out, "%-12s %10lld %12.2f %12.2f %12.2f %12.2f\n", phaseNames[i], histogram->samples,
+            mean * 1e6, percentile(histogram, 0.50) / 1e3, percentile(histogram, 0.99) / 1e3,
+            histogram->max * 1e6);
+    }
+    fprintf(out, "%-12s %14s %14s %14s\n", "licznik", "suma", "na ture", "max na ture");
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        fprintf(out, "%-12s %14lld %14.1f %14lld\n", counterNames[i], profiler.counters[i],
+            profiler.turns ? (double)profiler.counters[i] / profiler.turns : 0.0, profiler.maxPerTurn[i]);
+    }
+}
+
+int writeProfileJson(const char* path) {
+    FILE* file;
+    if (fopen_s(&file, path, "w") != 0) {
+        return 0;
+    }
+
+    fprintf(file, "{\n  \"turns\": %lld,\n  \"phases\": {\n", profiler.turns);
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        const PhaseHistogram* histogram = &profiler.phases[i];
+        fprintf(file, "    \"%s\": { \"samples\": %lld, \"total_us\": %.2f, \"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f }%s\n",
+            phaseNames[i], histogram->samples, histogram->total * 1e6,
+            percentile(histogram, 0.50) / 1e3, percentile(histogram, 0.99) / 1e3, histogram->max * 1e6,
+            i + 1 < PHASE_COUNT ? "," : "");
+    }
+    fprintf(file, "  },\n  \"counters\": {\n");
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        fprintf(file, "    \"%s\": { \"total\": %lld, \"max_per_turn\": %lld }%s\n",
+            counterNames[i], profiler.counters[i], profiler.maxPerTurn[i],
+            i + 1 < COUNTER_COUNT ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,57 @@
+﻿#pragma once
+
+// Profiler faz tury. Wlaczany przy kompilacji przez GRA_PROFILE - bez tej
+// definicji makra PROFILE_* nie generuja zadnego kodu.
+
+#include <stdio.h>
+
+typedef enum {
+    PHASE_TURN,           // Cala tura (lacznie z fazami ponizej)
+    PHASE_INPUT,          // Odczyt i parsowanie polecenia gracza
+    PHASE_PLAYER_MOVE,    // Polecenie gracza razem z pulapkami i portalem
+    PHASE_TRAPS,          // checkTraps
+    PHASE_ENEMY_MOVE,     // Ruch przeciwnikow
+    PHASE_COMBAT,         // Walki (razem z oczekiwaniem na decyzje gracza)
+    PHASE_RELOAD_MAP,     // reloadMap
+    PHASE_RENDER,         // printMap / klatka trybu czasu rzeczywistego
+    PHASE_COUNT
+} ProfilePhase;
+
+typedef enum {
+    COUNTER_ALLOCATIONS,  // Alokacje obiektow gry (przedmioty, przeciwnicy, pulapki)
+    COUNTER_ENTITIES,     // Przeciwnicy, pulapki i przedmioty odwiedzone w petlach
+    COUNTER_TILES,        // Pola mapy zapisane lub wypisane
+    COUNTER_COUNT
+} ProfileCounter;
+
+#ifdef GRA_PROFILE
+
+void profileRecord(ProfilePhase phase, double seconds);
+void profileCount(ProfileCounter counter, long long amount);
+void profileEndTurn();
+void printProfileReport(FILE* out);
+int writeProfileJson(const char* path);
+double profileNow();
+
+// Pomiar czasu od utworzenia do konca zakresu
+struct ProfileScope {
+    ProfilePhase phase;
+    double start;
+
+    explicit ProfileScope(ProfilePhase p) : phase(p), start(profileNow()) {}
+    ~ProfileScope() { profileRecord(phase, profileNow() - start); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#define PROFILE_COUNT(counter, amount) profileCount(counter, amount)
+#define PROFILE_END_TURN() profileEndTurn()
+
+#else
+
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_COUNT(counter, amount) ((void)0)
+#define PROFILE_END_TURN() ((void)0)
+
+#endif
@@ -0,0 +1,303 @@
+﻿#include <math.h>
+#include "graRPG10.h"
+
+// Tryb czasu rzeczywistego: symulacja w stalym kroku (tick) niezalezna od
+// renderowania, nieblokujace wejscie i interpolacja pozycji miedzy tickami.
+
+#define REALTIME_TICK_RATE 10     // Tickow symulacji na sekunde
+#define REALTIME_FRAME_RATE 30    // Docelowa liczba klatek na sekunde
+#define REALTIME_MAX_FRAME 0.25   // Dluzsza klatka nie jest nadrabiana tickami
+#define FRAME_HISTORY 64
+#define CELL_WIDTH 3              // Szerokosc pola mapy w znakach (" E ")
+#define MESSAGE_LINES 4           // Ostatnie komunikaty wyswietlane pod mapa
+#define MESSAGE_LENGTH 256
+
+typedef struct {
+    double frameTimes[FRAME_HISTORY];  // Ostatnie czasy klatek (s)
+    int frameCount;
+    int frameIndex;
+    double tickWindowStart;
+    int ticksInWindow;
+    double measuredTickRate;
+    double tickCostTotal;              // Czas samej symulacji w oknie pomiaru
+    double tickCost;
+} RealTimeStats;
+
+typedef struct {
+    int prevPlayerX;
+    int prevPlayerY;
+    RealTimeStats stats;
+    char messages[MESSAGE_LINES][MESSAGE_LENGTH];  // Bufor cykliczny komunikatow
+    int messageCount;
+} RealTimeState;
+
+static void recordFrame(RealTimeStats* stats, double frameTime) {
+    stats->frameTimes[stats->frameIndex] = frameTime;
+    stats->frameIndex = (stats->frameIndex + 1) % FRAME_HISTORY;
+    if (stats->frameCount < FRAME_HISTORY) stats->frameCount++;
+}
+
+static void recordTick(RealTimeStats* stats, double now, double cost) {
+    stats->ticksInWindow++;
+    stats->tickCostTotal += cost;
+    double elapsed = now - stats->tickWindowStart;
+    if (elapsed >= 1.0) {
+        stats->measuredTickRate = stats->ticksInWindow / elapsed;
+        stats->tickCost = stats->tickCostTotal / stats->ticksInWindow;
+        stats->ticksInWindow = 0;
+        stats->tickCostTotal = 0.0;
+        stats->tickWindowStart = now;
+    }
+}
+
+static int isMoveKey(char key) {
+    return key == 'w' || key == 'W' || key == 's' || key == 'S' ||
+        key == 'a' || key == 'A' || key == 'd' || key == 'D';
+}
+
+// Subskrybent zdarzen - komunikaty trafiaja do ramki zamiast blokowac petle
+static void logEventToFrame(const GameEvent* event, void* context) {
+    RealTimeState* rt = (RealTimeState*)context;
+    char text[256];
+    formatEvent(event, text, sizeof(text));
+
+    char* line = text;
+    while (line && *line) {
+        char* next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        snprintf(rt->messages[rt->messageCount % MESSAGE_LINES], MESSAGE_LENGTH, "%s", line);
+        rt->messageCount++;
+        line = next;
+    }
+}
+
+// Menu, walka i zapis czytaja wejscie liniami - na ten czas wracamy do zwyklego
+// terminala i zdarzenia znow wypisuje renderer konsolowy
+static void suspendRealTime() {
+    unsubscribeEvents(logEventToFrame);
+    subscribeEvents(renderEventToConsole, NULL);
+    disableRawInput();
+    clearScreen();
+}
+
+static void resumeRealTime(GameWorld* world, RealTimeState* rt) {
+    presentEvents(world);
+    unsubscribeEvents(renderEventToConsole);
+    subscribeEvents(logEventToFrame, rt);
+    enableRawInput();
+    clearScreen();
+}
+
+static void simulateTick(GameWorld* world, RealTimeState* rt, char command) {
+    rt->prevPlayerX = world->player->posX;
+    rt->prevPlayerY = world->player->posY;
+    for (int i = 0; i < world->enemyCount; i++) {
+        world->enemies[i]->prevX = world->enemies[i]->EposX;
+        world->enemies[i]->prevY = world->enemies[i]->EposY;
+    }
+
+    world->turn++;
+    if (command) {
+        if (isMenuCommand(command)) {
+            suspendRealTime();
+            handleMenuCommand(world, command);
+            resumeRealTime(world, rt);
+        }
+        else if (isMoveKey(command) || command == 'p' || command == 'P') {
+            PROFILE_SCOPE(PHASE_PLAYER_MOVE);
+            applyPlayerCommand(world, command);
+        }
+    }
+    if (world->status != GAME_RUNNING) {
+        return;
+    }
+
+    // Przeciwnicy poruszaja sie we wlasnym rytmie, niezaleznie od gracza
+    {
+        PROFILE_SCOPE(PHASE_ENEMY_MOVE);
+        PROFILE_COUNT(COUNTER_ENTITIES, world->enemyCount);
+        advanceEnemies(world, 1);
+        advanceStatusEffects(world, 1);
+    }
+
+    if (playerMeetsEnemy(world)) {
+        PROFILE_SCOPE(PHASE_COMBAT);
+        suspendRealTime();
+        resolveEncounters(world, promptBattleAction, NULL);
+        if (world->status != GAME_RUNNING) {
+            return;
+        }
+        resumeRealTime(world, rt);
+    }
+
+    reloadMap(world);
+}
+
+static int lerpCell(int from, int to, double alpha, int scale) {
+    return (int)floor((from + (to - from) * alpha) * scale + 0.5);
+}
+
+static void renderFrame(GameWorld* world, const RealTimeState* rt, double alpha) {
+    PROFILE_SCOPE(PHASE_RENDER);
+    PROFILE_COUNT(COUNTER_TILES, MAP_HEIGHT * MAP_WIDTH);
+    const RealTimeStats* stats = &rt->stats;
+    const int rowWidth = MAP_WIDTH * CELL_WIDTH;
+    char grid[MAP_HEIGHT][MAP_WIDTH * CELL_WIDTH + 1];
+
+    // Warstwa statyczna - wszystko poza przeciwnikami i graczem
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        for (int x = 0; x < MAP_WIDTH; x++) {
+            char c = world->map[y][x];
+            if (c == 'E' || c == 'P') c = '.';
+            grid[y][x * CELL_WIDTH] = ' ';
+            grid[y][x * CELL_WIDTH + 1] = c;
+            grid[y][x * CELL_WIDTH + 2] = ' ';
+        }
+        grid[y][rowWidth] = '\0';
+    }
+    for (int i = 0; i < world->groundItemCount; i++) {
+        grid[world->groundItems[i]->posY][world->groundItems[i]->posX * CELL_WIDTH + 1] = 'I';
+    }
+    if (world->portalActive) {
+        grid[world->portalY][world->portalX * CELL_WIDTH + 1] = 'O';
+    }
+
+    // Przeciwnicy i gracz w pozycjach interpolowanych miedzy poprzednim a biezacym tickiem
+    for (int i = 0; i < world->enemyCount; i++) {
+        Enemy* enemy = world->enemies[i];
+        int col = lerpCell(enemy->prevX, enemy->EposX, alpha, CELL_WIDTH) + 1;
+        int row = lerpCell(enemy->prevY, enemy->EposY, alpha, 1);
+        grid[row][col] = 'E';
+    }
+    int playerCol = lerpCell(rt->prevPlayerX, world->player->posX, alpha, CELL_WIDTH) + 1;
+    int playerRow = lerpCell(rt->prevPlayerY, world->player->posY, alpha, 1);
+    grid[playerRow][playerCol] = 'P';
+
+    // Statystyki czasu klatki: srednia, jitter (odchylenie standardowe), maksimum
+    double mean = 0.0, maxFrame = 0.0, variance = 0.0;
+    for (int i = 0; i < stats->frameCount; i++) {
+        mean += stats->frameTimes[i];
+        if (stats->frameTimes[i] > maxFrame) maxFrame = stats->frameTimes[i];
+    }
+    if (stats->frameCount > 0) mean /= stats->frameCount;
+    for (int i = 0; i < stats->frameCount; i++) {
+        double d = stats->frameTimes[i] - mean;
+        variance += d * d;
+    }
+    if (stats->frameCount > 0) variance /= stats->frameCount;
+
+    printf("\x1b[H");
+    printf("Gracz: %s | Poziom: %d | HP: %d/%d | Atak: %d | Obrona: %d | Zloto: %d\x1b[K\n",
+        world->player->name, world->level, world->player->health, world->player->max_health,
+        world->player->attack + world->player->effect_attack, world->player->defense, world->player->gold);
+    char effects[128];
+    formatStatusEffects(world, world->player, effects, sizeof(effects));
+    printf("Pokonani wrogowie: %d/5 (lvl) | %d (total)%s%s\x1b[K\n",
+        world->enemiesDefeated, world->totalEnemiesDefeated, effects[0] ? " | Efekty: " : "", effects);
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        printf("%s\x1b[K\n", grid[y]);
+    }
+    printf("Ruch (WASD), I - ekwipunek, Z - zapisz gre, P - podnies przedmiot, Q - wyjscie\x1b[K\n");
+    printf("[tick %.1f/s (cel %d) | klatka %.2f ms, jitter %.2f ms, max %.2f ms | symulacja %.3f ms]\x1b[K\n",
+        stats->measuredTickRate, REALTIME_TICK_RATE, mean * 1000.0, sqrt(variance) * 1000.0,
+        maxFrame * 1000.0, stats->tickCost * 1000.0);
+    int first = rt->messageCount > MESSAGE_LINES ? rt->messageCount - MESSAGE_LINES : 0;
+    for (int i = first; i < rt->messageCount; i++) {
+        printf("%s\x1b[K\n", rt->messages[i % MESSAGE_LINES]);
+    }
+    printf("\x1b[J");
+    fflush(stdout);
+}
+
+void runRealTimeGame(GameWorld* world) {
+    const double tickDt = 1.0 / REALTIME_TICK_RATE;
+    const double frameDt = 1.0 / REALTIME_FRAME_RATE;
+
+    RealTimeState rt;
+    memset(&rt, 0, sizeof(RealTimeState));
+    rt.prevPlayerX = world->player->posX;
+    rt.prevPlayerY = world->player->posY;
+
+    unsubscribeEvents(renderEventToConsole);
+    subscribeEvents(logEventToFrame, &rt);
+    enableRawInput();
+    clearScreen();
+
+    double previous = nowSeconds();
+    double accumulator = 0.0;
+    double nextFrame = previous + frameDt;
+    rt.stats.tickWindowStart = previous;
+    char pending = 0;
+
+    while (1) {
+        double now = nowSeconds();
+        double frameTime = now - previous;
+        previous = now;
+
+        {
+            PROFILE_SCOPE(PHASE_INPUT);
+            int key;
+            while ((key = pollKey()) != -1) {
+                pending = (char)key;
+            }
+        }
+
+        if (frameTime > REALTIME_MAX_FRAME) {
+            frameTime = REALTIME_MAX_FRAME;
+        }
+        accumulator += frameTime;
+
+        int blocked = 0;
+        while (accumulator >= tickDt) {
+            double tickStart = nowSeconds();
+            {
+                PROFILE_SCOPE(PHASE_TURN);
+                simulateTick(world, &rt, pending);
+                journalTurn(world->journal, world);
+            }
+            PROFILE_END_TURN();
+            pending = 0;
+            accumulator -= tickDt;
+
+            if (world->status != GAME_RUNNING) {
+                // Koniec gry - podsumowanie wypisuje juz zwykly terminal
+                if (isRawInputEnabled()) {
+                    suspendRealTime();
+                }
+                finishGameIfOver(world);
+            }
+            presentEvents(world);
+
+            double tickEnd = nowSeconds();
+            if (tickEnd - tickStart > tickDt) {
+                // Tick czekal na gracza (walka, menu) - nie nadrabiamy straconego czasu
+                blocked = 1;
+                accumulator = 0.0;
+                break;
+            }
+            recordTick(&rt.stats, tickEnd, tickEnd - tickStart);
+        }
+
+        if (blocked) {
+            previous = nowSeconds();
+            nextFrame = previous + frameDt;
+            rt.stats.tickWindowStart = previous;
+            rt.stats.ticksInWindow = 0;
+            rt.stats.tickCostTotal = 0.0;
+            continue;
+        }
+
+        recordFrame(&rt.stats, frameTime);
+        renderFrame(world, &rt, accumulator / tickDt);
+
+        // Stale tempo klatek liczone od bezwzglednego terminu, bez dryfu
+        double sleepTime = nextFrame - nowSeconds();
+        if (sleepTime > 0.0) {
+            sleepSeconds(sleepTime);
+            nextFrame += frameDt;
+        }
+        else {
+            nextFrame = nowSeconds() + frameDt;
+        }
+    }
+}
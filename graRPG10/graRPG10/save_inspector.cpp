@@ -0,0 +1,501 @@
+﻿#include <atomic>
+#include <thread>
+#include "savefile.h"
+
+// Analiza wielu plikow zapisu naraz (np. z testow gry). Zapisy sa czytane
+// strumieniowo sekcja po sekcji, bez budowania GameWorld - z przeciwnikow
+// i przedmiotow zostaja tylko liczniki i statystyki. Katalog jest przegladany
+// rekurencyjnie, pliki dzielone miedzy watki, a kazdy watek zbiera wlasne
+// statystyki, laczone na koncu. Wynik to CSV: statystyka,klucz,proby,min,max,srednia,odchylenie.
+//
+// Uzycie: graRPG10_inspect <katalog> [--threads N] [--out wynik.csv] [--per-file pliki.csv]
+
+#define INSPECT_MAX_LEVEL 32                      // Wyzsze poziomy trafiaja do ostatniego kubelka
+#define INSPECT_NAME_SLOTS (STR_BUILTIN_COUNT + 1)  // Napisy wbudowane i "inne"
+#define INSPECT_CATEGORY_COUNT 3
+#define INSPECT_MAX_PLAYER_NAME 50
+
+typedef struct {
+    long long samples;
+    double sum;
+    double sumSquares;
+    int min;
+    int max;
+} Accumulator;
+
+// Dane jednego zapisu - wiersz w --per-file
+typedef struct {
+    int ok;
+    int level;
+    int turn;
+    int gold;
+    int health;
+    int maxHealth;
+    int attack;
+    int defense;
+    int totalDefeated;
+    int items;
+    int itemsByCategory[INSPECT_CATEGORY_COUNT];
+    int enemies;
+    int traps;
+    int groundItems;
+} SaveSummary;
+
+typedef struct {
+    long long files;
+    long long failed;
+    long long bytes;
+    Accumulator level;
+    Accumulator turn;
+    Accumulator gold;
+    Accumulator goldByLevel[INSPECT_MAX_LEVEL + 1];
+    Accumulator health;
+    Accumulator maxHealth;
+    Accumulator attack;
+    Accumulator defense;
+    Accumulator totalDefeated;
+    Accumulator items;
+    Accumulator itemsByCategory[INSPECT_CATEGORY_COUNT];
+    Accumulator enemies;
+    Accumulator traps;
+    Accumulator groundItems;
+    long long itemNames[INSPECT_NAME_SLOTS];      // Liczba przedmiotow w ekwipunkach wedlug nazwy
+    Accumulator enemyHealth[INSPECT_NAME_SLOTS];  // Przeciwnicy wedlug nazwy
+    Accumulator enemyAttack[INSPECT_NAME_SLOTS];
+    Accumulator enemyDefense[INSPECT_NAME_SLOTS];
+} InspectStats;
+
+typedef struct {
+    char* pool;        // Sciezki jedna za druga, zakonczone '\0'
+    size_t poolUsed;
+    size_t poolCapacity;
+    size_t* offsets;
+    int count;
+    int capacity;
+} PathList;
+
+typedef struct {
+    const PathList* paths;
+    std::atomic<int> next;   // Indeks nastepnego pliku do wziecia
+    SaveSummary* summaries;  // NULL - bez wynikow dla pojedynczych plikow
+} InspectJob;
+
+static const char* categoryNames[INSPECT_CATEGORY_COUNT] = { "potion", "sword", "armor" };
+
+static void addSample(Accumulator* acc, int value) {
+    if (acc->samples == 0 || value < acc->min) acc->min = value;
+    if (acc->samples == 0 || value > acc->max) acc->max = value;
+    acc->samples++;
+    acc->sum += value;
+    acc->sumSquares += (double)value * value;
+}
+
+static void mergeAccumulator(Accumulator* into, const Accumulator* from) {
+    if (from->samples == 0) return;
+    if (into->samples == 0 || from->min < into->min) into->min = from->min;
+    if (into->samples == 0 || from->max > into->max) into->max = from->max;
+    into->samples += from->samples;
+    into->sum += from->sum;
+    into->sumSquares += from->sumSquares;
+}
+
+static int nameSlot(StringId name) {
+    return name < (StringId)STR_BUILTIN_COUNT ? (int)name : STR_BUILTIN_COUNT;
+}
+
+static const char* slotName(int slot) {
+    return slot < STR_BUILTIN_COUNT ? getString((StringId)slot) : "inne";
+}
+
+// ---- Lista plikow ----
+
+static void addPath(const char* path, void* context) {
+    PathList* list = (PathList*)context;
+    size_t length = strlen(path) + 1;
+
+    if (list->poolUsed + length > list->poolCapacity) {
+        size_t capacity = list->poolCapacity ? list->poolCapacity * 2 : 64 * 1024;
+        while (capacity < list->poolUsed + length) capacity *= 2;
+        char* grown = (char*)realloc(list->pool, capacity);
+        if (!grown) return;
+        list->pool = grown;
+        list->poolCapacity = capacity;
+    }
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 1024;
+        size_t* grown = (size_t*)realloc(list->offsets, capacity * sizeof(size_t));
+        if (!grown) return;
+        list->offsets = grown;
+        list->capacity = capacity;
+    }
+
+    memcpy(list->pool + list->poolUsed, path, length);
+    list->offsets[list->count++] = list->poolUsed;
+    list->poolUsed += length;
+}
+
+static const char* pathAt(const PathList* list, int index) {
+    return list->pool + list->offsets[index];
+}
+
+// ---- Odczyt jednego zapisu ----
+
+// Caly plik trafia do bufora watku - jeden odczyt zamiast wielu malych
+static int loadFile(const char* path, unsigned char** buffer, size_t* capacity, size_t* size) {
+    FILE* file;
+    if (fopen_s(&file, path, "rb") != 0) return 0;
+
+    *size = 0;
+    for (;;) {
+        if (*size == *capacity) {
+            size_t grown = *capacity ? *capacity * 2 : 64 * 1024;
+            unsigned char* data = (unsigned char*)realloc(*buffer, grown);
+            if (!data) {
+                fclose(file);
+                return 0;
+            }
+            *buffer = data;
+            *capacity = grown;
+        }
+        size_t read = fread(*buffer + *size, 1, *capacity - *size, file);
+        *size += read;
+        if (read == 0) break;
+    }
+    int ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+// Statystyki przeciwnikow i nazwy przedmiotow jednego pliku - dolaczane do
+// statystyk watku dopiero, gdy caly plik okaze sie poprawny
+typedef struct {
+    long long itemNames[INSPECT_NAME_SLOTS];
+    Accumulator enemyHealth[INSPECT_NAME_SLOTS];
+    Accumulator enemyAttack[INSPECT_NAME_SLOTS];
+    Accumulator enemyDefense[INSPECT_NAME_SLOTS];
+} SaveTally;
+
+static int inspectSave(SaveReader* reader, SaveSummary* summary, SaveTally* tally) {
+    memset(summary, 0, sizeof(SaveSummary));
+    memset(tally, 0, sizeof(SaveTally));
+    summary->turn = reader->header.turn;
+
+    int seenPlayer = 0;
+    int id;
+    while ((id = nextSaveSection(reader)) > SECTION_END) {
+        switch (id) {
+        case SECTION_WORLD:
+            summary->level = readSaveInt(reader);
+            readSaveInt(reader);  // Przeciwnicy pokonani na biezacym poziomie
+            summary->totalDefeated = readSaveInt(reader);
+            break;
+        case SECTION_PLAYER: {
+            char name[INSPECT_MAX_PLAYER_NAME];
+            int nameLength = readSaveInt(reader);
+            if (nameLength < 0 || nameLength >= INSPECT_MAX_PLAYER_NAME) return 0;
+            readSaveBytes(reader, name, nameLength);
+            summary->health = readSaveInt(reader);
+            summary->maxHealth = readSaveInt(reader);
+            summary->attack = readSaveInt(reader);
+            summary->defense = readSaveInt(reader);
+            readSaveInt(reader);  // Pozycja
+            readSaveInt(reader);
+            summary->gold = readSaveInt(reader);
+            seenPlayer = 1;
+            break;
+        }
+        case SECTION_INVENTORY: {
+            int count = readSaveInt(reader);
+            if (count < 0 || count > reader->section.rawSize) return 0;
+            Item item;
+            Item previous;
+            memset(&previous, 0, sizeof(Item));
+            for (int i = 0; i < count && !reader->error; i++) {
+                readSaveItem(reader, &item, &previous);
+                previous = item;
+                if ((unsigned)item.category < INSPECT_CATEGORY_COUNT) {
+                    summary->itemsByCategory[item.category]++;
+                }
+                tally->itemNames[nameSlot(item.name)]++;
+            }
+            summary->items = count;
+            break;
+        }
+        case SECTION_ENEMIES: {
+            int count = readSaveInt(reader);
+            if (count < 0 || count > reader->section.rawSize) return 0;
+            Enemy enemy;
+            Enemy previous;
+            memset(&previous, 0, sizeof(Enemy));
+            for (int i = 0; i < count && !reader->error; i++) {
+                readSaveEnemy(reader, &enemy, &previous);
+                previous = enemy;
+                int slot = nameSlot(enemy.name);
+                addSample(&tally->enemyHealth[slot], enemy.health);
+                addSample(&tally->enemyAttack[slot], enemy.attack);
+                addSample(&tally->enemyDefense[slot], enemy.defense);
+            }
+            summary->enemies = count;
+            break;
+        }
+        // Z pulapek i przedmiotow na ziemi wystarczy liczba - reszta sekcji jest pomijana
+        case SECTION_TRAPS:
+            summary->traps = readSaveInt(reader);
+            break;
+        case SECTION_GROUND:
+            summary->groundItems = readSaveInt(reader);
+            break;
+        default:
+            break;
+        }
+        if (reader->error) return 0;
+    }
+    return id == SECTION_END && seenPlayer;
+}
+
+static void addSummary(InspectStats* stats, const SaveSummary* summary, const SaveTally* tally) {
+    int level = summary->level < 0 ? 0 : summary->level > INSPECT_MAX_LEVEL ? INSPECT_MAX_LEVEL : summary->level;
+    addSample(&stats->level, summary->level);
+    addSample(&stats->turn, summary->turn);
+    addSample(&stats->gold, summary->gold);
+    addSample(&stats->goldByLevel[level], summary->gold);
+    addSample(&stats->health, summary->health);
+    addSample(&stats->maxHealth, summary->maxHealth);
+    addSample(&stats->attack, summary->attack);
+    addSample(&stats->defense, summary->defense);
+    addSample(&stats->totalDefeated, summary->totalDefeated);
+    addSample(&stats->items, summary->items);
+    for (int i = 0; i < INSPECT_CATEGORY_COUNT; i++) {
+        addSample(&stats->itemsByCategory[i], summary->itemsByCategory[i]);
+    }
+    addSample(&stats->enemies, summary->enemies);
+    addSample(&stats->traps, summary->traps);
+    addSample(&stats->groundItems, summary->groundItems);
+    for (int i = 0; i < INSPECT_NAME_SLOTS; i++) {
+        stats->itemNames[i] += tally->itemNames[i];
+        mergeAccumulator(&stats->enemyHealth[i], &tally->enemyHealth[i]);
+        mergeAccumulator(&stats->enemyAttack[i], &tally->enemyAttack[i]);
+        mergeAccumulator(&stats->enemyDefense[i], &tally->enemyDefense[i]);
+    }
+}
+
+static void mergeStats(InspectStats* into, const InspectStats* from) {
+    into->files += from->files;
+    into->failed += from->failed;
+    into->bytes += from->bytes;
+    mergeAccumulator(&into->level, &from->level);
+    mergeAccumulator(&into->turn, &from->turn);
+    mergeAccumulator(&into->gold, &from->gold);
+    for (int i = 0; i <= INSPECT_MAX_LEVEL; i++) {
+        mergeAccumulator(&into->goldByLevel[i], &from->goldByLevel[i]);
+    }
+    mergeAccumulator(&into->health, &from->health);
+    mergeAccumulator(&into->maxHealth, &from->maxHealth);
+    mergeAccumulator(&into->attack, &from->attack);
+    mergeAccumulator(&into->defense, &from->defense);
+    mergeAccumulator(&into->totalDefeated, &from->totalDefeated);
+    mergeAccumulator(&into->items, &from->items);
+    for (int i = 0; i < INSPECT_CATEGORY_COUNT; i++) {
+        mergeAccumulator(&into->itemsByCategory[i], &from->itemsByCategory[i]);
+    }
+    mergeAccumulator(&into->enemies, &from->enemies);
+    mergeAccumulator(&into->traps, &from->traps);
+    mergeAccumulator(&into->groundItems, &from->groundItems);
+    for (int i = 0; i < INSPECT_NAME_SLOTS; i++) {
+        into->itemNames[i] += from->itemNames[i];
+        mergeAccumulator(&into->enemyHealth[i], &from->enemyHealth[i]);
+        mergeAccumulator(&into->enemyAttack[i], &from->enemyAttack[i]);
+        mergeAccumulator(&into->enemyDefense[i], &from->enemyDefense[i]);
+    }
+}
+
+static void runInspectWorker(InspectJob* job, InspectStats* stats) {
+    SaveReader reader;
+    initSaveReader(&reader);
+    unsigned char* buffer = NULL;
+    size_t capacity = 0;
+    SaveSummary summary;
+    SaveTally tally;
+
+    int index;
+    while ((index = job->next.fetch_add(1)) < job->paths->count) {
+        memset(&summary, 0, sizeof(SaveSummary));
+        size_t size;
+        int ok = loadFile(pathAt(job->paths, index), &buffer, &capacity, &size) &&
+            beginSaveMemory(&reader, buffer, size) && inspectSave(&reader, &summary, &tally);
+
+        stats->files++;
+        if (ok) {
+            stats->bytes += size;
+            addSummary(stats, &summary, &tally);
+        }
+        else {
+            stats->failed++;
+        }
+        if (job->summaries) {
+            summary.ok = ok;
+            job->summaries[index] = summary;
+        }
+    }
+
+    free(buffer);
+    freeSaveReader(&reader);
+}
+
+// ---- Wyniki ----
+
+static void writeAccumulator(FILE* file, const char* stat, const char* key, const Accumulator* acc) {
+    if (acc->samples == 0) return;
+    double mean = acc->sum / acc->samples;
+    double variance = acc->sumSquares / acc->samples - mean * mean;
+    fprintf(file, "%s,%s,%lld,%d,%d,%.3f,%.3f\n", stat, key, acc->samples, acc->min, acc->max,
+        mean, variance > 0.0 ? sqrt(variance) : 0.0);
+}
+
+static void writeStatsCsv(FILE* file, const InspectStats* stats) {
+    char key[32];
+    fprintf(file, "stat,key,samples,min,max,mean,stddev\n");
+    fprintf(file, "files,all,%lld,,,,\n", stats->files);
+    fprintf(file, "failed,all,%lld,,,,\n", stats->failed);
+
+    writeAccumulator(file, "level", "all", &stats->level);
+    writeAccumulator(file, "turn", "all", &stats->turn);
+    writeAccumulator(file, "gold", "all", &stats->gold);
+    for (int i = 0; i <= INSPECT_MAX_LEVEL; i++) {
+        snprintf(key, sizeof(key), i == INSPECT_MAX_LEVEL ? "level_%d+" : "level_%d", i);
+        writeAccumulator(file, "gold", key, &stats->goldByLevel[i]);
+    }
+    writeAccumulator(file, "player_health", "all", &stats->health);
+    writeAccumulator(file, "player_max_health", "base", &stats->maxHealth);
+    writeAccumulator(file, "player_attack", "base", &stats->attack);
+    writeAccumulator(file, "player_defense", "base", &stats->defense);
+    writeAccumulator(file, "enemies_defeated", "all", &stats->totalDefeated);
+
+    writeAccumulator(file, "inventory_items", "all", &stats->items);
+    for (int i = 0; i < INSPECT_CATEGORY_COUNT; i++) {
+        writeAccumulator(file, "inventory_items", categoryNames[i], &stats->itemsByCategory[i]);
+    }
+    for (int i = 0; i < INSPECT_NAME_SLOTS; i++) {
+        if (stats->itemNames[i] > 0) {
+            fprintf(file, "inventory_item_total,%s,%lld,,,,\n", slotName(i), stats->itemNames[i]);
+        }
+    }
+
+    writeAccumulator(file, "enemies", "all", &stats->enemies);
+    for (int i = 0; i < INSPECT_NAME_SLOTS; i++) {
+        writeAccumulator(file, "enemy_health", slotName(i), &stats->enemyHealth[i]);
+        writeAccumulator(file, "enemy_attack", slotName(i), &stats->enemyAttack[i]);
+        writeAccumulator(file, "enemy_defense", slotName(i), &stats->enemyDefense[i]);
+    }
+    writeAccumulator(file, "traps", "all", &stats->traps);
+    writeAccumulator(file, "ground_items", "all", &stats->groundItems);
+}
+
+static void writePerFileCsv(FILE* file, const PathList* paths, const SaveSummary* summaries) {
+    fprintf(file, "path,ok,level,turn,gold,health,max_health,attack,defense,enemies_defeated,"
+        "items,potions,swords,armor,enemies,traps,ground_items\n");
+    for (int i = 0; i < paths->count; i++) {
+        const SaveSummary* s = &summaries[i];
+        fprintf(file, "%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", pathAt(paths, i), s->ok,
+            s->level, s->turn, s->gold, s->health, s->maxHealth, s->attack, s->defense, s->totalDefeated,
+            s->items, s->itemsByCategory[ITEM_POTION], s->itemsByCategory[ITEM_SWORD],
+            s->itemsByCategory[ITEM_ARMOR], s->enemies, s->traps, s->groundItems);
+    }
+}
+
+static FILE* openOutput(const char* path) {
+    if (!path) return stdout;
+    FILE* file;
+    if (fopen_s(&file, path, "w") != 0) {
+        fprintf(stderr, "Nie mozna otworzyc pliku %s!\n", path);
+        return NULL;
+    }
+    return file;
+}
+
+int main(int argc, char* argv[]) {
+    const char* directory = NULL;
+    const char* outPath = NULL;
+    const char* perFilePath = NULL;
+    int threadCount = (int)std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--per-file") == 0 && i + 1 < argc) {
+            perFilePath = argv[++i];
+        }
+        else if (!directory) {
+            directory = argv[i];
+        }
+    }
+    if (!directory) {
+        fprintf(stderr, "Uzycie: %s <katalog> [--threads N] [--out wynik.csv] [--per-file pliki.csv]\n", argv[0]);
+        return 2;
+    }
+    if (threadCount < 1) threadCount = 1;
+
+    initStringTable();
+
+    double start = nowSeconds();
+    PathList paths;
+    memset(&paths, 0, sizeof(PathList));
+    if (!listFiles(directory, addPath, &paths)) {
+        fprintf(stderr, "Nie mozna otworzyc katalogu %s!\n", directory);
+        return 1;
+    }
+    if (threadCount > paths.count) threadCount = paths.count > 0 ? paths.count : 1;
+
+    InspectJob job;
+    job.paths = &paths;
+    job.next = 0;
+    job.summaries = perFilePath ? (SaveSummary*)calloc(paths.count > 0 ? paths.count : 1, sizeof(SaveSummary)) : NULL;
+
+    InspectStats* threadStats = (InspectStats*)calloc(threadCount, sizeof(InspectStats));
+    std::thread* threads = new std::thread[threadCount];
+    for (int i = 0; i < threadCount; i++) {
+        threads[i] = std::thread(runInspectWorker, &job, &threadStats[i]);
+    }
+    InspectStats total;
+    memset(&total, 0, sizeof(InspectStats));
+    for (int i = 0; i < threadCount; i++) {
+        threads[i].join();
+        mergeStats(&total, &threadStats[i]);
+    }
+    delete[] threads;
+    double elapsed = nowSeconds() - start;
+
+    int status = 0;
+    FILE* out = openOutput(outPath);
+    if (out) {
+        writeStatsCsv(out, &total);
+        if (out != stdout) fclose(out);
+    }
+    else {
+        status = 1;
+    }
+    if (job.summaries) {
+        FILE* perFile = openOutput(perFilePath);
+        if (perFile) {
+            writePerFileCsv(perFile, &paths, job.summaries);
+            fclose(perFile);
+        }
+        else {
+            status = 1;
+        }
+    }
+
+    fprintf(stderr, "Przeanalizowano %lld plikow (%lld blednych, %.1f MB) w %.2f s na %d watkach - %.0f plikow/min\n",
+        total.files, total.failed, total.bytes / (1024.0 * 1024.0), elapsed, threadCount,
+        elapsed > 0.0 ? total.files * 60.0 / elapsed : 0.0);
+
+    free(job.summaries);
+    free(threadStats);
+    free(paths.pool);
+    free(paths.offsets);
+    return status;
+}
@@ -0,0 +1,610 @@
+﻿#include "savefile.h"
+#include "lz.h"
+
+#define SAVE_MIN_COMPRESSED_SECTION 64  // Krotszych sekcji nie oplaca sie pakowac
+#define SAVE_MAX_SECTION (64 * 1024 * 1024)  // Wieksza sekcja oznacza uszkodzony plik
+
+int saveCompression = 1;
+
+// ---- Zapis ----
+
+static int reserveSave(SaveBuffer* buffer, size_t size) {
+    if (buffer->size + size <= buffer->capacity) return 1;
+
+    size_t capacity = buffer->capacity ? buffer->capacity * 2 : 1024;
+    while (capacity < buffer->size + size) capacity *= 2;
+    unsigned char* grown = (unsigned char*)trackedMalloc(capacity, ALLOC_SAVE);
+    if (!grown) return 0;
+    if (buffer->data) memcpy(grown, buffer->data, buffer->size);
+    trackedFree(buffer->data);
+    buffer->data = grown;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+static void saveAppend(SaveBuffer* buffer, const void* data, size_t size) {
+    if (!reserveSave(buffer, size)) return;
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+// Zigzag + 7 bitow na bajt: male liczby (takze ujemne) zajmuja 1 bajt
+static void saveInt(SaveBuffer* buffer, int value) {
+    unsigned int zigzag = ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+    unsigned char bytes[5];
+    int count = 0;
+    do {
+        unsigned char byte = zigzag & 0x7F;
+        zigzag >>= 7;
+        bytes[count++] = zigzag ? (byte | 0x80) : byte;
+    } while (zigzag);
+    saveAppend(buffer, bytes, count);
+}
+
+static void saveItem(SaveBuffer* buffer, const Item* item, const Item* previous) {
+    saveInt(buffer, (int)item->name);
+    saveInt(buffer, item->category);
+    saveInt(buffer, item->posX - previous->posX);
+    saveInt(buffer, item->posY - previous->posY);
+    saveInt(buffer, item->attackBonus);
+    saveInt(buffer, item->defenseBonus);
+    saveInt(buffer, item->healthBonus);
+    saveInt(buffer, item->width);
+    saveInt(buffer, item->height);
+    saveInt(buffer, item->symbol);
+    saveInt(buffer, item->inInventory);
+}
+
+static void saveEnemy(SaveBuffer* buffer, const Enemy* enemy, const Enemy* previous) {
+    saveInt(buffer, (int)enemy->name);
+    saveInt(buffer, enemy->health);
+    saveInt(buffer, enemy->attack);
+    saveInt(buffer, enemy->defense);
+    saveInt(buffer, enemy->EposX - previous->EposX);
+    saveInt(buffer, enemy->EposY - previous->EposY);
+    saveInt(buffer, enemy->prevX - enemy->EposX);
+    saveInt(buffer, enemy->prevY - enemy->EposY);
+    saveInt(buffer, enemy->moveDelay);
+    saveInt(buffer, enemy->moveTimer);
+}
+
+static void saveTrap(SaveBuffer* buffer, const Trap* trap, const Trap* previous) {
+    saveInt(buffer, trap->posX - previous->posX);
+    saveInt(buffer, trap->posY - previous->posY);
+    saveInt(buffer, trap->damage);
+    saveInt(buffer, trap->discovered);
+    saveInt(buffer, (int)trap->description);
+}
+
+// Dopisuje sekcje do pliku i czysci bufor sekcji do ponownego uzycia
+static void endSection(SaveBuffer* out, SaveBuffer* section, SaveSectionId id, SaveBuffer* scratch) {
+    SaveSectionHeader header = { id, SAVE_CODEC_NONE, (int)section->size, (int)section->size };
+    const unsigned char* stored = section->data;
+
+    if (saveCompression && section->size >= SAVE_MIN_COMPRESSED_SECTION) {
+        int bound = lzCompressBound((int)section->size);
+        scratch->size = 0;
+        if (reserveSave(scratch, bound)) {
+            int packed = lzCompress(section->data, (int)section->size, scratch->data, bound);
+            if (packed > 0 && packed < (int)section->size) {
+                header.codec = SAVE_CODEC_LZ;
+                header.storedSize = packed;
+                stored = scratch->data;
+            }
+        }
+    }
+
+    saveAppend(out, &header, sizeof(header));
+    if (header.storedSize > 0) saveAppend(out, stored, header.storedSize);
+    section->size = 0;
+}
+
+// Zapis ma jednego gracza - efekty innych graczy swiata zostaja poza nim
+static int isSavedEffect(const GameWorld* world, const StatusEffect* effect) {
+    if (!effect->active) return 0;
+    if (effect->onEnemy) return 1;
+    return effect->target < world->playerCount && world->players[effect->target] == world->player;
+}
+
+// Niezmienna kopia stanu gry w formacie pliku zapisu. Bufor pochodzi z
+// trackedMalloc(ALLOC_SAVE) i przechodzi na wlasnosc wywolujacego.
+void* serializeSave(GameWorld* world, size_t* outSize) {
+    SaveBuffer out = { NULL, 0, 0 };
+    SaveBuffer section = { NULL, 0, 0 };
+    SaveBuffer scratch = { NULL, 0, 0 };
+
+    SaveFileHeader header = { SAVE_MAGIC, SAVE_VERSION, world->saveGeneration, world->turn };
+    saveAppend(&out, &header, sizeof(header));
+
+    saveInt(&section, world->level);
+    saveInt(&section, world->enemiesDefeated);
+    saveInt(&section, world->totalEnemiesDefeated);
+    saveInt(&section, world->portalActive);
+    saveInt(&section, world->portalX);
+    saveInt(&section, world->portalY);
+    endSection(&out, &section, SECTION_WORLD, &scratch);
+
+    // Tylko statystyki bazowe - pochodne sa odtwarzane z wyposazenia przy wczytaniu
+    Player* player = world->player;
+    int nameLength = (int)strnlen(player->name, sizeof(player->name) - 1);
+    saveInt(&section, nameLength);
+    saveAppend(&section, player->name, nameLength);
+    saveInt(&section, player->health);
+    saveInt(&section, player->base_max_health);
+    saveInt(&section, player->base_attack);
+    saveInt(&section, player->base_defense);
+    saveInt(&section, player->posX);
+    saveInt(&section, player->posY);
+    saveInt(&section, player->gold);
+    saveInt(&section, player->inventory->width);
+    saveInt(&section, player->inventory->height);
+    // Wyposazenie jako pozycje przedmiotow w ekwipunku (-1 - pusty slot)
+    for (int i = 0; i < EQUIP_SLOT_COUNT; i++) {
+        Item* item = player->equipment[i];
+        saveInt(&section, item ? item->posX : -1);
+        saveInt(&section, item ? item->posY : -1);
+    }
+    endSection(&out, &section, SECTION_PLAYER, &scratch);
+
+    // Przedmioty w ekwipunku (lewy gorny rog przedmiotu)
+    Inventory* inv = player->inventory;
+    int itemCount = 0;
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            if (inv->items[y][x] != NULL && inv->items[y][x]->posX == x && inv->items[y][x]->posY == y) {
+                itemCount++;
+            }
+        }
+    }
+    saveInt(&section, itemCount);
+    Item previousItem;
+    memset(&previousItem, 0, sizeof(Item));
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            Item* item = inv->items[y][x];
+            if (item != NULL && item->posX == x && item->posY == y) {
+                saveItem(&section, item, &previousItem);
+                previousItem = *item;
+            }
+        }
+    }
+    endSection(&out, &section, SECTION_INVENTORY, &scratch);
+
+    saveInt(&section, world->enemyCount);
+    Enemy previousEnemy;
+    memset(&previousEnemy, 0, sizeof(Enemy));
+    for (int i = 0; i < world->enemyCount; i++) {
+        saveEnemy(&section, world->enemies[i], &previousEnemy);
+        previousEnemy = *world->enemies[i];
+    }
+    endSection(&out, &section, SECTION_ENEMIES, &scratch);
+
+    saveInt(&section, world->trapCount);
+    Trap previousTrap;
+    memset(&previousTrap, 0, sizeof(Trap));
+    for (int i = 0; i < world->trapCount; i++) {
+        saveTrap(&section, world->traps[i], &previousTrap);
+        previousTrap = *world->traps[i];
+    }
+    endSection(&out, &section, SECTION_TRAPS, &scratch);
+
+    saveInt(&section, world->groundItemCount);
+    memset(&previousItem, 0, sizeof(Item));
+    for (int i = 0; i < world->groundItemCount; i++) {
+        saveItem(&section, world->groundItems[i], &previousItem);
+        previousItem = *world->groundItems[i];
+    }
+    endSection(&out, &section, SECTION_GROUND, &scratch);
+
+    // Efekty zapisanego gracza (jako gracz 0) i przeciwnikow; termin wzgledem zegara kola
+    const StatusEffects* effects = &world->effects;
+    int effectCount = 0;
+    for (int i = 0; i < effects->capacity; i++) {
+        effectCount += isSavedEffect(world, &effects->pool[i]);
+    }
+    saveInt(&section, effectCount);
+    for (int i = 0; i < effects->capacity; i++) {
+        const StatusEffect* effect = &effects->pool[i];
+        if (!isSavedEffect(world, effect)) continue;
+        saveInt(&section, effect->type);
+        saveInt(&section, effect->onEnemy);
+        saveInt(&section, effect->onEnemy ? effect->target : 0);
+        saveInt(&section, effect->magnitude);
+        saveInt(&section, effect->period);
+        saveInt(&section, effect->remaining);
+        saveInt(&section, (int)(effect->due - effects->clock));
+    }
+    endSection(&out, &section, SECTION_EFFECTS, &scratch);
+
+    // Zapis bez tej sekcji wczytuje sie z zegarem 0 - jak przed kolejka ruchow
+    saveInt(&section, (int)world->schedule.clock);
+    endSection(&out, &section, SECTION_SCHEDULE, &scratch);
+
+    endSection(&out, &section, SECTION_END, &scratch);
+
+    trackedFree(section.data);
+    trackedFree(scratch.data);
+    *outSize = out.size;
+    return out.data;
+}
+
+// Zapis stanu gry do pliku bez komunikatow. Zwraca 0, gdy zapis sie nie udal.
+// Plik jest podmieniany atomowo - przerwany zapis nie psuje poprzedniego.
+int writeSaveFile(GameWorld* world, const char* path) {
+    size_t size;
+    void* data = serializeSave(world, &size);
+    if (!data) {
+        return 0;
+    }
+    int ok = writeFileAtomic(path, data, size);
+    trackedFree(data);
+    return ok;
+}
+
+// ---- Odczyt ----
+
+void initSaveReader(SaveReader* reader) {
+    memset(reader, 0, sizeof(SaveReader));
+}
+
+void freeSaveReader(SaveReader* reader) {
+    trackedFree(reader->data);
+    trackedFree(reader->stored);
+    initSaveReader(reader);
+}
+
+static int readSource(SaveReader* reader, void* out, size_t size) {
+    if (reader->file) {
+        return fread(out, 1, size, reader->file) == size;
+    }
+    if (reader->memorySize - reader->memoryPos < size) return 0;
+    memcpy(out, reader->memory + reader->memoryPos, size);
+    reader->memoryPos += size;
+    return 1;
+}
+
+static int growReaderBuffer(unsigned char** buffer, int* capacity, int size) {
+    if (size <= *capacity) return 1;
+    int grown = *capacity ? *capacity : 1024;
+    while (grown < size) grown *= 2;
+    trackedFree(*buffer);
+    *buffer = (unsigned char*)trackedMalloc(grown, ALLOC_SAVE);
+    *capacity = *buffer ? grown : 0;
+    return *buffer != NULL;
+}
+
+static int readHeader(SaveReader* reader) {
+    reader->error = 0;
+    reader->cursor = 0;
+    reader->section.rawSize = 0;
+    if (!readSource(reader, &reader->header, sizeof(SaveFileHeader)) ||
+        reader->header.magic != SAVE_MAGIC || reader->header.version != SAVE_VERSION) {
+        reader->error = 1;
+        return 0;
+    }
+    return 1;
+}
+
+int beginSaveFile(SaveReader* reader, FILE* file) {
+    reader->file = file;
+    reader->memory = NULL;
+    return readHeader(reader);
+}
+
+int beginSaveMemory(SaveReader* reader, const void* data, size_t size) {
+    reader->file = NULL;
+    reader->memory = (const unsigned char*)data;
+    reader->memorySize = size;
+    reader->memoryPos = 0;
+    return readHeader(reader);
+}
+
+int nextSaveSection(SaveReader* reader) {
+    if (reader->error) return -1;
+
+    SaveSectionHeader* section = &reader->section;
+    if (!readSource(reader, section, sizeof(SaveSectionHeader)) ||
+        section->rawSize < 0 || section->rawSize > SAVE_MAX_SECTION ||
+        section->storedSize < 0 || section->storedSize > SAVE_MAX_SECTION ||
+        !growReaderBuffer(&reader->data, &reader->dataCapacity, section->rawSize)) {
+        reader->error = 1;
+        return -1;
+    }
+    reader->cursor = 0;
+
+    if (section->codec == SAVE_CODEC_NONE && section->storedSize == section->rawSize) {
+        if (!readSource(reader, reader->data, section->rawSize)) {
+            reader->error = 1;
+            return -1;
+        }
+    }
+    else if (section->codec == SAVE_CODEC_LZ) {
+        if (!growReaderBuffer(&reader->stored, &reader->storedCapacity, section->storedSize) ||
+            !readSource(reader, reader->stored, section->storedSize) ||
+            lzDecompress(reader->stored, section->storedSize, reader->data, section->rawSize) != section->rawSize) {
+            reader->error = 1;
+            return -1;
+        }
+    }
+    else {
+        reader->error = 1;
+        return -1;
+    }
+    return section->id;
+}
+
+int readSaveInt(SaveReader* reader) {
+    unsigned int zigzag = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (reader->cursor >= reader->section.rawSize) {
+            reader->error = 1;
+            return 0;
+        }
+        unsigned char byte = reader->data[reader->cursor++];
+        zigzag |= (unsigned int)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+        }
+    }
+    reader->error = 1;
+    return 0;
+}
+
+void readSaveBytes(SaveReader* reader, void* out, int size) {
+    if (size < 0 || size > reader->section.rawSize - reader->cursor) {
+        reader->error = 1;
+        return;
+    }
+    memcpy(out, reader->data + reader->cursor, size);
+    reader->cursor += size;
+}
+
+void readSaveItem(SaveReader* reader, Item* item, const Item* previous) {
+    item->name = (StringId)readSaveInt(reader);
+    item->category = (ItemCategory)readSaveInt(reader);
+    item->posX = previous->posX + readSaveInt(reader);
+    item->posY = previous->posY + readSaveInt(reader);
+    item->attackBonus = readSaveInt(reader);
+    item->defenseBonus = readSaveInt(reader);
+    item->healthBonus = readSaveInt(reader);
+    item->width = (unsigned char)readSaveInt(reader);
+    item->height = (unsigned char)readSaveInt(reader);
+    item->symbol = (char)readSaveInt(reader);
+    item->inInventory = (unsigned char)readSaveInt(reader);
+}
+
+void readSaveEnemy(SaveReader* reader, Enemy* enemy, const Enemy* previous) {
+    enemy->name = (StringId)readSaveInt(reader);
+    enemy->health = readSaveInt(reader);
+    enemy->attack = readSaveInt(reader);
+    enemy->defense = readSaveInt(reader);
+    enemy->EposX = previous->EposX + readSaveInt(reader);
+    enemy->EposY = previous->EposY + readSaveInt(reader);
+    enemy->prevX = enemy->EposX + readSaveInt(reader);
+    enemy->prevY = enemy->EposY + readSaveInt(reader);
+    enemy->moveDelay = readSaveInt(reader);
+    enemy->moveTimer = readSaveInt(reader);
+}
+
+void readSaveTrap(SaveReader* reader, Trap* trap, const Trap* previous) {
+    trap->posX = previous->posX + readSaveInt(reader);
+    trap->posY = previous->posY + readSaveInt(reader);
+    trap->damage = readSaveInt(reader);
+    trap->discovered = readSaveInt(reader);
+    trap->description = (StringId)readSaveInt(reader);
+}
+
+static int insideMap(int x, int y) {
+    return x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT;
+}
+
+static int readPlayerSection(SaveReader* reader, Player* player, int equipment[EQUIP_SLOT_COUNT][2]) {
+    memset(player, 0, sizeof(Player));
+    int nameLength = readSaveInt(reader);
+    if (nameLength < 0 || nameLength >= (int)sizeof(player->name)) return 0;
+    readSaveBytes(reader, player->name, nameLength);
+    player->health = readSaveInt(reader);
+    player->base_max_health = readSaveInt(reader);
+    player->base_attack = readSaveInt(reader);
+    player->base_defense = readSaveInt(reader);
+    player->max_health = player->base_max_health;
+    player->attack = player->base_attack;
+    player->defense = player->base_defense;
+    player->posX = readSaveInt(reader);
+    player->posY = readSaveInt(reader);
+    player->gold = readSaveInt(reader);
+    int invWidth = readSaveInt(reader);
+    int invHeight = readSaveInt(reader);
+    for (int i = 0; i < EQUIP_SLOT_COUNT; i++) {
+        equipment[i][0] = readSaveInt(reader);
+        equipment[i][1] = readSaveInt(reader);
+    }
+    if (reader->error || invWidth <= 0 || invHeight <= 0 || invWidth > 64 || invHeight > 64 ||
+        !insideMap(player->posX, player->posY)) {
+        return 0;
+    }
+    player->inventory = createInventory(invWidth, invHeight);
+    return 1;
+}
+
+// Buduje swiat z kolejnych sekcji. Wyposazenie zaklada sie na koncu, gdy
+// ekwipunek jest juz wczytany.
+static GameWorld* readWorld(SaveReader* reader) {
+    GameWorld* world = (GameWorld*)trackedMalloc(sizeof(GameWorld), ALLOC_WORLD);
+    if (!world) return NULL;
+
+    // Inicjalizuj wszystkie pola na NULL/0
+    memset(world, 0, sizeof(GameWorld));
+    world->saveGeneration = reader->header.generation;
+    world->turn = reader->header.turn;
+    world->status = GAME_RUNNING;
+    seedRandom(&world->random, newWorldSeed());  // Stan losowan nie trafia do zapisu
+    defaultBalance(&world->balance);
+    world->groundItems = (Item**)trackedCalloc(MAX_GROUND_ITEMS, sizeof(Item*), ALLOC_ITEM);
+
+    int equipment[EQUIP_SLOT_COUNT][2];
+    int ok = 1;
+    int id;
+    while (ok && (id = nextSaveSection(reader)) > SECTION_END) {
+        switch (id) {
+        case SECTION_WORLD:
+            world->level = readSaveInt(reader);
+            world->enemiesDefeated = readSaveInt(reader);
+            world->totalEnemiesDefeated = readSaveInt(reader);
+            world->portalActive = readSaveInt(reader);
+            world->portalX = readSaveInt(reader);
+            world->portalY = readSaveInt(reader);
+            memtrackBeginLevel(world->level);
+            break;
+        case SECTION_PLAYER:
+            if (world->player) {
+                ok = 0;
+                break;
+            }
+            world->player = (Player*)trackedMalloc(sizeof(Player), ALLOC_PLAYER);
+            ok = appendWorldPlayer(world, world->player) && readPlayerSection(reader, world->player, equipment);
+            break;
+        case SECTION_INVENTORY: {
+            if (!world->player || !world->player->inventory) {
+                ok = 0;
+                break;
+            }
+            int count = readSaveInt(reader);
+            Item previous;
+            memset(&previous, 0, sizeof(Item));
+            for (int i = 0; i < count && !reader->error; i++) {
+                Item* item = (Item*)trackedMalloc(sizeof(Item), ALLOC_ITEM);
+                readSaveItem(reader, item, &previous);
+                previous = *item;
+                item->inInventory = 0;
+                if (item->width == 0 || item->height == 0 ||
+                    !addItemToInventory(world->player->inventory, item, item->posX, item->posY)) {
+                    trackedFree(item);
+                    ok = 0;
+                    break;
+                }
+            }
+            break;
+        }
+        case SECTION_ENEMIES: {
+            int count = readSaveInt(reader);
+            if (world->enemies || count < 0 || count > reader->section.rawSize) {
+                ok = 0;
+                break;
+            }
+            world->enemies = (Enemy**)trackedMalloc((count > 0 ? count : 1) * sizeof(Enemy*), ALLOC_ENEMY);
+            Enemy previous;
+            memset(&previous, 0, sizeof(Enemy));
+            for (int i = 0; i < count; i++) {
+                world->enemies[i] = (Enemy*)trackedMalloc(sizeof(Enemy), ALLOC_ENEMY);
+                world->enemyCount++;
+                readSaveEnemy(reader, world->enemies[i], &previous);
+                previous = *world->enemies[i];
+                ok = ok && insideMap(previous.EposX, previous.EposY);
+            }
+            break;
+        }
+        case SECTION_TRAPS: {
+            int count = readSaveInt(reader);
+            if (world->traps || count < 0 || count > reader->section.rawSize) {
+                ok = 0;
+                break;
+            }
+            world->traps = (Trap**)trackedMalloc((count > 0 ? count : 1) * sizeof(Trap*), ALLOC_TRAP);
+            Trap previous;
+            memset(&previous, 0, sizeof(Trap));
+            for (int i = 0; i < count; i++) {
+                world->traps[i] = (Trap*)trackedMalloc(sizeof(Trap), ALLOC_TRAP);
+                world->trapCount++;
+                readSaveTrap(reader, world->traps[i], &previous);
+                previous = *world->traps[i];
+                ok = ok && insideMap(previous.posX, previous.posY);
+            }
+            break;
+        }
+        case SECTION_GROUND: {
+            int count = readSaveInt(reader);
+            Item previous;
+            memset(&previous, 0, sizeof(Item));
+            for (int i = 0; i < count && i < MAX_GROUND_ITEMS && !reader->error; i++) {
+                Item* item = (Item*)trackedMalloc(sizeof(Item), ALLOC_ITEM);
+                readSaveItem(reader, item, &previous);
+                previous = *item;
+                world->groundItems[world->groundItemCount++] = item;
+                ok = ok && insideMap(item->posX, item->posY);
+            }
+            break;
+        }
+        case SECTION_EFFECTS: {
+            // Po graczu i przeciwnikach - efekt z celem spoza swiata jest pomijany
+            int count = readSaveInt(reader);
+            for (int i = 0; i < count && !reader->error; i++) {
+                int type = readSaveInt(reader);
+                int onEnemy = readSaveInt(reader);
+                int target = readSaveInt(reader);
+                int magnitude = readSaveInt(reader);
+                int period = readSaveInt(reader);
+                int remaining = readSaveInt(reader);
+                int delay = readSaveInt(reader);
+                if (!reader->error) {
+                    restoreStatusEffect(world, onEnemy, target, (StatusEffectType)type, magnitude, period, remaining, delay);
+                }
+            }
+            break;
+        }
+        case SECTION_SCHEDULE:
+            world->schedule.clock = readSaveInt(reader);
+            world->schedule.valid = 0;
+            break;
+        default:
+            break;  // Sekcja z nowszej wersji - pomijana
+        }
+        ok = ok && !reader->error;
+    }
+
+    if (!ok || reader->error || !world->player || (world->portalActive && !insideMap(world->portalX, world->portalY))) {
+        freeGameWorld(world);
+        return NULL;
+    }
+
+    // Wyposazenie - statystyki pochodne odtwarzane przyrostowo przez equipItem
+    Inventory* inv = world->player->inventory;
+    int savedHealth = world->player->health;
+    for (int i = 0; i < EQUIP_SLOT_COUNT; i++) {
+        int x = equipment[i][0];
+        int y = equipment[i][1];
+        if (x >= 0 && x < inv->width && y >= 0 && y < inv->height && inv->items[y][x]) {
+            equipItem(world->player, inv->items[y][x]);
+        }
+    }
+    world->player->health = savedHealth;
+
+    world->events = createEventQueue();
+    initMap(world);
+    reloadMap(world);
+    return world;
+}
+
+GameWorld* parseSave(const void* data, size_t size) {
+    SaveReader reader;
+    initSaveReader(&reader);
+    GameWorld* world = beginSaveMemory(&reader, data, size) ? readWorld(&reader) : NULL;
+    freeSaveReader(&reader);
+    return world;
+}
+
+// Odczyt stanu gry z pliku bez komunikatow. NULL - brak pliku, nieznany format
+// albo uszkodzony zapis.
+GameWorld* readSaveFile(const char* path) {
+    FILE* file;
+    if (fopen_s(&file, path, "rb") != 0) {
+        return NULL;
+    }
+
+    SaveReader reader;
+    initSaveReader(&reader);
+    GameWorld* world = beginSaveFile(&reader, file) ? readWorld(&reader) : NULL;
+    freeSaveReader(&reader);
+    fclose(file);
+    return world;
+}
@@ -0,0 +1,75 @@
+﻿#pragma once
+
+// Format pliku zapisu. Po naglowku (SaveFileHeader) ida sekcje: naglowek
+// sekcji i jej bajty, spakowane kodekiem LZ albo surowe, gdy kompresja nic
+// nie daje. Wewnatrz sekcji liczby sa zmiennej dlugosci (varint, zigzag),
+// a wspolrzedne encji zapisywane jako roznica wzgledem poprzedniej encji.
+// Czytnik przechodzi po sekcjach strumieniowo i pomija nieznane sekcje.
+
+#include "graRPG10.h"
+
+typedef enum {
+    SECTION_END,
+    SECTION_WORLD,      // Liczniki swiata i portal
+    SECTION_PLAYER,     // Imie, statystyki bazowe, pozycja, rozmiar ekwipunku, wyposazenie
+    SECTION_INVENTORY,  // Liczba przedmiotow i przedmioty
+    SECTION_ENEMIES,
+    SECTION_TRAPS,
+    SECTION_GROUND,     // Przedmioty lezace na ziemi
+    SECTION_EFFECTS,    // Efekty statusu gracza i przeciwnikow
+    SECTION_SCHEDULE    // Zegar kolejki ruchow (moveTimer przeciwnikow liczy sie od niego)
+} SaveSectionId;
+
+typedef enum {
+    SAVE_CODEC_NONE,
+    SAVE_CODEC_LZ
+} SaveCodec;
+
+typedef struct {
+    int magic;
+    int version;
+    int generation;
+    int turn;
+} SaveFileHeader;
+
+typedef struct {
+    int id;
+    int codec;
+    int rawSize;
+    int storedSize;
+} SaveSectionHeader;
+
+// Bufor rosnacy przez podwajanie (trackedMalloc z ALLOC_SAVE)
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+} SaveBuffer;
+
+// Czytnik pliku albo bufora w pamieci. Bufory sekcji zostaja miedzy plikami,
+// wiec jeden czytnik moze przejsc wiele zapisow bez nowych alokacji.
+typedef struct {
+    FILE* file;                   // NULL - czytanie z pamieci
+    const unsigned char* memory;
+    size_t memorySize;
+    size_t memoryPos;
+    SaveFileHeader header;
+    SaveSectionHeader section;
+    unsigned char* data;          // Rozpakowana biezaca sekcja
+    int dataCapacity;
+    unsigned char* stored;        // Spakowane bajty sekcji
+    int storedCapacity;
+    int cursor;
+    int error;
+} SaveReader;
+
+void initSaveReader(SaveReader* reader);
+void freeSaveReader(SaveReader* reader);
+int beginSaveFile(SaveReader* reader, FILE* file);
+int beginSaveMemory(SaveReader* reader, const void* data, size_t size);
+int nextSaveSection(SaveReader* reader);  // Identyfikator sekcji, SECTION_END na koncu, -1 - blad
+int readSaveInt(SaveReader* reader);
+void readSaveBytes(SaveReader* reader, void* out, int size);
+void readSaveItem(SaveReader* reader, Item* item, const Item* previous);
+void readSaveEnemy(SaveReader* reader, Enemy* enemy, const Enemy* previous);
+void readSaveTrap(SaveReader* reader, Trap* trap, const Trap* previous);
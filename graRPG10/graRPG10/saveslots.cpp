@@ -0,0 +1,86 @@
+﻿#include "graRPG10.h"
+
+// Spis slotow zapisu: naglowek i SAVE_SLOT_COUNT wpisow. Plik jest maly i
+// zawsze zapisywany w calosci przez podmiane (writeFileAtomic), wiec
+// czytelnik widzi stary albo nowy spis, nigdy polowe.
+
+typedef struct {
+    int magic;
+    int version;
+    int count;
+} SaveIndexHeader;
+
+void saveSlotPath(int slot, char* out, size_t size) {
+    snprintf(out, size, SAVE_SLOT_PATH, slot + 1);
+}
+
+void journalSlotPath(int slot, char* out, size_t size) {
+    snprintf(out, size, JOURNAL_SLOT_PATH, slot + 1);
+}
+
+// Brak spisu albo uszkodzony spis daje same puste sloty
+int readSaveIndex(SaveIndex* index) {
+    memset(index, 0, sizeof(SaveIndex));
+
+    FILE* file;
+    if (fopen_s(&file, SAVE_INDEX_PATH, "rb") != 0) {
+        return 0;
+    }
+    SaveIndexHeader header;
+    int ok = fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == SAVE_INDEX_MAGIC && header.version == SAVE_INDEX_VERSION &&
+        header.count >= 0 && header.count <= SAVE_SLOT_COUNT &&
+        fread(index->slots, sizeof(SaveSlotInfo), header.count, file) == (size_t)header.count;
+    fclose(file);
+
+    if (!ok) {
+        memset(index, 0, sizeof(SaveIndex));
+        return 0;
+    }
+    for (int i = 0; i < SAVE_SLOT_COUNT; i++) {
+        index->slots[i].slotName[SAVE_SLOT_NAME_LENGTH - 1] = '\0';
+        index->slots[i].playerName[sizeof(index->slots[i].playerName) - 1] = '\0';
+    }
+    return 1;
+}
+
+// Spis z wpisem slotu swiata zaktualizowanym do biezacego stanu gry. Bufor
+// pochodzi z trackedMalloc(ALLOC_SAVE) - moze trafic do watku zapisu.
+void* serializeSaveIndex(GameWorld* world, size_t* outSize) {
+    if (world->saveSlot < 0 || world->saveSlot >= SAVE_SLOT_COUNT) {
+        return NULL;
+    }
+
+    SaveIndex index;
+    readSaveIndex(&index);
+    SaveSlotInfo* slot = &index.slots[world->saveSlot];
+    memset(slot, 0, sizeof(SaveSlotInfo));
+    slot->used = 1;
+    snprintf(slot->slotName, sizeof(slot->slotName), "%s", world->saveSlotName);
+    snprintf(slot->playerName, sizeof(slot->playerName), "%s", world->player->name);
+    slot->level = world->level;
+    slot->gold = world->player->gold;
+    slot->timestamp = (long long)time(NULL);
+
+    SaveIndexHeader header = { SAVE_INDEX_MAGIC, SAVE_INDEX_VERSION, SAVE_SLOT_COUNT };
+    size_t size = sizeof(header) + sizeof(index.slots);
+    char* data = (char*)trackedMalloc(size, ALLOC_SAVE);
+    if (!data) {
+        return NULL;
+    }
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + sizeof(header), index.slots, sizeof(index.slots));
+    *outSize = size;
+    return data;
+}
+
+int updateSaveIndex(GameWorld* world) {
+    size_t size;
+    void* data = serializeSaveIndex(world, &size);
+    if (!data) {
+        return 0;
+    }
+    int ok = writeFileAtomic(SAVE_INDEX_PATH, data, size);
+    trackedFree(data);
+    return ok;
+}
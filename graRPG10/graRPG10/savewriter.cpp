@@ -0,0 +1,140 @@
+﻿#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <string.h>
+#include "platform.h"
+#include "memtrack.h"
+#include "savewriter.h"
+
+typedef struct {
+    char path[SAVE_WRITER_MAX_PATH];
+    void* data;
+    size_t size;
+} SaveJob;
+
+struct SaveWriter {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;  // Nowe zadanie lub zatrzymanie
+    std::condition_variable idle;  // Kolejka pusta i nic sie nie zapisuje
+    SaveJob jobs[MAX_PENDING_SAVES];
+    int jobCount;
+    int busy;
+    int stopping;
+    SaveWriterStats stats;
+};
+
+int writeFileAtomic(const char* path, const void* data, size_t size) {
+    char tempPath[SAVE_WRITER_MAX_PATH + 8];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+    FILE* file;
+    if (fopen_s(&file, tempPath, "wb") != 0) {
+        return 0;
+    }
+    int ok = fwrite(data, 1, size, file) == size;
+    ok = syncFile(file) && ok;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || !replaceFile(tempPath, path)) {
+        remove(tempPath);
+        return 0;
+    }
+    return 1;
+}
+
+static void runSaveWriter(SaveWriter* writer) {
+    std::unique_lock<std::mutex> lock(writer->mutex);
+    for (;;) {
+        writer->wake.wait(lock, [writer] { return writer->jobCount > 0 || writer->stopping; });
+        if (writer->jobCount == 0) {
+            break;  // Zatrzymanie po oproznieniu kolejki
+        }
+
+        SaveJob job = writer->jobs[0];
+        writer->jobCount--;
+        memmove(&writer->jobs[0], &writer->jobs[1], writer->jobCount * sizeof(SaveJob));
+        writer->busy = 1;
+
+        // Dysk bez blokady - watek gry moze w tym czasie dodawac zadania
+        lock.unlock();
+        int ok = writeFileAtomic(job.path, job.data, job.size);
+        trackedFree(job.data);
+        lock.lock();
+
+        writer->busy = 0;
+        if (ok) {
+            writer->stats.completed++;
+            writer->stats.bytes += job.size;
+        }
+        else {
+            writer->stats.failed++;
+        }
+        if (writer->jobCount == 0) {
+            writer->idle.notify_all();
+        }
+    }
+}
+
+SaveWriter* startSaveWriter() {
+    void* memory = trackedMalloc(sizeof(SaveWriter), ALLOC_SAVE);
+    if (!memory) return NULL;
+
+    SaveWriter* writer = new (memory) SaveWriter();
+    writer->jobCount = 0;
+    writer->busy = 0;
+    writer->stopping = 0;
+    memset(&writer->stats, 0, sizeof(SaveWriterStats));
+    writer->thread = std::thread(runSaveWriter, writer);
+    return writer;
+}
+
+int submitSave(SaveWriter* writer, const char* path, void* data, size_t size) {
+    std::lock_guard<std::mutex> lock(writer->mutex);
+
+    SaveJob* job = NULL;
+    for (int i = 0; i < writer->jobCount; i++) {
+        if (strcmp(writer->jobs[i].path, path) == 0) {
+            job = &writer->jobs[i];
+            trackedFree(job->data);
+            writer->stats.superseded++;
+            break;
+        }
+    }
+    if (!job) {
+        if (writer->jobCount >= MAX_PENDING_SAVES) return 0;
+        job = &writer->jobs[writer->jobCount++];
+        snprintf(job->path, sizeof(job->path), "%s", path);
+    }
+    job->data = data;
+    job->size = size;
+    writer->wake.notify_one();
+    return 1;
+}
+
+int isSavePending(SaveWriter* writer) {
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    return writer->jobCount > 0 || writer->busy;
+}
+
+void waitForSaves(SaveWriter* writer) {
+    std::unique_lock<std::mutex> lock(writer->mutex);
+    writer->idle.wait(lock, [writer] { return writer->jobCount == 0 && !writer->busy; });
+}
+
+SaveWriterStats saveWriterStats(SaveWriter* writer) {
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    return writer->stats;
+}
+
+void stopSaveWriter(SaveWriter* writer) {
+    if (!writer) return;
+    {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        writer->stopping = 1;
+        writer->wake.notify_one();
+    }
+    writer->thread.join();
+    writer->~SaveWriter();
+    trackedFree(writer);
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+
+// Zapis plikow w tle. Watek gry oddaje gotowy bufor (zserializowany stan gry)
+// i wraca do rozgrywki, a watek zapisu pisze plik tymczasowy, wymusza zapis
+// na dysk i podmienia plik docelowy. Awaria w trakcie zapisu zostawia
+// poprzednia wersje pliku nienaruszona.
+
+#include <stddef.h>
+
+#define MAX_PENDING_SAVES 4
+#define SAVE_WRITER_MAX_PATH 260
+
+typedef struct SaveWriter SaveWriter;
+
+typedef struct {
+    long long completed;
+    long long failed;
+    long long superseded;  // Zapisy zastapione nowszym, zanim trafily na dysk
+    long long bytes;
+} SaveWriterStats;
+
+// Zapis synchroniczny: plik tymczasowy, fsync, podmiana
+int writeFileAtomic(const char* path, const void* data, size_t size);
+
+SaveWriter* startSaveWriter();
+// Przejmuje bufor (trackedMalloc z ALLOC_SAVE). Nowszy zapis tego samego pliku
+// zastepuje oczekujacy. Zwraca 0, gdy kolejka jest pelna - bufor zostaje u wywolujacego.
+int submitSave(SaveWriter* writer, const char* path, void* data, size_t size);
+int isSavePending(SaveWriter* writer);
+void waitForSaves(SaveWriter* writer);
+SaveWriterStats saveWriterStats(SaveWriter* writer);
+// Konczy oczekujace zapisy i zatrzymuje watek
+void stopSaveWriter(SaveWriter* writer);
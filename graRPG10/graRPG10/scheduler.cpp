@@ -0,0 +1,222 @@
+﻿#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "scheduler.h"
+
+// Kolejka swiatow jednego watku. Wlasciciel bierze z konca, zlodzieje z
+// poczatku - swiaty z poczatku sa najdalej od tego, czym wlasciciel sie
+// zajmuje.
+typedef struct {
+    std::mutex mutex;
+    int* worlds;
+    int head;
+    int tail;
+    int assigned;   // Swiaty shardu - tyle trafia do kolejki na poczatku rundy
+    int capacity;
+    long long turns;
+    long long steals;
+} SchedulerShard;
+
+struct WorldScheduler {
+    int threadCount;
+    std::thread* threads;   // threadCount - 1; watek wolajacy runWorldTurns to shard 0
+    SchedulerShard* shards;
+    ScheduledWorld* worlds;
+    int worldCount;
+    int worldCapacity;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    long long round;        // Kolejne wywolanie runWorldTurns
+    int turns;
+    int running;            // Watki pracujace w tej rundzie
+    int stop;
+    SchedulerStats stats;
+};
+
+static int takeOwnWorld(SchedulerShard* shard) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    if (shard->head == shard->tail) return -1;
+    return shard->worlds[--shard->tail];
+}
+
+static int stealWorld(SchedulerShard* shard) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    if (shard->head == shard->tail) return -1;
+    return shard->worlds[shard->head++];
+}
+
+static long long advanceWorld(ScheduledWorld* scheduled, int turns) {
+    GameWorld* world = scheduled->world;
+    long long done = 0;
+    while (done < turns && world->status == GAME_RUNNING) {
+        char move = scheduled->nextCommand(world, scheduled->context);
+        stepWorld(world, move, scheduled->chooseAction, scheduled->context);
+        drainEvents(world->events, NULL, 0);
+        done++;
+    }
+    scheduled->turns += done;
+    return done;
+}
+
+static void runShard(WorldScheduler* scheduler, int index, int turns) {
+    SchedulerShard* own = &scheduler->shards[index];
+    int world;
+    while ((world = takeOwnWorld(own)) >= 0) {
+        own->turns += advanceWorld(&scheduler->worlds[world], turns);
+    }
+
+    // Wlasne swiaty skonczone - podkradanie od kolejnych watkow
+    for (int offset = 1; offset < scheduler->threadCount; offset++) {
+        SchedulerShard* victim = &scheduler->shards[(index + offset) % scheduler->threadCount];
+        int stolen;
+        while ((stolen = stealWorld(victim)) >= 0) {
+            own->turns += advanceWorld(&scheduler->worlds[stolen], turns);
+            own->steals++;
+        }
+    }
+}
+
+static void runSchedulerWorker(WorldScheduler* scheduler, int index) {
+    long long seen = 0;
+    while (1) {
+        int turns;
+        {
+            std::unique_lock<std::mutex> lock(scheduler->mutex);
+            while (!scheduler->stop && scheduler->round == seen) {
+                scheduler->start.wait(lock);
+            }
+            if (scheduler->stop) return;
+            seen = scheduler->round;
+            turns = scheduler->turns;
+        }
+
+        runShard(scheduler, index, turns);
+
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        if (--scheduler->running == 0) {
+            scheduler->done.notify_one();
+        }
+    }
+}
+
+WorldScheduler* createWorldScheduler(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    WorldScheduler* scheduler = new WorldScheduler();
+    scheduler->threadCount = threads;
+    scheduler->shards = new SchedulerShard[threads]();
+    scheduler->threads = threads > 1 ? new std::thread[threads - 1] : NULL;
+    for (int i = 1; i < threads; i++) {
+        scheduler->threads[i - 1] = std::thread(runSchedulerWorker, scheduler, i);
+    }
+    return scheduler;
+}
+
+void freeWorldScheduler(WorldScheduler* scheduler) {
+    if (!scheduler) return;
+    {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        scheduler->stop = 1;
+        scheduler->start.notify_all();
+    }
+    for (int i = 1; i < scheduler->threadCount; i++) {
+        scheduler->threads[i - 1].join();
+    }
+    delete[] scheduler->threads;
+    for (int i = 0; i < scheduler->threadCount; i++) {
+        free(scheduler->shards[i].worlds);
+    }
+    delete[] scheduler->shards;
+    free(scheduler->worlds);
+    delete scheduler;
+}
+
+int schedulerThreadCount(const WorldScheduler* scheduler) {
+    return scheduler->threadCount;
+}
+
+int scheduleWorld(WorldScheduler* scheduler, GameWorld* world, WorldCommandFunction nextCommand,
+    BattleActionFunction chooseAction, void* context) {
+    if (scheduler->worldCount == scheduler->worldCapacity) {
+        int capacity = scheduler->worldCapacity ? scheduler->worldCapacity * 2 : 64;
+        ScheduledWorld* grown = (ScheduledWorld*)realloc(scheduler->worlds, capacity * sizeof(ScheduledWorld));
+        if (!grown) return -1;
+        scheduler->worlds = grown;
+        scheduler->worldCapacity = capacity;
+    }
+
+    // Shard swiata jest staly - ten sam watek zaczyna od niego w kazdej rundzie
+    SchedulerShard* shard = &scheduler->shards[scheduler->worldCount % scheduler->threadCount];
+    if (shard->assigned == shard->capacity) {
+        int capacity = shard->capacity ? shard->capacity * 2 : 16;
+        int* grown = (int*)realloc(shard->worlds, capacity * sizeof(int));
+        if (!grown) return -1;
+        shard->worlds = grown;
+        shard->capacity = capacity;
+    }
+
+    int index = scheduler->worldCount++;
+    ScheduledWorld* scheduled = &scheduler->worlds[index];
+    scheduled->world = world;
+    scheduled->nextCommand = nextCommand;
+    scheduled->chooseAction = chooseAction;
+    scheduled->context = context;
+    scheduled->turns = 0;
+    shard->assigned++;
+    return index;
+}
+
+int scheduledWorldCount(const WorldScheduler* scheduler) {
+    return scheduler->worldCount;
+}
+
+const ScheduledWorld* scheduledWorld(const WorldScheduler* scheduler, int index) {
+    return &scheduler->worlds[index];
+}
+
+long long runWorldTurns(WorldScheduler* scheduler, int turns) {
+    double startTime = nowSeconds();
+
+    // Kazdy shard od nowa dostaje swoje swiaty (indeksy i % threadCount)
+    for (int i = 0; i < scheduler->threadCount; i++) {
+        SchedulerShard* shard = &scheduler->shards[i];
+        shard->head = 0;
+        shard->tail = 0;
+        shard->turns = 0;
+        shard->steals = 0;
+        for (int w = i; w < scheduler->worldCount; w += scheduler->threadCount) {
+            shard->worlds[shard->tail++] = w;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        scheduler->turns = turns;
+        scheduler->running = scheduler->threadCount - 1;
+        scheduler->round++;
+        scheduler->start.notify_all();
+    }
+    runShard(scheduler, 0, turns);
+    {
+        std::unique_lock<std::mutex> lock(scheduler->mutex);
+        while (scheduler->running > 0) {
+            scheduler->done.wait(lock);
+        }
+    }
+
+    long long total = 0;
+    for (int i = 0; i < scheduler->threadCount; i++) {
+        total += scheduler->shards[i].turns;
+        scheduler->stats.steals += scheduler->shards[i].steals;
+    }
+    scheduler->stats.turns += total;
+    scheduler->stats.seconds += nowSeconds() - startTime;
+    return total;
+}
+
+SchedulerStats schedulerStats(const WorldScheduler* scheduler) {
+    return scheduler->stats;
+}
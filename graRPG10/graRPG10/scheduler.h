@@ -0,0 +1,42 @@
+﻿#pragma once
+
+// Wiele niezaleznych swiatow w jednym procesie (testy automatyczne, farmy
+// botow). Swiaty sa podzielone na shardy, po jednym na watek stalej puli;
+// watek, ktoremu skonczyly sie wlasne swiaty, podkrada nieruszone swiaty z
+// poczatku kolejek innych watkow. Swiat ma wlasne losowania (RandomState) i
+// wynik (status), wiec wynik nie zalezy od liczby watkow ani kolejnosci.
+
+#include "graRPG10.h"
+
+// Polecenie na kolejna ture swiata ('w', 'a', 's', 'd', 'p')
+typedef char (*WorldCommandFunction)(GameWorld* world, void* context);
+
+typedef struct {
+    GameWorld* world;
+    WorldCommandFunction nextCommand;
+    BattleActionFunction chooseAction;
+    void* context;        // Dla nextCommand i chooseAction
+    long long turns;      // Tury wykonane przez harmonogram
+} ScheduledWorld;
+
+typedef struct {
+    long long turns;
+    long long steals;     // Swiaty wykonane przez watek spoza swojego shardu
+    double seconds;       // Lacznie w runWorldTurns
+} SchedulerStats;
+
+typedef struct WorldScheduler WorldScheduler;
+
+WorldScheduler* createWorldScheduler(int threads);  // 0 - tyle, ile rdzeni
+void freeWorldScheduler(WorldScheduler* scheduler);  // Swiaty zostaja u wolajacego
+int schedulerThreadCount(const WorldScheduler* scheduler);
+
+// Indeks swiata w harmonogramie, -1 - brak pamieci
+int scheduleWorld(WorldScheduler* scheduler, GameWorld* world, WorldCommandFunction nextCommand,
+    BattleActionFunction chooseAction, void* context);
+int scheduledWorldCount(const WorldScheduler* scheduler);
+const ScheduledWorld* scheduledWorld(const WorldScheduler* scheduler, int index);
+
+// Kazdy trwajacy swiat wykonuje do turns tur; wynik - liczba wykonanych tur
+long long runWorldTurns(WorldScheduler* scheduler, int turns);
+SchedulerStats schedulerStats(const WorldScheduler* scheduler);
@@ -0,0 +1,807 @@
+﻿#ifndef __linux__
+#error "Serwer wieloosobowy wymaga epoll (Linux)"
+#endif
+
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "aoi.h"
+#include "graRPG10.h"
+#include "netproto.h"
+#include "server.h"
+
+#define SERVER_LISTENER_ID 0xFFFFFFFFu
+#define SERVER_MAX_EVENTS 256
+#define CLIENT_IN_SIZE 1024              // Klient wysyla tylko krotkie wiadomosci
+#define CLIENT_OUT_LIMIT (512 * 1024)    // Wiecej niezaslanych danych - klient rozlaczany
+
+typedef struct {
+    int fd;                  // -1 - wolny slot
+    Player* player;          // NULL do wiadomosci NET_HELLO i po smierci
+    unsigned char in[CLIENT_IN_SIZE];
+    int inUsed;
+    unsigned char* out;
+    int outUsed;
+    int outSent;
+    int writeArmed;          // Czeka na EPOLLOUT
+    int hasCommand;          // Ostatnie polecenie przed tickiem - wczesniejsze sa zastepowane
+    unsigned char command;
+    unsigned short commandSeq;
+    int wantsFull;           // Nowy klient dostaje wszystko ze swojego pola widzenia
+    int closing;             // Rozlaczenie po wyslaniu bufora
+    // Stan gracza z ostatniego rozeslanego ticku
+    int sentX;
+    int sentY;
+    int sentHealth;
+    int sentGold;
+    int sentVisible;
+} ServerClient;
+
+// Stan swiata z ostatniego rozeslanego ticku - zmiany liczone wzgledem niego
+typedef struct {
+    int valid;
+    int level;
+    int portalActive;
+    int portalX;
+    int portalY;
+    int enemyCount;
+    int trapCount;
+    Enemy* enemies;
+    int enemyCapacity;
+    unsigned char* trapDiscovered;
+    int trapCapacity;
+    int groundCount;
+    Item ground[MAX_GROUND_ITEMS];
+} WorldShadow;
+
+// Bufor wiadomosci jednego ticku - dzielony na kolejne NET_TICK, gdy przekroczy NET_MAX_MESSAGE
+typedef struct {
+    unsigned char* data;
+    int used;
+    int capacity;
+    int messageStart;
+    unsigned int tick;
+    int flags;
+} TickWriter;
+
+struct GameServer {
+    ServerConfig config;
+    int listenFd;
+    int epollFd;
+    int port;
+    std::atomic<int> stopping;
+    GameWorld* world;
+    ServerClient* clients;
+    AoiObserver* views;       // Pola widzenia wedlug slotow klientow - przezywaja kolejnych klientow
+    int clientCount;
+    WorldShadow shadow;
+    AoiGrid* interest;        // Obiekty biezacego ticku wedlug pozycji
+    TickWriter delta;         // Wiadomosc dla jednego klienta, nadpisywana dla kolejnych
+    unsigned int tick;
+    ServerStats stats;
+};
+
+// ---- Bufor ticku ----
+
+static unsigned char* reserveTick(TickWriter* writer, int size) {
+    if (writer->used + size > writer->capacity) {
+        int capacity = writer->capacity ? writer->capacity * 2 : 64 * 1024;
+        while (capacity < writer->used + size) capacity *= 2;
+        unsigned char* grown = (unsigned char*)realloc(writer->data, capacity);
+        if (!grown) return NULL;
+        writer->data = grown;
+        writer->capacity = capacity;
+    }
+    unsigned char* p = writer->data + writer->used;
+    writer->used += size;
+    return p;
+}
+
+static void openTickMessage(TickWriter* writer, int flags) {
+    writer->messageStart = writer->used;
+    unsigned char* p = reserveTick(writer, NET_HEADER_SIZE + 5);
+    p = netPutU16(p, 0);
+    p = netPutU8(p, NET_TICK);
+    p = netPutU32(p, writer->tick);
+    netPutU8(p, flags);
+}
+
+static void closeTickMessage(TickWriter* writer) {
+    netPutU16(writer->data + writer->messageStart, writer->used - writer->messageStart - 2);
+}
+
+static void beginTick(TickWriter* writer, unsigned int tick, int flags) {
+    writer->used = 0;
+    writer->tick = tick;
+    writer->flags = flags;
+    openTickMessage(writer, flags);
+}
+
+// Miejsce na rekord - gdy nie miesci sie w biezacej wiadomosci, zaczyna nastepna
+static unsigned char* tickRecord(TickWriter* writer, int size) {
+    if (writer->used - writer->messageStart - 2 + size > NET_MAX_MESSAGE) {
+        closeTickMessage(writer);
+        openTickMessage(writer, (writer->flags & ~NET_TICK_FULL) | NET_TICK_CONTINUED);
+    }
+    return reserveTick(writer, size);
+}
+
+static void endTick(TickWriter* writer) {
+    closeTickMessage(writer);
+}
+
+// ---- Rekordy zmian ----
+
+static void writeWorldRecord(TickWriter* writer, GameWorld* world) {
+    unsigned char* p = tickRecord(writer, 1 + 2 + 2 * 4);
+    p = netPutU8(p, NET_RECORD_WORLD);
+    p = netPutU8(p, world->level);
+    p = netPutU8(p, world->portalActive);
+    p = netPutU16(p, world->portalX);
+    p = netPutU16(p, world->portalY);
+    p = netPutU16(p, world->enemyCount);
+    netPutU16(p, world->trapCount);
+}
+
+static void writePlayerRecord(TickWriter* writer, int id, const Player* player) {
+    unsigned char* p = tickRecord(writer, 1 + 2 * 4 + 4);
+    p = netPutU8(p, NET_RECORD_PLAYER);
+    p = netPutU16(p, id);
+    p = netPutU16(p, player->posX);
+    p = netPutU16(p, player->posY);
+    p = netPutU16(p, (unsigned short)player->health);
+    netPutU32(p, (unsigned int)player->gold);
+}
+
+static void writeEnemyRecord(TickWriter* writer, int index, const Enemy* enemy) {
+    unsigned char* p = tickRecord(writer, 1 + 2 * 4);
+    p = netPutU8(p, NET_RECORD_ENEMY);
+    p = netPutU16(p, index);
+    p = netPutU16(p, enemy->EposX);
+    p = netPutU16(p, enemy->EposY);
+    netPutU16(p, (unsigned short)enemy->health);
+}
+
+static void writeTrapRecord(TickWriter* writer, int index, const Trap* trap) {
+    unsigned char* p = tickRecord(writer, 1 + 2 * 3);
+    p = netPutU8(p, NET_RECORD_TRAP);
+    p = netPutU16(p, index);
+    p = netPutU16(p, trap->posX);
+    netPutU16(p, trap->posY);
+}
+
+static void writeItemRecord(TickWriter* writer, int index, const Item* item) {
+    unsigned char* p = tickRecord(writer, 1 + 2 * 3 + 1);
+    p = netPutU8(p, NET_RECORD_ITEM);
+    p = netPutU16(p, index);
+    p = netPutU16(p, item->posX);
+    p = netPutU16(p, item->posY);
+    netPutU8(p, (unsigned char)item->symbol);
+}
+
+static void writeLeaveRecord(TickWriter* writer, unsigned int key) {
+    static const unsigned char recordTypes[AOI_KIND_COUNT] = {
+        NET_RECORD_PLAYER, NET_RECORD_ENEMY, NET_RECORD_TRAP, NET_RECORD_ITEM
+    };
+    unsigned char* p = tickRecord(writer, 1 + 1 + 2);
+    p = netPutU8(p, NET_RECORD_LEAVE);
+    p = netPutU8(p, recordTypes[AOI_KEY_KIND(key)]);
+    netPutU16(p, AOI_KEY_INDEX(key));
+}
+
+static void writeEntityRecord(GameServer* server, TickWriter* writer, unsigned int key) {
+    GameWorld* world = server->world;
+    int index = AOI_KEY_INDEX(key);
+    switch (AOI_KEY_KIND(key)) {
+    case AOI_PLAYER:
+        writePlayerRecord(writer, index, server->clients[index].player);
+        break;
+    case AOI_ENEMY:
+        writeEnemyRecord(writer, index, world->enemies[index]);
+        break;
+    case AOI_TRAP:
+        writeTrapRecord(writer, index, world->traps[index]);
+        break;
+    default:
+        writeItemRecord(writer, index, world->groundItems[index]);
+        break;
+    }
+}
+
+static int ensureShadow(WorldShadow* shadow, GameWorld* world) {
+    if (world->enemyCount > shadow->enemyCapacity) {
+        Enemy* grown = (Enemy*)realloc(shadow->enemies, world->enemyCount * sizeof(Enemy));
+        if (!grown) return 0;
+        shadow->enemies = grown;
+        shadow->enemyCapacity = world->enemyCount;
+    }
+    if (world->trapCount > shadow->trapCapacity) {
+        unsigned char* grown = (unsigned char*)realloc(shadow->trapDiscovered, world->trapCount);
+        if (!grown) return 0;
+        shadow->trapDiscovered = grown;
+        shadow->trapCapacity = world->trapCount;
+    }
+    return 1;
+}
+
+// Obiekty biezacego ticku do siatki, z flaga zmiany wzgledem shadow; shadow
+// przechodzi do stanu biezacego. Zwraca 1, gdy zmienil sie rekord swiata.
+static int collectInterest(GameServer* server) {
+    GameWorld* world = server->world;
+    WorldShadow* shadow = &server->shadow;
+    AoiGrid* grid = server->interest;
+    aoiClear(grid);
+    int tracked = ensureShadow(shadow, world);
+
+    int levelChanged = !shadow->valid || shadow->level != world->level;
+    int worldChanged = levelChanged || shadow->portalActive != world->portalActive ||
+        shadow->portalX != world->portalX || shadow->portalY != world->portalY ||
+        shadow->enemyCount != world->enemyCount || shadow->trapCount != world->trapCount;
+
+    for (int i = 0; i < server->config.maxClients; i++) {
+        ServerClient* client = &server->clients[i];
+        Player* player = client->player;
+        if (!player) continue;
+        int changed = !client->sentVisible || client->sentX != player->posX || client->sentY != player->posY ||
+            client->sentHealth != player->health || client->sentGold != player->gold;
+        aoiAdd(grid, AOI_KEY(AOI_PLAYER, i), player->posX, player->posY, changed);
+        client->sentVisible = 1;
+        client->sentX = player->posX;
+        client->sentY = player->posY;
+        client->sentHealth = player->health;
+        client->sentGold = player->gold;
+    }
+
+    for (int i = 0; i < world->enemyCount; i++) {
+        const Enemy* enemy = world->enemies[i];
+        int changed = 1;
+        if (tracked) {
+            Enemy* sent = &shadow->enemies[i];
+            changed = levelChanged || i >= shadow->enemyCount || sent->EposX != enemy->EposX ||
+                sent->EposY != enemy->EposY || sent->health != enemy->health;
+            *sent = *enemy;
+        }
+        aoiAdd(grid, AOI_KEY(AOI_ENEMY, i), enemy->EposX, enemy->EposY, changed);
+    }
+
+    // Tylko odkryte pulapki; nowy poziom - pulapki o tych samych indeksach sa inne
+    for (int i = 0; i < world->trapCount; i++) {
+        const Trap* trap = world->traps[i];
+        int discovered = trap->discovered != 0;
+        int changed = 1;
+        if (tracked) {
+            changed = levelChanged || i >= shadow->trapCount || !shadow->trapDiscovered[i];
+            shadow->trapDiscovered[i] = (unsigned char)discovered;
+        }
+        if (discovered) {
+            aoiAdd(grid, AOI_KEY(AOI_TRAP, i), trap->posX, trap->posY, changed);
+        }
+    }
+
+    for (int i = 0; i < world->groundItemCount; i++) {
+        const Item* item = world->groundItems[i];
+        Item* sent = &shadow->ground[i];
+        int changed = levelChanged || i >= shadow->groundCount || sent->posX != item->posX ||
+            sent->posY != item->posY || sent->symbol != item->symbol;
+        *sent = *item;
+        aoiAdd(grid, AOI_KEY(AOI_ITEM, i), item->posX, item->posY, changed);
+    }
+    aoiBuild(grid);
+
+    shadow->valid = tracked;
+    shadow->level = world->level;
+    shadow->portalActive = world->portalActive;
+    shadow->portalX = world->portalX;
+    shadow->portalY = world->portalY;
+    shadow->enemyCount = world->enemyCount;
+    shadow->trapCount = world->trapCount;
+    shadow->groundCount = world->groundItemCount;
+    return worldChanged;
+}
+
+// Tick dla jednego klienta: obiekty, ktore weszly w jego pole widzenia albo
+// sie w nim zmienily, i te, ktore z niego zniknely
+static void writeClientTick(GameServer* server, int index, int flags, int worldChanged) {
+    ServerClient* client = &server->clients[index];
+    AoiObserver* view = &server->views[index];
+    TickWriter* writer = &server->delta;
+    if (client->wantsFull) {
+        resetAoiObserver(view);
+        flags |= NET_TICK_FULL;
+    }
+    aoiUpdateObserver(server->interest, view, client->player->posX, client->player->posY, server->config.viewRadius);
+
+    beginTick(writer, server->tick, flags);
+    if (worldChanged || client->wantsFull) {
+        writeWorldRecord(writer, server->world);
+    }
+    for (int i = 0; i < view->updates.count; i++) {
+        writeEntityRecord(server, writer, view->updates.keys[i]);
+    }
+    for (int i = 0; i < view->leaves.count; i++) {
+        writeLeaveRecord(writer, view->leaves.keys[i]);
+    }
+    endTick(writer);
+    client->wantsFull = 0;
+}
+
+// ---- Klienci ----
+
+static void setWriteInterest(GameServer* server, int index, int enable) {
+    ServerClient* client = &server->clients[index];
+    if (client->writeArmed == enable) return;
+    struct epoll_event event;
+    event.events = enable ? (uint32_t)(EPOLLIN | EPOLLOUT) : (uint32_t)EPOLLIN;
+    event.data.u32 = (unsigned)index;
+    epoll_ctl(server->epollFd, EPOLL_CTL_MOD, client->fd, &event);
+    client->writeArmed = enable;
+}
+
+static void forgetPlayer(GameServer* server, int index) {
+    ServerClient* client = &server->clients[index];
+    if (!client->player) return;
+    // Obserwatorzy dostana NET_RECORD_LEAVE, gdy gracza zabraknie w siatce
+    removeWorldPlayer(server->world, client->player);
+    client->player = NULL;
+    client->sentVisible = 0;
+}
+
+static void closeClient(GameServer* server, int index) {
+    ServerClient* client = &server->clients[index];
+    if (client->fd < 0) return;
+    forgetPlayer(server, index);
+    epoll_ctl(server->epollFd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    client->fd = -1;
+    server->clientCount--;
+}
+
+static void dropClient(GameServer* server, int index) {
+    server->stats.droppedClients++;
+    closeClient(server, index);
+}
+
+// Wysyla, ile gniazdo przyjmie; reszta czeka na EPOLLOUT
+static void flushClient(GameServer* server, int index) {
+    ServerClient* client = &server->clients[index];
+    while (client->outSent < client->outUsed) {
+        ssize_t sent = send(client->fd, client->out + client->outSent, client->outUsed - client->outSent, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                setWriteInterest(server, index, 1);
+                return;
+            }
+            if (errno == EINTR) continue;
+            closeClient(server, index);
+            return;
+        }
+        client->outSent += (int)sent;
+        server->stats.bytesSent += sent;
+    }
+    client->outUsed = 0;
+    client->outSent = 0;
+    setWriteInterest(server, index, 0);
+    if (client->closing) {
+        closeClient(server, index);
+    }
+}
+
+static unsigned char* clientOutput(GameServer* server, int index, int size) {
+    ServerClient* client = &server->clients[index];
+    if (client->fd < 0) return NULL;
+    if (client->outSent > 0) {
+        memmove(client->out, client->out + client->outSent, client->outUsed - client->outSent);
+        client->outUsed -= client->outSent;
+        client->outSent = 0;
+    }
+    if (client->outUsed + size > CLIENT_OUT_LIMIT) {
+        dropClient(server, index);
+        return NULL;
+    }
+    unsigned char* p = client->out + client->outUsed;
+    client->outUsed += size;
+    return p;
+}
+
+static void sendToClient(GameServer* server, int index, const unsigned char* data, int size) {
+    unsigned char* p = clientOutput(server, index, size);
+    if (p) memcpy(p, data, size);
+}
+
+static void sendWelcome(GameServer* server, int index) {
+    unsigned char* p = clientOutput(server, index, NET_HEADER_SIZE + 8);
+    if (!p) return;
+    p = netPutU16(p, 1 + 8);
+    p = netPutU8(p, NET_WELCOME);
+    p = netPutU16(p, index);
+    p = netPutU16(p, MAP_WIDTH);
+    p = netPutU16(p, MAP_HEIGHT);
+    netPutU16(p, server->config.tickMs);
+}
+
+static void sendAck(GameServer* server, int index, unsigned short seq) {
+    unsigned char* p = clientOutput(server, index, NET_HEADER_SIZE + 6);
+    if (!p) return;
+    p = netPutU16(p, 1 + 6);
+    p = netPutU8(p, NET_ACK);
+    p = netPutU16(p, seq);
+    netPutU32(p, server->tick);
+}
+
+static void sendDied(GameServer* server, int index) {
+    unsigned char* p = clientOutput(server, index, NET_HEADER_SIZE + 4);
+    if (!p) return;
+    p = netPutU16(p, 1 + 4);
+    p = netPutU8(p, NET_DIED);
+    netPutU32(p, server->tick);
+}
+
+// Odpowiedz na I - zawartosc ekwipunku (lewe gorne rogi przedmiotow)
+static void sendInventory(GameServer* server, int index) {
+    Inventory* inv = server->clients[index].player->inventory;
+    int count = 0;
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            if (inv->items[y][x] && inv->items[y][x]->posX == x && inv->items[y][x]->posY == y) count++;
+        }
+    }
+    unsigned char* p = clientOutput(server, index, NET_HEADER_SIZE + 1 + count * 5);
+    if (!p) return;
+    p = netPutU16(p, 1 + 1 + count * 5);
+    p = netPutU8(p, NET_INVENTORY);
+    p = netPutU8(p, count);
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            Item* item = inv->items[y][x];
+            if (item && item->posX == x && item->posY == y) {
+                p = netPutU16(p, item->name);
+                p = netPutU8(p, item->category);
+                p = netPutU8(p, x);
+                p = netPutU8(p, y);
+            }
+        }
+    }
+}
+
+static void handleMessage(GameServer* server, int index, const unsigned char* data, int size) {
+    ServerClient* client = &server->clients[index];
+    int type = size > 0 ? data[0] : 0;
+    if (client->closing) return;
+
+    if (type == NET_HELLO && !client->player && size >= 2 && 2 + data[1] <= size) {
+        char name[50];
+        int length = data[1] < (int)sizeof(name) - 1 ? data[1] : (int)sizeof(name) - 1;
+        memcpy(name, data + 2, length);
+        name[length] = '\0';
+        client->player = addWorldPlayer(server->world, name);
+        if (!client->player) {
+            dropClient(server, index);
+            return;
+        }
+        sendWelcome(server, index);
+        client->wantsFull = 1;
+    }
+    else if (type == NET_COMMAND && size == 4) {
+        client->hasCommand = 1;
+        client->commandSeq = (unsigned short)netGetU16(data + 1);
+        client->command = data[3];
+    }
+    else {
+        dropClient(server, index);
+    }
+}
+
+static void readClient(GameServer* server, int index) {
+    ServerClient* client = &server->clients[index];
+    for (;;) {
+        ssize_t received = recv(client->fd, client->in + client->inUsed, CLIENT_IN_SIZE - client->inUsed, 0);
+        if (received == 0) {
+            closeClient(server, index);
+            return;
+        }
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) closeClient(server, index);
+            return;
+        }
+        client->inUsed += (int)received;
+
+        // Kompletne wiadomosci z poczatku bufora
+        int offset = 0;
+        while (client->inUsed - offset >= 2) {
+            int length = (int)netGetU16(client->in + offset);
+            if (length == 0 || length > CLIENT_IN_SIZE - 2) {
+                dropClient(server, index);
+                return;
+            }
+            if (client->inUsed - offset - 2 < length) break;
+            handleMessage(server, index, client->in + offset + 2, length);
+            if (client->fd < 0) return;
+            offset += 2 + length;
+        }
+        memmove(client->in, client->in + offset, client->inUsed - offset);
+        client->inUsed -= offset;
+    }
+}
+
+static void acceptClients(GameServer* server) {
+    for (;;) {
+        int fd = accept4(server->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        int index = -1;
+        for (int i = 0; i < server->config.maxClients; i++) {
+            if (server->clients[i].fd < 0) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            close(fd);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        // Bufor wyjsciowy zostaje w slocie dla kolejnych klientow
+        ServerClient* client = &server->clients[index];
+        unsigned char* out = client->out ? client->out : (unsigned char*)malloc(CLIENT_OUT_LIMIT);
+        if (!out) {
+            close(fd);
+            continue;
+        }
+        memset(client, 0, sizeof(ServerClient));
+        client->fd = fd;
+        client->out = out;
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = (unsigned)index;
+        if (epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            client->fd = -1;
+            continue;
+        }
+        server->clientCount++;
+        if (server->clientCount > server->stats.peakClients) {
+            server->stats.peakClients = server->clientCount;
+        }
+    }
+}
+
+// ---- Tick ----
+
+static BattleAction serverBattleAction(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)enemy;
+    (void)round;
+    (void)context;
+    return world->player->health < world->player->max_health / 4 ? BATTLE_FLEE : BATTLE_ATTACK;
+}
+
+// Smierc gracza konczy tylko jego gre - swiat toczy sie dalej
+static void handlePlayerStatus(GameServer* server, int index, int* levelWon) {
+    GameWorld* world = server->world;
+    if (world->status == GAME_LOST) {
+        server->stats.deaths++;
+        if (server->clients[index].fd >= 0) {
+            sendDied(server, index);
+            server->clients[index].closing = 1;
+        }
+        forgetPlayer(server, index);
+    }
+    else if (world->status == GAME_WON) {
+        // Ostatni poziom przejdzony - swiat zaczyna od pierwszego
+        *levelWon = 1;
+        world->status = GAME_RUNNING;
+        world->level = 0;
+        nextLevel(world);
+    }
+    world->status = GAME_RUNNING;
+}
+
+static void applyClientCommand(GameServer* server, int index, int* levelWon) {
+    ServerClient* client = &server->clients[index];
+    GameWorld* world = server->world;
+    char command = (char)client->command;
+    if (command >= 'A' && command <= 'Z') command = command - 'A' + 'a';
+
+    world->player = client->player;
+    if (command == 'w' || command == 'a' || command == 's' || command == 'd' || command == 'p') {
+        applyPlayerCommand(world, command);
+    }
+    else if (command == 'i') {
+        sendInventory(server, index);
+    }
+    // 'z' (zapis) celowo nieobslugiwany - zapis na dysk serwera w watku
+    // ticku to sprawa operatora, nie klienta
+    client->hasCommand = 0;
+    server->stats.commands++;
+    sendAck(server, index, client->commandSeq);
+    handlePlayerStatus(server, index, levelWon);
+}
+
+static void runTick(GameServer* server) {
+    double start = nowSeconds();
+    GameWorld* world = server->world;
+    server->tick++;
+    world->turn++;
+
+    int levelWon = 0;
+    for (int i = 0; i < server->config.maxClients; i++) {
+        ServerClient* client = &server->clients[i];
+        if (client->fd >= 0 && client->player && client->hasCommand) {
+            applyClientCommand(server, i, &levelWon);
+        }
+    }
+
+    // Pusty swiat (przed pierwszym klientem albo po wyjsciu ostatniego)
+    // stoi w miejscu - symulacja i mapa zakladaja aktywnego gracza
+    if (world->playerCount > 0) {
+        moveEnemies(world);
+        advanceStatusEffects(world, ENEMY_TICKS_PER_TURN);
+        for (int i = 0; i < server->config.maxClients; i++) {
+            ServerClient* client = &server->clients[i];
+            if (client->fd >= 0 && client->player) {
+                world->player = client->player;
+                resolveEncounters(world, serverBattleAction, NULL);
+                handlePlayerStatus(server, i, &levelWon);
+            }
+        }
+    }
+    world->player = world->playerCount > 0 ? world->players[0] : NULL;
+    if (world->player) {
+        reloadMap(world);
+    }
+    drainEvents(world->events, NULL, 0);
+
+    // Siatka raz na tick, potem kazdy klient dostaje zmiany ze swojego pola widzenia
+    int flags = levelWon ? NET_TICK_LEVEL_WON : 0;
+    int worldChanged = collectInterest(server);
+
+    for (int i = 0; i < server->config.maxClients; i++) {
+        ServerClient* client = &server->clients[i];
+        if (client->fd < 0) continue;
+        if (client->player) {
+            writeClientTick(server, i, flags, worldChanged);
+            sendToClient(server, i, server->delta.data, server->delta.used);
+        }
+        if (client->fd >= 0) {
+            flushClient(server, i);
+        }
+    }
+
+    double elapsed = nowSeconds() - start;
+    server->stats.ticks++;
+    server->stats.totalTickSeconds += elapsed;
+    if (elapsed > server->stats.maxTickSeconds) {
+        server->stats.maxTickSeconds = elapsed;
+    }
+}
+
+// ---- Cykl zycia ----
+
+GameServer* createGameServer(const ServerConfig* config) {
+    GameServer* server = new GameServer();
+    server->config = *config;
+    if (server->config.maxClients <= 0 || server->config.maxClients > MAX_PLAYERS) {
+        server->config.maxClients = MAX_PLAYERS;
+    }
+    if (server->config.tickMs <= 0) server->config.tickMs = 50;
+    server->stopping = 0;
+    server->epollFd = -1;
+
+    server->listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    setsockopt(server->listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((unsigned short)config->port);
+    socklen_t length = sizeof(address);
+    if (server->listenFd < 0 ||
+        bind(server->listenFd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(server->listenFd, SOMAXCONN) != 0 ||
+        getsockname(server->listenFd, (struct sockaddr*)&address, &length) != 0) {
+        freeGameServer(server);
+        return NULL;
+    }
+    server->port = ntohs(address.sin_port);
+
+    server->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u32 = SERVER_LISTENER_ID;
+    if (server->epollFd < 0 || epoll_ctl(server->epollFd, EPOLL_CTL_ADD, server->listenFd, &event) != 0) {
+        freeGameServer(server);
+        return NULL;
+    }
+
+    server->clients = (ServerClient*)calloc(server->config.maxClients, sizeof(ServerClient));
+    server->views = (AoiObserver*)calloc(server->config.maxClients, sizeof(AoiObserver));
+    for (int i = 0; i < server->config.maxClients; i++) {
+        server->clients[i].fd = -1;
+    }
+    server->interest = createAoiGrid(MAP_WIDTH, MAP_HEIGHT, AOI_DEFAULT_CELL);
+
+    // Swiat bez graczy - kazdy klient dostaje wlasnego w addWorldPlayer
+    server->world = createGameWorld("serwer");
+    removeWorldPlayer(server->world, server->world->player);
+    return server;
+}
+
+int gameServerPort(GameServer* server) {
+    return server->port;
+}
+
+void runGameServer(GameServer* server) {
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    double tickSeconds = server->config.tickMs / 1000.0;
+    double nextTick = nowSeconds() + tickSeconds;
+
+    while (!server->stopping && (server->config.ticks == 0 || server->stats.ticks < server->config.ticks)) {
+        double wait = nextTick - nowSeconds();
+        int timeoutMs = wait > 0.0 ? (int)(wait * 1000.0) + 1 : 0;
+        int count = epoll_wait(server->epollFd, events, SERVER_MAX_EVENTS, timeoutMs);
+
+        for (int i = 0; i < count; i++) {
+            unsigned int id = events[i].data.u32;
+            if (id == SERVER_LISTENER_ID) {
+                acceptClients(server);
+                continue;
+            }
+            if (server->clients[id].fd < 0) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeClient(server, (int)id);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flushClient(server, (int)id);
+            }
+            if ((events[i].events & EPOLLIN) && server->clients[id].fd >= 0) {
+                readClient(server, (int)id);
+            }
+        }
+
+        double now = nowSeconds();
+        if (now >= nextTick) {
+            runTick(server);
+            // Spozniony tick nie nadrabia zaleglosci seria kolejnych
+            nextTick += tickSeconds;
+            if (nextTick < now) nextTick = now + tickSeconds;
+        }
+    }
+}
+
+void stopGameServer(GameServer* server) {
+    server->stopping = 1;
+}
+
+ServerStats gameServerStats(GameServer* server) {
+    return server->stats;
+}
+
+void freeGameServer(GameServer* server) {
+    if (!server) return;
+    if (server->clients) {
+        for (int i = 0; i < server->config.maxClients; i++) {
+            if (server->clients[i].fd >= 0) close(server->clients[i].fd);
+            free(server->clients[i].out);
+            if (server->views) freeAoiObserver(&server->views[i]);
+        }
+    }
+    if (server->listenFd >= 0) close(server->listenFd);
+    if (server->epollFd >= 0) close(server->epollFd);
+    freeGameWorld(server->world);
+    free(server->clients);
+    free(server->views);
+    freeAoiGrid(server->interest);
+    free(server->shadow.enemies);
+    free(server->shadow.trapDiscovered);
+    free(server->delta.data);
+    delete server;
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+// Serwer wieloosobowy na jednym GameWorld. Jeden watek: nieblokujace gniazda
+// na epoll, polecenia klientow zbierane miedzy tickami i wykonywane raz na
+// tick, potem kazdy klient dostaje zmiany swiata ze swojego pola widzenia
+// (aoi.h, netproto.h).
+// Klient, ktory nie nadaza odbierac, jest rozlaczany - bufor wyjsciowy ma
+// staly limit, wiec jeden wolny klient nie opoznia ticku pozostalych.
+
+typedef struct {
+    int port;          // 0 - dowolny wolny port (gameServerPort)
+    int tickMs;
+    int maxClients;    // Najwyzej MAX_PLAYERS
+    long long ticks;   // 0 - do stopGameServer
+    int viewRadius;    // Pole widzenia: kwadrat o boku 2 * viewRadius + 1, < 0 - cala mapa
+} ServerConfig;
+
+#define SERVER_VIEW_RADIUS 8
+
+typedef struct {
+    long long ticks;
+    long long commands;
+    long long bytesSent;
+    long long droppedClients;  // Rozlaczeni przez przepelniony bufor lub bledny protokol
+    long long deaths;
+    int peakClients;
+    double totalTickSeconds;   // Symulacja + przygotowanie i wyslanie zmian
+    double maxTickSeconds;
+} ServerStats;
+
+typedef struct GameServer GameServer;
+
+GameServer* createGameServer(const ServerConfig* config);  // NULL - nie mozna otworzyc portu
+int gameServerPort(GameServer* server);
+void runGameServer(GameServer* server);
+void stopGameServer(GameServer* server);  // Mozna wolac z innego watku
+ServerStats gameServerStats(GameServer* server);
+void freeGameServer(GameServer* server);
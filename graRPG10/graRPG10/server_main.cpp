@@ -0,0 +1,47 @@
+﻿#include "graRPG10.h"
+#include "server.h"
+#include "netproto.h"
+
+// Serwer gry wieloosobowej na localhost.
+// Uzycie: graRPG10_server [--port N] [--tick-ms N] [--max-clients N] [--ticks N] [--view-radius N]
+
+int main(int argc, char* argv[]) {
+    ServerConfig config = { NET_DEFAULT_PORT, 50, MAX_PLAYERS, 0, SERVER_VIEW_RADIUS };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            config.port = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc) {
+            config.tickMs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--max-clients") == 0 && i + 1 < argc) {
+            config.maxClients = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            config.ticks = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--view-radius") == 0 && i + 1 < argc) {
+            config.viewRadius = atoi(argv[++i]);
+        }
+    }
+
+    srand((unsigned)time(NULL));
+    initStringTable();
+
+    GameServer* server = createGameServer(&config);
+    if (!server) {
+        fprintf(stderr, "Nie mozna uruchomic serwera na porcie %d!\n", config.port);
+        return 1;
+    }
+    fprintf(stderr, "Serwer nasluchuje na 127.0.0.1:%d (tick %d ms)\n", gameServerPort(server), config.tickMs);
+    runGameServer(server);
+
+    ServerStats stats = gameServerStats(server);
+    fprintf(stderr, "Tickow: %lld, polecen: %lld, wyslano %.1f MB, szczyt klientow: %d, smierci: %lld, rozlaczeni: %lld\n",
+        stats.ticks, stats.commands, stats.bytesSent / (1024.0 * 1024.0), stats.peakClients, stats.deaths,
+        stats.droppedClients);
+    fprintf(stderr, "Czas ticku: srednio %.3f ms, max %.3f ms\n",
+        stats.ticks ? stats.totalTickSeconds * 1000.0 / stats.ticks : 0.0, stats.maxTickSeconds * 1000.0);
+    freeGameServer(server);
+    return 0;
+}
@@ -0,0 +1,126 @@
+﻿#include "graRPG10.h"
+
+// Test dlugiej sesji: 100k tur bez konsoli z losowymi ruchami gracza.
+// Po kazdym zakonczeniu gry swiat jest zwalniany i musi zniknac cala pamiec,
+// a szczyt zywej pamieci w drugiej polowie testu nie moze rosnac wzgledem pierwszej.
+
+#ifndef GRA_TRACK_ALLOC
+#error "soak_test wymaga kompilacji z GRA_TRACK_ALLOC"
+#endif
+
+#define SOAK_TURNS 100000
+#define SOAK_WINDOW 10000
+#define SOAK_GROWTH_LIMIT 1.10  // Dopuszczalny wzrost szczytu w drugiej polowie
+
+static BattleAction soakBattleAction(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)enemy;
+    (void)round;
+    (void)context;
+    return world->player->health < world->player->max_health / 4 ? BATTLE_FLEE : BATTLE_ATTACK;
+}
+
+// Pierwszy przedmiot danej kategorii w ekwipunku (lewy gorny rog przedmiotu)
+static Item* findInventoryItem(Inventory* inv, ItemCategory category, int skipEquipped, const Player* player) {
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            Item* item = inv->items[y][x];
+            if (item && item->posX == x && item->posY == y && item->category == category &&
+                !(skipEquipped && isItemEquipped(player, item))) {
+                return item;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Decyzje gracza: leczenie, zmiana wyposazenia, podnoszenie i ruch
+static char chooseSoakMove(GameWorld* world) {
+    Player* player = world->player;
+
+    if (player->health < player->max_health / 2) {
+        useItem(world, player, findInventoryItem(player->inventory, ITEM_POTION, 0, player));
+    }
+    if (rand() % 50 == 0) {
+        ItemCategory category = rand() % 2 ? ITEM_SWORD : ITEM_ARMOR;
+        useItem(world, player, findInventoryItem(player->inventory, category, 1, player));
+    }
+    if (groundItemAt(world, player->posX, player->posY) >= 0) {
+        return 'p';
+    }
+
+    // Gdy portal jest otwarty - idz w jego strone, inaczej losowo
+    if (world->portalActive && rand() % 4 != 0) {
+        if (world->portalX > player->posX) return 'd';
+        if (world->portalX < player->posX) return 'a';
+        if (world->portalY > player->posY) return 's';
+        return 'w';
+    }
+    static const char moves[] = { 'w', 'a', 's', 'd' };
+    return moves[rand() % 4];
+}
+
+static int checkNoLiveGameMemory(long long turn) {
+    int ok = 1;
+    for (int tag = 0; tag < ALLOC_TAG_COUNT; tag++) {
+        AllocTagStats stats = memtrackTagStats((AllocTag)tag);
+        if (stats.liveBlocks != 0 || stats.liveBytes != 0) {
+            fprintf(stderr, "BLAD: po zwolnieniu swiata (tura %lld) zostalo %lld blokow / %lld B w podsystemie %d\n",
+                turn, stats.liveBlocks, stats.liveBytes, tag);
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+int main() {
+    srand(20240501);
+    initStringTable();
+
+    EventStats stats;
+    memset(&stats, 0, sizeof(EventStats));
+    EventSubscriber subscribers[1] = { { collectEventStats, &stats } };
+
+    long long windowPeak[SOAK_TURNS / SOAK_WINDOW];
+    memset(windowPeak, 0, sizeof(windowPeak));
+
+    int ok = 1;
+    int games = 1;
+    GameWorld* world = createGameWorld("Soak");
+
+    for (long long turn = 0; turn < SOAK_TURNS; turn++) {
+        stepWorld(world, chooseSoakMove(world), soakBattleAction, NULL);
+        drainEvents(world->events, subscribers, 1);
+
+        long long live = memtrackLiveBytes();
+        long long* peak = &windowPeak[turn / SOAK_WINDOW];
+        if (live > *peak) *peak = live;
+
+        if (world->status != GAME_RUNNING) {
+            freeGameWorld(world);
+            ok &= checkNoLiveGameMemory(turn);
+            world = createGameWorld("Soak");
+            games++;
+        }
+    }
+    freeGameWorld(world);
+    ok &= checkNoLiveGameMemory(SOAK_TURNS);
+
+    // Stan ustalony: szczyt w drugiej polowie nie wiekszy niz w pierwszej (z marginesem)
+    const int windows = SOAK_TURNS / SOAK_WINDOW;
+    long long firstHalf = 0, secondHalf = 0;
+    for (int i = 0; i < windows; i++) {
+        long long* half = i < windows / 2 ? &firstHalf : &secondHalf;
+        if (windowPeak[i] > *half) *half = windowPeak[i];
+    }
+    printf("Tury: %d | gry: %d | poziomy: %d | pokonani: %d | przedmioty: %d\n", SOAK_TURNS, games,
+        stats.counts[EVENT_LEVEL_CHANGED], stats.counts[EVENT_ENEMY_DEFEATED], stats.counts[EVENT_ITEM_PICKED_UP]);
+    printf("Szczyt zywej pamieci: pierwsza polowa %lld B, druga polowa %lld B\n", firstHalf, secondHalf);
+    if (secondHalf > (long long)(firstHalf * SOAK_GROWTH_LIMIT)) {
+        fprintf(stderr, "BLAD: zuzycie pamieci rosnie w trakcie sesji\n");
+        ok = 0;
+    }
+
+    printMemtrackReport(stdout);
+    printf(ok ? "OK\n" : "BLAD\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+﻿#include "graRPG10.h"
+
+// Efekty statusu (trucizna, krwawienie, regeneracja, premie z mikstur) w
+// hierarchicznym kole czasowym: 3 poziomy po 64 przegrodki. Efekt czeka w
+// przegrodce ticku swojego nastepnego dzialania; dalekie terminy leza na
+// wyzszych poziomach i zsypuja sie nizej, gdy zegar do nich dojdzie. Tick
+// kosztuje O(1) plus dzialajace efekty, niezaleznie od liczby wszystkich.
+//
+// Trucizna i krwawienie nie zabijaja - zostawiaja co najmniej 1 HP, wiec
+// smierc zostaje sprawa walki i pulapek.
+
+#define EFFECT_WHEEL_MASK (EFFECT_WHEEL_SLOTS - 1)
+#define EFFECT_HORIZON (1LL << (EFFECT_WHEEL_BITS * EFFECT_WHEEL_LEVELS))
+
+static const StringId effectNames[EFFECT_TYPE_COUNT] = {
+    STR_POISON,
+    STR_BLEEDING,
+    STR_REGENERATION,
+    STR_STRENGTH
+};
+
+static int isTimedBonus(int type) {
+    return type == EFFECT_STRENGTH;
+}
+
+static Player* effectPlayer(GameWorld* world, const StatusEffect* effect) {
+    if (effect->onEnemy || effect->target < 0 || effect->target >= world->playerCount) return NULL;
+    return world->players[effect->target];
+}
+
+static Enemy* effectEnemy(GameWorld* world, const StatusEffect* effect) {
+    if (!effect->onEnemy || effect->target < 0 || effect->target >= world->enemyCount) return NULL;
+    return world->enemies[effect->target];
+}
+
+static int* slotHead(StatusEffects* effects, int slot) {
+    return &effects->wheel[slot / EFFECT_WHEEL_SLOTS][slot % EFFECT_WHEEL_SLOTS];
+}
+
+// Wstawia efekt do przegrodki jego terminu (termin nie wczesniej niz zegar)
+static void linkEffect(StatusEffects* effects, int index) {
+    StatusEffect* effect = &effects->pool[index];
+    long long delta = effect->due - effects->clock;
+    if (delta >= EFFECT_HORIZON) {
+        effect->due = effects->clock + EFFECT_HORIZON - 1;
+        delta = EFFECT_HORIZON - 1;
+    }
+
+    int level = 0;
+    while (level + 1 < EFFECT_WHEEL_LEVELS && delta >= (1LL << (EFFECT_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    effect->slot = (short)(level * EFFECT_WHEEL_SLOTS +
+        (int)((effect->due >> (EFFECT_WHEEL_BITS * level)) & EFFECT_WHEEL_MASK));
+
+    int* head = slotHead(effects, effect->slot);
+    effect->prev = 0;
+    effect->next = *head;
+    if (*head) effects->pool[*head - 1].prev = index + 1;
+    *head = index + 1;
+}
+
+static void unlinkEffect(StatusEffects* effects, int index) {
+    StatusEffect* effect = &effects->pool[index];
+    if (effect->prev) effects->pool[effect->prev - 1].next = effect->next;
+    else *slotHead(effects, effect->slot) = effect->next;
+    if (effect->next) effects->pool[effect->next - 1].prev = effect->prev;
+}
+
+// Lista efektow celu - zapytania i usuwanie nie przegladaja puli
+static int* targetHead(StatusEffects* effects, int onEnemy, int target) {
+    return &effects->targetHeads[onEnemy][target];
+}
+
+// Tablica glow rosnie nowym blokiem, jak pula
+static int growTargetHeads(GameWorld* world, int onEnemy, int target) {
+    StatusEffects* effects = &world->effects;
+    int capacity = effects->targetCapacity[onEnemy];
+    if (target < capacity) return 1;
+    int grown = capacity ? capacity * 2 : 16;
+    while (grown <= target) grown *= 2;
+    int* heads = (int*)trackedCalloc(grown, sizeof(int), ALLOC_WORLD);
+    if (!heads) return 0;
+    if (capacity > 0) {
+        memcpy(heads, effects->targetHeads[onEnemy], capacity * sizeof(int));
+    }
+    freeWorldObject(&world->clone, effects->targetHeads[onEnemy]);
+    effects->targetHeads[onEnemy] = heads;
+    effects->targetCapacity[onEnemy] = grown;
+    return 1;
+}
+
+static void linkTarget(StatusEffects* effects, int index) {
+    StatusEffect* effect = &effects->pool[index];
+    int* head = targetHead(effects, effect->onEnemy, effect->target);
+    effect->targetPrev = 0;
+    effect->targetNext = *head;
+    if (*head) effects->pool[*head - 1].targetPrev = index + 1;
+    *head = index + 1;
+}
+
+static void unlinkTarget(StatusEffects* effects, int index) {
+    StatusEffect* effect = &effects->pool[index];
+    if (effect->targetPrev) effects->pool[effect->targetPrev - 1].targetNext = effect->targetNext;
+    else *targetHead(effects, effect->onEnemy, effect->target) = effect->targetNext;
+    if (effect->targetNext) effects->pool[effect->targetNext - 1].targetPrev = effect->targetPrev;
+}
+
+static void releaseEffect(StatusEffects* effects, int index) {
+    StatusEffect* effect = &effects->pool[index];
+    unlinkTarget(effects, index);
+    effect->active = 0;
+    effect->next = effects->freeList;
+    effects->freeList = index + 1;
+    effects->count--;
+}
+
+// Pula rosnie nowym blokiem - stara moze lezec w bloku klonu
+static int growEffectPool(GameWorld* world) {
+    StatusEffects* effects = &world->effects;
+    int capacity = effects->capacity ? effects->capacity * 2 : 16;
+    StatusEffect* pool = (StatusEffect*)trackedMalloc(capacity * sizeof(StatusEffect), ALLOC_WORLD);
+    if (!pool) return 0;
+    if (effects->capacity > 0) {
+        memcpy(pool, effects->pool, effects->capacity * sizeof(StatusEffect));
+    }
+    // Nowe wezly na poczatek listy wolnych, od najnizszego indeksu
+    for (int i = capacity - 1; i >= effects->capacity; i--) {
+        pool[i].active = 0;
+        pool[i].next = effects->freeList;
+        effects->freeList = i + 1;
+    }
+    freeWorldObject(&world->clone, effects->pool);
+    effects->pool = pool;
+    effects->capacity = capacity;
+    return 1;
+}
+
+static void emitPlayerEffect(GameWorld* world, const StatusEffect* effect, GameEventType type, int value) {
+    Player* player = effectPlayer(world, effect);
+    if (!player) return;
+    emitEventAt(world, type, effectNames[effect->type], value, 0, player->posX, player->posY);
+}
+
+// Zmiana zdrowia celu: leczenie do maksimum, obrazenia najwyzej do 1 HP
+static int changeHealth(int* health, int maxHealth, int amount) {
+    int before = *health;
+    *health += amount;
+    if (*health > maxHealth) *health = maxHealth;
+    if (amount < 0 && *health < 1) *health = before < 1 ? before : 1;
+    return *health - before;
+}
+
+static void revertBonus(GameWorld* world, const StatusEffect* effect) {
+    Player* player = effectPlayer(world, effect);
+    if (player && effect->type == EFFECT_STRENGTH) {
+        player->effect_attack -= effect->magnitude;
+    }
+}
+
+// Dzialanie efektu w jego ticku. 1 - efekt trwa dalej.
+static int fireEffect(GameWorld* world, StatusEffect* effect) {
+    if (isTimedBonus(effect->type)) {
+        revertBonus(world, effect);
+        emitPlayerEffect(world, effect, EVENT_STATUS_EXPIRED, 0);
+        return 0;
+    }
+
+    int amount = effect->type == EFFECT_REGENERATION ? effect->magnitude : -effect->magnitude;
+    Player* player = effectPlayer(world, effect);
+    Enemy* enemy = effectEnemy(world, effect);
+    if (player) {
+        int change = changeHealth(&player->health, player->max_health, amount);
+        emitPlayerEffect(world, effect, EVENT_STATUS_TICK, change);
+    }
+    else if (enemy) {
+        changeHealth(&enemy->health, enemy->health, amount);  // Przeciwnik nie ma maksimum zdrowia
+    }
+    else {
+        return 0;  // Cel zniknal (np. po odtworzeniu dziennika)
+    }
+
+    if (--effect->remaining > 0) return 1;
+    emitPlayerEffect(world, effect, EVENT_STATUS_EXPIRED, 0);
+    return 0;
+}
+
+// Efekt z pierwszym dzialaniem za delay tickow (wczytanie zapisu). 1 - efekt nalozony.
+int restoreStatusEffect(GameWorld* world, int onEnemy, int target, StatusEffectType type, int magnitude, int period,
+    int count, int delay) {
+    StatusEffects* effects = &world->effects;
+    if (type < 0 || type >= EFFECT_TYPE_COUNT || period < 1 || count < 1 || delay < 1) return 0;
+    if (isTimedBonus(type) && onEnemy) return 0;  // Premie tylko dla graczy
+    if (target < 0 || target >= (onEnemy ? world->enemyCount : world->playerCount)) return 0;
+    if (!growTargetHeads(world, onEnemy != 0, target)) return 0;
+    if (!effects->freeList && !growEffectPool(world)) return 0;
+
+    int index = effects->freeList - 1;
+    StatusEffect* effect = &effects->pool[index];
+    effects->freeList = effect->next;
+    effects->count++;
+
+    effect->type = (unsigned char)type;
+    effect->onEnemy = (unsigned char)(onEnemy != 0);
+    effect->active = 1;
+    effect->target = target;
+    effect->magnitude = magnitude;
+    effect->period = period;
+    effect->remaining = isTimedBonus(type) ? 1 : count;
+    effect->due = effects->clock + delay;
+    linkEffect(effects, index);
+    linkTarget(effects, index);
+
+    Player* player = effectPlayer(world, effect);
+    if (player && type == EFFECT_STRENGTH) {
+        player->effect_attack += magnitude;
+    }
+    return 1;
+}
+
+// Naklada efekt: count dzialan co period tickow (premia - jedno zdjecie po
+// period tickach). 1 - efekt nalozony.
+int applyStatusEffect(GameWorld* world, int onEnemy, int target, StatusEffectType type, int magnitude, int period,
+    int count) {
+    if (!restoreStatusEffect(world, onEnemy, target, type, magnitude, period, count, period)) return 0;
+    if (!onEnemy) {
+        int turns = (period * (isTimedBonus(type) ? 1 : count) + ENEMY_TICKS_PER_TURN - 1) / ENEMY_TICKS_PER_TURN;
+        Player* player = world->players[target];
+        emitEventAt(world, EVENT_STATUS_APPLIED, effectNames[type], turns, 0, player->posX, player->posY);
+    }
+    return 1;
+}
+
+// Zsypuje przegrodke wyzszego poziomu na nizsze - terminy sa juz blizej
+static void cascadeSlot(StatusEffects* effects, int level, int index) {
+    int* head = &effects->wheel[level][index];
+    int node = *head;
+    *head = 0;
+    while (node) {
+        int next = effects->pool[node - 1].next;
+        linkEffect(effects, node - 1);
+        node = next;
+    }
+}
+
+void advanceStatusEffects(GameWorld* world, int ticks) {
+    StatusEffects* effects = &world->effects;
+    for (int t = 0; t < ticks; t++) {
+        effects->clock++;
+        if (effects->count == 0) continue;
+
+        int index = (int)(effects->clock & EFFECT_WHEEL_MASK);
+        // Poziom nizej zrobil pelny obrot - zsypuje sie kolejna przegrodka wyzszego
+        if (index == 0) {
+            for (int level = 1; level < EFFECT_WHEEL_LEVELS; level++) {
+                int upper = (int)((effects->clock >> (EFFECT_WHEEL_BITS * level)) & EFFECT_WHEEL_MASK);
+                cascadeSlot(effects, level, upper);
+                if (upper != 0) break;
+            }
+        }
+
+        // Lista przegrodki odpieta w calosci - efekty przedluzone trafiaja do innych przegrodek
+        int node = effects->wheel[0][index];
+        effects->wheel[0][index] = 0;
+        while (node) {
+            int current = node - 1;
+            node = effects->pool[current].next;
+            StatusEffect* effect = &effects->pool[current];
+            if (fireEffect(world, effect)) {
+                effect->due += effect->period;
+                linkEffect(effects, current);
+            }
+            else {
+                releaseEffect(effects, current);
+            }
+        }
+    }
+}
+
+// Pozostale ticki najdluzszego efektu kazdego typu na graczu
+static void playerEffectTicks(const GameWorld* world, const Player* player, long long longest[EFFECT_TYPE_COUNT]) {
+    const StatusEffects* effects = &world->effects;
+    memset(longest, 0, EFFECT_TYPE_COUNT * sizeof(long long));
+    int index = worldPlayerIndex(world, player);
+    if (index < 0 || index >= effects->targetCapacity[0]) return;
+    for (int node = effects->targetHeads[0][index]; node; node = effects->pool[node - 1].targetNext) {
+        const StatusEffect* effect = &effects->pool[node - 1];
+        long long left = effect->due - effects->clock + (long long)(effect->remaining - 1) * effect->period;
+        if (left > longest[effect->type]) longest[effect->type] = left;
+    }
+}
+
+static int ticksToTurns(long long ticks) {
+    return (int)((ticks + ENEMY_TICKS_PER_TURN - 1) / ENEMY_TICKS_PER_TURN);
+}
+
+// Pozostale tury najdluzszego efektu danego typu na graczu (0 - brak)
+int statusEffectTurns(const GameWorld* world, const Player* player, StatusEffectType type) {
+    long long longest[EFFECT_TYPE_COUNT];
+    playerEffectTicks(world, player, longest);
+    return ticksToTurns(longest[type]);
+}
+
+static void cancelEffect(GameWorld* world, int index) {
+    StatusEffect* effect = &world->effects.pool[index];
+    if (isTimedBonus(effect->type)) revertBonus(world, effect);
+    unlinkEffect(&world->effects, index);
+    releaseEffect(&world->effects, index);
+}
+
+static void cancelTargetEffects(GameWorld* world, int onEnemy, int target) {
+    StatusEffects* effects = &world->effects;
+    if (target >= effects->targetCapacity[onEnemy]) return;
+    int* head = targetHead(effects, onEnemy, target);
+    while (*head) {
+        cancelEffect(world, *head - 1);
+    }
+}
+
+// Przenosi liste efektow celu from na cel to (glowa to musi byc pusta)
+static void retargetEffects(StatusEffects* effects, int onEnemy, int from, int to) {
+    int* source = targetHead(effects, onEnemy, from);
+    for (int node = *source; node; node = effects->pool[node - 1].targetNext) {
+        effects->pool[node - 1].target = to;
+    }
+    *targetHead(effects, onEnemy, to) = *source;
+    *source = 0;
+}
+
+// Przed usunieciem world->enemies[index]: jego efekty znikaja, a listy
+// dalszych przeciwnikow przesuwaja sie o jeden jak ich tablica
+void removeEnemyEffects(GameWorld* world, int index) {
+    StatusEffects* effects = &world->effects;
+    cancelTargetEffects(world, 1, index);
+    int end = world->enemyCount < effects->targetCapacity[1] ? world->enemyCount : effects->targetCapacity[1];
+    for (int i = index + 1; i < end; i++) {
+        retargetEffects(effects, 1, i, i - 1);
+    }
+}
+
+// Przed usunieciem world->players[index]: na jego miejsce trafia ostatni gracz
+void removePlayerEffects(GameWorld* world, int index) {
+    StatusEffects* effects = &world->effects;
+    int last = world->playerCount - 1;
+    cancelTargetEffects(world, 0, index);
+    if (last != index && last < effects->targetCapacity[0]) {
+        retargetEffects(effects, 0, last, index);
+    }
+}
+
+// Gracz zostaje, ale jego efekty sa odtwarzane od nowa (dziennik)
+void clearPlayerEffects(GameWorld* world, int index) {
+    if (index >= 0) cancelTargetEffects(world, 0, index);
+}
+
+// Nowy poziom albo przeciwnicy odtworzeni od nowa
+void clearEnemyEffects(GameWorld* world) {
+    for (int i = 0; i < world->effects.targetCapacity[1] && world->effects.count > 0; i++) {
+        cancelTargetEffects(world, 1, i);
+    }
+}
+
+// Aktywne efekty gracza do paska stanu, np. "Trucizna (3), Sila (12)"
+int formatStatusEffects(const GameWorld* world, const Player* player, char* buffer, int size) {
+    long long longest[EFFECT_TYPE_COUNT];
+    playerEffectTicks(world, player, longest);
+    int used = 0;
+    buffer[0] = '\0';
+    for (int type = 0; type < EFFECT_TYPE_COUNT; type++) {
+        int turns = ticksToTurns(longest[type]);
+        if (turns <= 0 || used >= size) continue;
+        int written = snprintf(buffer + used, size - used, "%s%s (%d)", used > 0 ? ", " : "",
+            getString(effectNames[type]), turns);
+        if (written > 0) used += written;
+    }
+    return used < size ? used : size - 1;
+}
@@ -0,0 +1,114 @@
+﻿#include "graRPG10.h"
+
+// Kolejka ruchow przeciwnikow: kazdy przeciwnik ma tick nastepnego ruchu,
+// a szybkosc to moveDelay - gobliny ruszaja sie czesciej niz orki i ich
+// ruchy przeplataja sie wedlug zegara, nie kolejnosci w tablicy. Kopiec
+// 4-arny jest plytszy od binarnego, a dzieci wezla leza obok siebie.
+
+#define SCHEDULE_ARITY 4
+
+// Wczesniejszy tick pierwszy; przy rownych mniejszy indeks - kolejnosc
+// nie zalezy od historii kopca
+static int turnBefore(const EnemyTurn* a, const EnemyTurn* b) {
+    return a->tick < b->tick || (a->tick == b->tick && a->enemy < b->enemy);
+}
+
+static void siftUp(EnemySchedule* schedule, int index) {
+    EnemyTurn turn = schedule->heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / SCHEDULE_ARITY;
+        if (!turnBefore(&turn, &schedule->heap[parent])) break;
+        schedule->heap[index] = schedule->heap[parent];
+        index = parent;
+    }
+    schedule->heap[index] = turn;
+}
+
+static void siftDown(EnemySchedule* schedule, int index) {
+    EnemyTurn turn = schedule->heap[index];
+    while (1) {
+        int first = index * SCHEDULE_ARITY + 1;
+        if (first >= schedule->count) break;
+        int last = first + SCHEDULE_ARITY < schedule->count ? first + SCHEDULE_ARITY : schedule->count;
+        int best = first;
+        for (int child = first + 1; child < last; child++) {
+            if (turnBefore(&schedule->heap[child], &schedule->heap[best])) best = child;
+        }
+        if (!turnBefore(&schedule->heap[best], &turn)) break;
+        schedule->heap[index] = schedule->heap[best];
+        index = best;
+    }
+    schedule->heap[index] = turn;
+}
+
+static int enemyDelay(const Enemy* enemy) {
+    return enemy->moveDelay > 0 ? enemy->moveDelay : 1;
+}
+
+// Kopiec od nowa z tablicy przeciwnikow - kazdy rusza w ticku moveTimer.
+// Nowy poziom zaczyna zegar od 0, wiec moveTimer swiezego przeciwnika to
+// zarazem opoznienie pierwszego ruchu; po wczytaniu zapisu kolejka wraca
+// do tych samych tickow.
+void rebuildEnemySchedule(GameWorld* world) {
+    EnemySchedule* schedule = &world->schedule;
+    if (schedule->capacity < world->enemyCount) {
+        freeWorldObject(&world->clone, schedule->heap);
+        schedule->heap = (EnemyTurn*)trackedMalloc(world->enemyCount * sizeof(EnemyTurn), ALLOC_ENEMY);
+        schedule->capacity = schedule->heap ? world->enemyCount : 0;
+    }
+    schedule->count = 0;
+    for (int i = 0; i < world->enemyCount && i < schedule->capacity; i++) {
+        const Enemy* enemy = world->enemies[i];
+        long long tick = enemy->moveTimer > schedule->clock ? enemy->moveTimer : schedule->clock + 1;
+        schedule->heap[schedule->count].tick = tick;
+        schedule->heap[schedule->count].enemy = i;
+        schedule->count++;
+    }
+    for (int i = (schedule->count - 2) / SCHEDULE_ARITY; i >= 0; i--) {
+        siftDown(schedule, i);
+    }
+    schedule->valid = 1;
+}
+
+// Przesuwa zegar o ticks i rusza przeciwnikow, na ktorych przyszla kolej.
+// Wynik - liczba ruchow.
+int advanceEnemies(GameWorld* world, int ticks) {
+    EnemySchedule* schedule = &world->schedule;
+    if (!schedule->valid) {
+        rebuildEnemySchedule(world);
+    }
+    schedule->clock += ticks;
+
+    int moves = 0;
+    while (schedule->count > 0 && schedule->heap[0].tick <= schedule->clock) {
+        Enemy* enemy = world->enemies[schedule->heap[0].enemy];
+        steerEnemy(world, enemy);
+        schedule->heap[0].tick += enemyDelay(enemy);
+        enemy->moveTimer = (int)schedule->heap[0].tick;
+        siftDown(schedule, 0);
+        moves++;
+    }
+    return moves;
+}
+
+// Przed usunieciem world->enemies[index]: wpis znika, a indeksy dalszych
+// przeciwnikow przesuwaja sie jak w tablicy. O(n), jak samo usuwanie z tablicy.
+void unscheduleEnemy(GameWorld* world, int index) {
+    EnemySchedule* schedule = &world->schedule;
+    if (!schedule->valid) return;
+
+    for (int i = 0; i < schedule->count; i++) {
+        if (schedule->heap[i].enemy == index) {
+            schedule->heap[i] = schedule->heap[--schedule->count];
+            if (i < schedule->count) {
+                siftDown(schedule, i);
+                siftUp(schedule, i);
+            }
+            break;
+        }
+    }
+    // Przesuniecie indeksow nie zmienia porzadku - remisy rozstrzyga ta sama kolejnosc
+    for (int i = 0; i < schedule->count; i++) {
+        if (schedule->heap[i].enemy > index) schedule->heap[i].enemy--;
+    }
+}
@@ -0,0 +1,193 @@
+﻿#include "scheduler.h"
+
+// Farma swiatow: tysiace niezaleznych gier prowadzonych przez prosta
+// strategie, dla kilku liczb watkow po kolei. Mierzy tury na sekunde i
+// sprawdza, ze stan swiatow po przebiegu jest identyczny niezaleznie od
+// liczby watkow (kazdy swiat ma wlasne ziarno).
+//
+// Uzycie: graRPG10_worlds [--worlds N] [--turns N] [--threads 1,2,4]
+//                         [--seed N] [--out wynik.json]
+
+#define FARM_DEFAULT_WORLDS 2000
+#define FARM_DEFAULT_TURNS 200
+#define FARM_MAX_RUNS 16
+#define FARM_SLICE_TURNS 50  // Tury na jedno wywolanie runWorldTurns
+
+typedef struct {
+    int threads;
+    long long turns;
+    long long steals;
+    double seconds;
+    int won;
+    int lost;
+    unsigned long long checksum;
+} FarmRun;
+
+// Strategia jak w tescie dlugiej sesji: leczenie, podnoszenie, portal,
+// poza tym losowy ruch - losowania ze swiata, wiec przebieg jest powtarzalny
+static char farmCommand(GameWorld* world, void* context) {
+    (void)context;
+    Player* player = world->player;
+    if (player->health < player->max_health / 2) {
+        for (int y = 0; y < player->inventory->height; y++) {
+            for (int x = 0; x < player->inventory->width; x++) {
+                Item* item = player->inventory->items[y][x];
+                if (item && item->category == ITEM_POTION) {
+                    useItem(world, player, item);
+                    y = player->inventory->height;
+                    break;
+                }
+            }
+        }
+    }
+    if (groundItemAt(world, player->posX, player->posY) >= 0) {
+        return 'p';
+    }
+    if (world->portalActive && randomInt(&world->random, 4) != 0) {
+        if (world->portalX > player->posX) return 'd';
+        if (world->portalX < player->posX) return 'a';
+        if (world->portalY > player->posY) return 's';
+        return 'w';
+    }
+    static const char moves[] = { 'w', 'a', 's', 'd' };
+    return moves[randomInt(&world->random, 4)];
+}
+
+static BattleAction farmBattleAction(GameWorld* world, Enemy* enemy, int round, void* context) {
+    (void)enemy;
+    (void)round;
+    (void)context;
+    return world->player->health < world->player->max_health / 5 ? BATTLE_FLEE : BATTLE_ATTACK;
+}
+
+// Skrot stanu swiata - porownanie przebiegow z roznymi liczbami watkow
+static unsigned long long worldChecksum(const GameWorld* world) {
+    const Player* player = world->player;
+    long long fields[] = { world->status, world->level, world->turn, world->totalEnemiesDefeated,
+        world->enemyCount, world->groundItemCount, player->health, player->gold, player->posX, player->posY };
+    unsigned long long hash = 1469598103934665603ull;
+    for (int i = 0; i < (int)(sizeof(fields) / sizeof(fields[0])); i++) {
+        hash = (hash ^ (unsigned long long)fields[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static FarmRun runFarm(int threads, int worldCount, int turns, unsigned long long seed) {
+    FarmRun run;
+    memset(&run, 0, sizeof(FarmRun));
+    WorldScheduler* scheduler = createWorldScheduler(threads);
+    run.threads = schedulerThreadCount(scheduler);
+    for (int i = 0; i < worldCount; i++) {
+        GameWorld* world = createSeededGameWorld("Farma", seed + (unsigned long long)i * 0x9E3779B97F4A7C15ull);
+        scheduleWorld(scheduler, world, farmCommand, farmBattleAction, NULL);
+    }
+
+    for (int done = 0; done < turns; done += FARM_SLICE_TURNS) {
+        int slice = turns - done < FARM_SLICE_TURNS ? turns - done : FARM_SLICE_TURNS;
+        runWorldTurns(scheduler, slice);
+    }
+
+    SchedulerStats stats = schedulerStats(scheduler);
+    run.turns = stats.turns;
+    run.steals = stats.steals;
+    run.seconds = stats.seconds;
+    for (int i = 0; i < scheduledWorldCount(scheduler); i++) {
+        GameWorld* world = scheduledWorld(scheduler, i)->world;
+        run.won += world->status == GAME_WON;
+        run.lost += world->status == GAME_LOST;
+        run.checksum = run.checksum * 31 + worldChecksum(world);
+        freeGameWorld(world);
+    }
+    freeWorldScheduler(scheduler);
+    return run;
+}
+
+static void writeFarmJson(FILE* file, const FarmRun* runs, int runCount, int worldCount, int turns) {
+    fprintf(file, "{\n");
+    fprintf(file, "  \"config\": {\n");
+    fprintf(file, "    \"map_width\": %d,\n", MAP_WIDTH);
+    fprintf(file, "    \"map_height\": %d,\n", MAP_HEIGHT);
+    fprintf(file, "    \"worlds\": %d,\n", worldCount);
+    fprintf(file, "    \"turns_per_world\": %d\n", turns);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"runs\": [\n");
+    for (int i = 0; i < runCount; i++) {
+        const FarmRun* run = &runs[i];
+        fprintf(file, "    { \"threads\": %d, \"turns\": %lld, \"seconds\": %.4f, \"turns_per_second\": %.0f, "
+            "\"speedup\": %.2f, \"steals\": %lld, \"won\": %d, \"lost\": %d, \"checksum\": \"%016llx\" }%s\n",
+            run->threads, run->turns, run->seconds, run->seconds > 0.0 ? run->turns / run->seconds : 0.0,
+            run->seconds > 0.0 ? runs[0].seconds / run->seconds : 0.0, run->steals, run->won, run->lost,
+            run->checksum, i + 1 < runCount ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+}
+
+int main(int argc, char* argv[]) {
+    int worldCount = FARM_DEFAULT_WORLDS;
+    int turns = FARM_DEFAULT_TURNS;
+    unsigned long long seed = 12345;
+    const char* outPath = NULL;
+    int threadCounts[FARM_MAX_RUNS] = { 1, 2, 4 };
+    int runCount = 3;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--worlds") == 0 && i + 1 < argc) {
+            worldCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--turns") == 0 && i + 1 < argc) {
+            turns = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            // Lista liczb watkow po przecinku
+            runCount = 0;
+            char* cursor = argv[++i];
+            while (*cursor && runCount < FARM_MAX_RUNS) {
+                threadCounts[runCount++] = (int)strtol(cursor, &cursor, 10);
+                if (*cursor == ',') cursor++;
+                else break;
+            }
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else {
+            fprintf(stderr, "Uzycie: %s [--worlds N] [--turns N] [--threads 1,2,4] [--seed N] [--out wynik.json]\n",
+                argv[0]);
+            return 2;
+        }
+    }
+    if (runCount == 0 || worldCount <= 0 || turns <= 0) {
+        fprintf(stderr, "Nieprawidlowe parametry\n");
+        return 2;
+    }
+
+    initStringTable();
+    FarmRun runs[FARM_MAX_RUNS];
+    int status = 0;
+    for (int r = 0; r < runCount; r++) {
+        runs[r] = runFarm(threadCounts[r], worldCount, turns, seed);
+        const FarmRun* run = &runs[r];
+        fprintf(stderr, "%2d watkow: %lld tur w %.3f s, %.0f tur/s (x%.2f), podkradzionych %lld, wygranych %d, "
+            "przegranych %d\n", run->threads, run->turns, run->seconds, run->turns / run->seconds,
+            runs[0].seconds / run->seconds, run->steals, run->won, run->lost);
+        if (run->checksum != runs[0].checksum) {
+            fprintf(stderr, "Stan swiatow z %d watkami rozni sie od przebiegu z %d!\n", run->threads, runs[0].threads);
+            status = 1;
+        }
+    }
+
+    if (outPath) {
+        FILE* file;
+        if (fopen_s(&file, outPath, "w") != 0) {
+            fprintf(stderr, "Nie mozna otworzyc pliku %s!\n", outPath);
+            return 1;
+        }
+        writeFarmJson(file, runs, runCount, worldCount, turns);
+        fclose(file);
+    }
+    return status;
+}
@@ -0,0 +1,209 @@
+﻿#include "graRPG10.h"
+
+// Klon swiata dla symulacji (boty przeszukujace ruchy): caly swiat trafia do
+// jednego bloku pamieci - jedna alokacja i kopiowanie po kolei zamiast setek
+// malych blokow. Klon jest zwyklym GameWorld, wiec dziala na nim cala logika
+// gry; obiekty tworzone w trakcie symulacji sa zwyklymi alokacjami, a
+// freeWorldObject pomija te lezace w bloku. Klon nie ma kolejki zdarzen,
+// dziennika zapisu ani watku budujacego nastepny poziom.
+
+#define CLONE_ALIGN 16
+
+static size_t alignClone(size_t size) {
+    return (size + CLONE_ALIGN - 1) & ~(size_t)(CLONE_ALIGN - 1);
+}
+
+// Kolejny kawalek bloku
+static void* carve(char** cursor, size_t size) {
+    void* p = *cursor;
+    *cursor += alignClone(size);
+    return p;
+}
+
+static int isItemOrigin(const Inventory* inv, int x, int y) {
+    const Item* item = inv->items[y][x];
+    return item && item->posX == x && item->posY == y;
+}
+
+static size_t inventoryCloneSize(const Inventory* inv) {
+    int itemCount = 0;
+    for (int y = 0; y < inv->height; y++) {
+        for (int x = 0; x < inv->width; x++) {
+            if (isItemOrigin(inv, x, y)) itemCount++;
+        }
+    }
+    size_t cells = (size_t)inv->width * inv->height;
+    size_t indexBytes = 0;
+    for (int i = 0; i < ITEM_CATEGORY_COUNT; i++) {
+        indexBytes += alignClone(inv->index[i].count * sizeof(Item*));
+    }
+    return alignClone(sizeof(Inventory)) + indexBytes +
+        alignClone(inv->height * sizeof(int*)) + alignClone(cells * sizeof(int)) +
+        alignClone(inv->height * sizeof(Item**)) + alignClone(cells * sizeof(Item*)) +
+        (inv->rowMask ? alignClone(inv->height * sizeof(unsigned int)) : 0) +
+        itemCount * alignClone(sizeof(Item));
+}
+
+static Inventory* cloneInventory(const Inventory* source, char** cursor, const CloneBlock* block) {
+    int width = source->width;
+    int height = source->height;
+    Inventory* inv = (Inventory*)carve(cursor, sizeof(Inventory));
+    *inv = *source;
+    inv->clone = *block;
+
+    // Wiersze jeden za drugim
+    inv->slots = (int**)carve(cursor, height * sizeof(int*));
+    int* slotCells = (int*)carve(cursor, (size_t)width * height * sizeof(int));
+    inv->items = (Item***)carve(cursor, height * sizeof(Item**));
+    Item** itemCells = (Item**)carve(cursor, (size_t)width * height * sizeof(Item*));
+    for (int y = 0; y < height; y++) {
+        inv->slots[y] = slotCells + y * width;
+        inv->items[y] = itemCells + y * width;
+        memcpy(inv->slots[y], source->slots[y], width * sizeof(int));
+    }
+    if (source->rowMask) {
+        inv->rowMask = (unsigned int*)carve(cursor, height * sizeof(unsigned int));
+        memcpy(inv->rowMask, source->rowMask, height * sizeof(unsigned int));
+    }
+
+    // Przedmiot zajmuje kilka pol - kopia powstaje w jego lewym gornym rogu,
+    // pozostale pola wskazuja na nia
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            inv->items[y][x] = NULL;
+            if (isItemOrigin(source, x, y)) {
+                Item* item = (Item*)carve(cursor, sizeof(Item));
+                *item = *source->items[y][x];
+                inv->items[y][x] = item;
+            }
+        }
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const Item* item = source->items[y][x];
+            if (item && !isItemOrigin(source, x, y)) {
+                inv->items[y][x] = inv->items[item->posY][item->posX];
+            }
+        }
+    }
+
+    // Indeks w tej samej kolejnosci - klucze kopii sa takie same
+    for (int i = 0; i < ITEM_CATEGORY_COUNT; i++) {
+        const InventoryIndex* from = &source->index[i];
+        InventoryIndex* index = &inv->index[i];
+        // Pusta tablica z konca bloku wskazywalaby poza klon
+        index->items = from->count ? (Item**)carve(cursor, from->count * sizeof(Item*)) : NULL;
+        index->capacity = from->count;
+        for (int n = 0; n < from->count; n++) {
+            const Item* item = from->items[n];
+            index->items[n] = inv->items[item->posY][item->posX];
+        }
+    }
+    return inv;
+}
+
+GameWorld* cloneGameWorld(const GameWorld* world) {
+    size_t size = alignClone(sizeof(GameWorld)) +
+        alignClone(MAP_HEIGHT * sizeof(char*)) + alignClone(MAP_HEIGHT * MAP_WIDTH) +
+        alignClone(world->enemyCount * sizeof(Enemy*)) + world->enemyCount * alignClone(sizeof(Enemy)) +
+        alignClone(world->schedule.count * sizeof(EnemyTurn)) + alignClone(world->effects.capacity * sizeof(StatusEffect)) +
+        alignClone(world->effects.targetCapacity[0] * sizeof(int)) + alignClone(world->effects.targetCapacity[1] * sizeof(int)) +
+        (world->influence.fields[0] ? alignClone((INFLUENCE_FIELD_COUNT + 2) * MAP_WIDTH * MAP_HEIGHT * sizeof(int)) : 0) +
+        alignClone(world->trapCount * sizeof(Trap*)) + world->trapCount * alignClone(sizeof(Trap)) +
+        alignClone(MAX_GROUND_ITEMS * sizeof(Item*)) + world->groundItemCount * alignClone(sizeof(Item)) +
+        alignClone(world->playerCount * sizeof(Player*));
+    for (int i = 0; i < world->playerCount; i++) {
+        size += alignClone(sizeof(Player)) + inventoryCloneSize(world->players[i]->inventory);
+    }
+
+    char* start = (char*)trackedMalloc(size, ALLOC_WORLD);
+    if (!start) return NULL;
+    char* cursor = start;
+
+    GameWorld* clone = (GameWorld*)carve(&cursor, sizeof(GameWorld));
+    *clone = *world;
+    clone->clone.start = start;
+    clone->clone.size = size;
+    clone->events = NULL;
+    clone->journal = NULL;
+    clone->prefetch = NULL;
+
+    clone->map = (char**)carve(&cursor, MAP_HEIGHT * sizeof(char*));
+    char* tiles = (char*)carve(&cursor, MAP_HEIGHT * MAP_WIDTH);
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        clone->map[y] = tiles + y * MAP_WIDTH;
+        memcpy(clone->map[y], world->map[y], MAP_WIDTH);
+    }
+
+    clone->enemies = (Enemy**)carve(&cursor, world->enemyCount * sizeof(Enemy*));
+    for (int i = 0; i < world->enemyCount; i++) {
+        clone->enemies[i] = (Enemy*)carve(&cursor, sizeof(Enemy));
+        *clone->enemies[i] = *world->enemies[i];
+    }
+
+    // Kolejka ruchow odwoluje sie do indeksow - kopia bez zmian
+    clone->schedule.heap = NULL;
+    clone->schedule.capacity = world->schedule.count;
+    if (world->schedule.count > 0) {
+        clone->schedule.heap = (EnemyTurn*)carve(&cursor, world->schedule.count * sizeof(EnemyTurn));
+        memcpy(clone->schedule.heap, world->schedule.heap, world->schedule.count * sizeof(EnemyTurn));
+    }
+
+    // Kolo efektow tez - wezly lacza sie indeksami puli
+    clone->effects.pool = NULL;
+    if (world->effects.capacity > 0) {
+        clone->effects.pool = (StatusEffect*)carve(&cursor, world->effects.capacity * sizeof(StatusEffect));
+        memcpy(clone->effects.pool, world->effects.pool, world->effects.capacity * sizeof(StatusEffect));
+    }
+    for (int i = 0; i < 2; i++) {
+        int capacity = world->effects.targetCapacity[i];
+        clone->effects.targetHeads[i] = capacity ? (int*)carve(&cursor, capacity * sizeof(int)) : NULL;
+        if (capacity) memcpy(clone->effects.targetHeads[i], world->effects.targetHeads[i], capacity * sizeof(int));
+    }
+
+    // Pola wplywu - bez siatek roboczych, ktore tylko przebudowa wypelnia
+    if (world->influence.fields[0]) {
+        int cells = MAP_WIDTH * MAP_HEIGHT;
+        int* fields = (int*)carve(&cursor, (INFLUENCE_FIELD_COUNT + 2) * cells * sizeof(int));
+        memcpy(fields, world->influence.fields[0], INFLUENCE_FIELD_COUNT * cells * sizeof(int));
+        for (int i = 0; i < INFLUENCE_FIELD_COUNT; i++) {
+            clone->influence.fields[i] = fields + i * cells;
+        }
+        clone->influence.scratch = fields + INFLUENCE_FIELD_COUNT * cells;
+    }
+
+    clone->traps = (Trap**)carve(&cursor, world->trapCount * sizeof(Trap*));
+    for (int i = 0; i < world->trapCount; i++) {
+        clone->traps[i] = (Trap*)carve(&cursor, sizeof(Trap));
+        *clone->traps[i] = *world->traps[i];
+    }
+
+    clone->groundItems = (Item**)carve(&cursor, MAX_GROUND_ITEMS * sizeof(Item*));
+    for (int i = 0; i < MAX_GROUND_ITEMS; i++) {
+        clone->groundItems[i] = NULL;
+    }
+    for (int i = 0; i < world->groundItemCount; i++) {
+        clone->groundItems[i] = (Item*)carve(&cursor, sizeof(Item));
+        *clone->groundItems[i] = *world->groundItems[i];
+    }
+
+    // Wyposazenie wskazuje na przedmioty w ekwipunku - po kopii na ich kopie
+    clone->player = NULL;
+    clone->players = world->playerCount ? (Player**)carve(&cursor, world->playerCount * sizeof(Player*)) : NULL;
+    clone->playerCapacity = world->playerCount;
+    for (int i = 0; i < world->playerCount; i++) {
+        const Player* source = world->players[i];
+        Player* player = (Player*)carve(&cursor, sizeof(Player));
+        *player = *source;
+        player->inventory = cloneInventory(source->inventory, &cursor, &clone->clone);
+        for (int slot = 0; slot < EQUIP_SLOT_COUNT; slot++) {
+            const Item* item = source->equipment[slot];
+            player->equipment[slot] = item ? player->inventory->items[item->posY][item->posX] : NULL;
+        }
+        clone->players[i] = player;
+        if (world->player == source) {
+            clone->player = player;
+        }
+    }
+    return clone;
+}